@@ -0,0 +1,207 @@
+#include "benchrunner.h"
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const QVector<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    int rank = qBound(1, int(std::ceil(fraction * sorted.size())), int(sorted.size()));
+    return sorted[rank - 1] / 1e6;
+}
+
+BenchRunner::BenchRunner(const Options &options)
+    : options(options)
+{
+    this->options.iterations = qMax(1, options.iterations);
+    this->options.warmup = qMax(0, options.warmup);
+    this->options.threads = qMax(1, options.threads);
+    threads.setMaxThreadCount(this->options.threads);
+    threads.setExpiryTimeout(-1);
+}
+
+void BenchRunner::add(const QString &name, const Operation &operation, int iterations, bool concurrent)
+{
+    Case benchCase;
+    benchCase.name = name;
+    benchCase.operation = operation;
+    benchCase.iterations = iterations > 0 ? iterations : options.iterations;
+    benchCase.concurrent = concurrent;
+    cases.append(benchCase);
+}
+
+QVector<BenchRunner::Result> BenchRunner::run(const QString &filter)
+{
+    QRegularExpression pattern(filter);
+    QTextStream err(stderr);
+    QVector<Result> results;
+
+    for (const Case &benchCase : std::as_const(cases)) {
+        if (!filter.isEmpty() && !pattern.match(benchCase.name).hasMatch()) {
+            continue;
+        }
+
+        Result result = measure(benchCase);
+        err << QString("%1  p50 %2 ms  p95 %3 ms  p99 %4 ms  %5 ops/s%6")
+               .arg(result.name, -32)
+               .arg(result.p50, 0, 'f', 3).arg(result.p95, 0, 'f', 3).arg(result.p99, 0, 'f', 3)
+               .arg(result.throughput, 0, 'f', 1)
+               .arg(result.failures > 0 ? QString("  (%1 failed)").arg(result.failures) : QString())
+            << Qt::endl;
+        results.append(result);
+    }
+
+    return results;
+}
+
+BenchRunner::Result BenchRunner::measure(const Case &benchCase)
+{
+    int threadCount = benchCase.concurrent ? options.threads : 1;
+    std::atomic<int> sequence(0);
+    std::atomic<int> failures(0);
+
+    // Run a callable on every measuring thread; threads are kept between cases
+    // so each one holds on to its pooled connection and prepared statements
+    auto onThreads = [&](const std::function<void(int)> &work) {
+        if (threadCount == 1) {
+            work(0);
+            return;
+        }
+        QVector<int> indexes(threadCount);
+        std::iota(indexes.begin(), indexes.end(), 0);
+        QtConcurrent::blockingMap(&threads, indexes, work);
+    };
+
+    // Every thread warms its own connection before measuring
+    int warmupPerThread = options.warmup > 0 ? qMax(1, options.warmup / threadCount) : 0;
+    onThreads([&](int) {
+        for (int i = 0; i < warmupPerThread; i++) {
+            benchCase.operation(sequence++);
+        }
+    });
+
+    // Each thread records into its own buffer and claims iterations from a shared counter
+    QVector<QVector<qint64>> samples(threadCount);
+    std::atomic<int> remaining(benchCase.iterations);
+
+    QElapsedTimer wall;
+    wall.start();
+
+    onThreads([&](int thread) {
+        QVector<qint64> &buffer = samples[thread];
+        buffer.reserve(benchCase.iterations / threadCount + 1);
+        QElapsedTimer timer;
+        while (remaining-- > 0) {
+            int index = sequence++;
+            timer.start();
+            bool ok = benchCase.operation(index);
+            buffer.append(timer.nsecsElapsed());
+            if (!ok) {
+                failures++;
+            }
+        }
+    });
+
+    qint64 elapsed = wall.nsecsElapsed();
+
+    QVector<qint64> sorted;
+    sorted.reserve(benchCase.iterations);
+    for (const QVector<qint64> &buffer : std::as_const(samples)) {
+        sorted += buffer;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    Result result;
+    result.name = benchCase.name;
+    result.iterations = sorted.size();
+    result.threads = threadCount;
+    result.failures = failures;
+    if (!sorted.isEmpty()) {
+        qint64 total = std::accumulate(sorted.begin(), sorted.end(), qint64(0));
+        result.mean = total / 1e6 / sorted.size();
+        result.p50 = percentile(sorted, 0.50);
+        result.p95 = percentile(sorted, 0.95);
+        result.p99 = percentile(sorted, 0.99);
+        result.max = sorted.last() / 1e6;
+        result.throughput = elapsed > 0 ? sorted.size() * 1e9 / elapsed : 0.0;
+    }
+    return result;
+}
+
+QJsonArray BenchRunner::toJson(const QVector<Result> &results)
+{
+    QJsonArray array;
+    for (const Result &result : results) {
+        QJsonObject object;
+        object["name"] = result.name;
+        object["iterations"] = result.iterations;
+        object["threads"] = result.threads;
+        object["failures"] = result.failures;
+        object["mean_ms"] = result.mean;
+        object["p50_ms"] = result.p50;
+        object["p95_ms"] = result.p95;
+        object["p99_ms"] = result.p99;
+        object["max_ms"] = result.max;
+        object["throughput_ops"] = result.throughput;
+        array.append(object);
+    }
+    return array;
+}
+
+QStringList BenchRunner::compare(const QVector<Result> &results, const QJsonObject &baseline, double tolerance)
+{
+    QHash<QString, QJsonObject> previous;
+    for (const QJsonValue &value : baseline["benchmarks"].toArray()) {
+        QJsonObject object = value.toObject();
+        previous.insert(object["name"].toString(), object);
+    }
+
+    QTextStream err(stderr);
+    QStringList regressions;
+
+    for (const Result &result : results) {
+        if (!previous.contains(result.name)) {
+            err << QString("%1  no baseline").arg(result.name, -32) << Qt::endl;
+            continue;
+        }
+
+        const QJsonObject &base = previous[result.name];
+        double baseP50 = base["p50_ms"].toDouble();
+        double baseP95 = base["p95_ms"].toDouble();
+        double baseThroughput = base["throughput_ops"].toDouble();
+
+        // Latency may grow and throughput may drop by at most the tolerance
+        bool regressed = (baseP50 > 0.0 && result.p50 > baseP50 * (1.0 + tolerance))
+                         || (baseP95 > 0.0 && result.p95 > baseP95 * (1.0 + tolerance))
+                         || (baseThroughput > 0.0 && result.throughput < baseThroughput * (1.0 - tolerance))
+                         || result.failures > base["failures"].toInt();
+
+        auto change = [](double current, double before) {
+            return before > 0.0 ? QString("%1%2%").arg(current >= before ? "+" : "")
+                                  .arg((current / before - 1.0) * 100.0, 0, 'f', 1)
+                                : QString("n/a");
+        };
+
+        err << QString("%1  p50 %2  p95 %3  throughput %4%5")
+               .arg(result.name, -32)
+               .arg(change(result.p50, baseP50), 8).arg(change(result.p95, baseP95), 8)
+               .arg(change(result.throughput, baseThroughput), 8)
+               .arg(regressed ? "  REGRESSION" : "")
+            << Qt::endl;
+
+        if (regressed) {
+            regressions.append(result.name);
+        }
+    }
+
+    return regressions;
+}
@@ -0,0 +1,113 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief The BenchRunner class measures latency percentiles and throughput of operations
+ *
+ * Every case warms up and then runs the measured iterations on a fixed set of
+ * threads, each of which keeps its own pooled connection between cases. Results are written as JSON and
+ * can be compared with a saved baseline to detect regressions.
+ */
+class BenchRunner
+{
+public:
+    /**
+     * @brief Measurement parameters shared by all cases
+     */
+    struct Options
+    {
+        int iterations = 200;
+        int warmup = 20;
+        int threads = 1;
+    };
+
+    /**
+     * @brief Operation under test, returns false on failure
+     *
+     * The argument is a sequence number unique across all threads of a run.
+     */
+    typedef std::function<bool(int)> Operation;
+
+    /**
+     * @brief Measured statistics of one case, latencies in milliseconds
+     */
+    struct Result
+    {
+        QString name;
+        int iterations = 0;
+        int threads = 0;
+        int failures = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        double throughput = 0.0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Measurement parameters
+     */
+    explicit BenchRunner(const Options &options);
+
+    /**
+     * @brief Register a case
+     * @param name Case name, used to match baseline entries
+     * @param operation Operation to measure
+     * @param iterations Iterations overriding Options::iterations, 0 for the default
+     * @param concurrent False to always run the case on a single thread
+     */
+    void add(const QString &name, const Operation &operation, int iterations = 0, bool concurrent = true);
+
+    /**
+     * @brief Run every case whose name matches a pattern
+     * @param filter Regular expression, empty to run all cases
+     * @return Results in registration order
+     */
+    QVector<Result> run(const QString &filter = QString());
+
+    /**
+     * @brief Convert results to JSON
+     * @param results Results of run()
+     * @return JSON array of result objects
+     */
+    static QJsonArray toJson(const QVector<Result> &results);
+
+    /**
+     * @brief Compare results with a baseline report
+     * @param results Results of run()
+     * @param baseline Report written by an earlier run
+     * @param tolerance Allowed relative slowdown, e.g. 0.15 for 15%
+     * @return Names of the regressed cases
+     */
+    static QStringList compare(const QVector<Result> &results, const QJsonObject &baseline, double tolerance);
+
+private:
+    struct Case
+    {
+        QString name;
+        Operation operation;
+        int iterations = 0;
+        bool concurrent = true;
+    };
+
+    /**
+     * @brief Measure one case
+     */
+    Result measure(const Case &benchCase);
+
+    Options options;
+    QVector<Case> cases;
+    QThreadPool threads;
+};
+
+#endif // BENCHRUNNER_H
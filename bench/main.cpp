@@ -0,0 +1,739 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+#include <vector>
+#include "benchrunner.h"
+#include "bookingwritequeue.h"
+#include "database.h"
+#include "networkload.h"
+#include "sessionmanager.h"
+
+/**
+ * @brief Search parameters taken from an existing flight
+ */
+struct RouteSample
+{
+    QString departureCode;
+    QString arrivalCode;
+    QDate date;
+};
+
+// Rows decoded per iteration of the row decoding cases
+static const int decodedRowCount = 100000;
+
+// Planners prefer sequential scans on small tables, so only check plans on larger ones
+static const qint64 planCheckMinFlights = 10000;
+
+static const char *const flightColumns[] = {
+    "id", "flight_number", "airline_name",
+    "departure_code", "departure_city", "arrival_code", "arrival_city",
+    "departure_time", "arrival_time",
+    "price_economy", "price_business", "price_first",
+    "available_seats_economy", "available_seats_business", "available_seats_first"
+};
+
+/**
+ * @brief Pick a sample for a sequence number, scattered over the whole list
+ */
+template <typename T>
+static const T &pick(const QVector<T> &samples, int sequence)
+{
+    return samples[int((quint64(sequence) * 2654435761ULL) % quint64(samples.size()))];
+}
+
+/**
+ * @brief Load search parameters spread evenly over the flights table
+ */
+static QVector<RouteSample> loadRouteSamples(QSqlDatabase db, int count)
+{
+    QVector<RouteSample> samples;
+    QSqlQuery query(db);
+    query.prepare("SELECT dep.code, arr.code, f.departure_time::date "
+                  "FROM generate_series(1, (SELECT COALESCE(MAX(id), 0) FROM flights), "
+                  "GREATEST((SELECT COALESCE(MAX(id), 0) FROM flights) / ?, 1)) AS s(id) "
+                  "JOIN flights f ON f.id = s.id "
+                  "JOIN airports dep ON dep.id = f.departure_airport_id "
+                  "JOIN airports arr ON arr.id = f.arrival_airport_id");
+    query.addBindValue(count);
+    if (query.exec()) {
+        while (query.next()) {
+            samples.append({query.value(0).toString(), query.value(1).toString(), query.value(2).toDate()});
+        }
+    } else {
+        qDebug() << "Error loading route samples:" << query.lastError().text();
+    }
+    return samples;
+}
+
+/**
+ * @brief Load the first column of a query as a list
+ */
+template <typename T>
+static QVector<T> loadColumn(QSqlDatabase db, const QString &sql)
+{
+    QVector<T> values;
+    QSqlQuery query(db);
+    if (query.exec(sql)) {
+        while (query.next()) {
+            values.append(query.value(0).value<T>());
+        }
+    } else {
+        qDebug() << "Error loading samples:" << query.lastError().text();
+    }
+    return values;
+}
+
+/**
+ * @brief Build raw result rows resembling a flight search result
+ */
+static QVector<QVariantList> makeRawFlightRows(int count)
+{
+    QVector<QVariantList> rows;
+    rows.reserve(count);
+    QDateTime departure(QDate(2025, 1, 1), QTime(8, 0));
+    for (int i = 0; i < count; i++) {
+        rows.append({i + 1, QString("FL%1").arg(i % 9000 + 1000), "Aeroflot",
+                     "SVO", "Moscow", "LED", "Saint Petersburg",
+                     departure.addSecs(i * 60), departure.addSecs(i * 60 + 5400),
+                     5000.0 + i % 100, 12500.0, 20000.0, 120, 20, 8});
+    }
+    return rows;
+}
+
+/**
+ * @brief Check that flight searches use an index on the flights table
+ * @return JSON report of the checked routes
+ */
+static QJsonObject checkSearchPlans(Database *db, const QVector<RouteSample> &routes, qint64 flightCount, bool *ok)
+{
+    QJsonObject report;
+    *ok = true;
+
+    if (flightCount < planCheckMinFlights) {
+        report["skipped"] = QString("fewer than %1 flights").arg(planCheckMinFlights);
+        return report;
+    }
+
+    QJsonArray checks;
+    for (int i = 0; i < qMin(5, int(routes.size())); i++) {
+        const RouteSample &route = pick(routes, i);
+        QStringList plan = db->explainSearchFlights(route.departureCode, route.arrivalCode, route.date);
+        bool indexed = !plan.isEmpty() && !plan.join('\n').contains("Seq Scan on flights");
+
+        QJsonObject check;
+        check["route"] = QString("%1-%2 %3").arg(route.departureCode, route.arrivalCode, route.date.toString(Qt::ISODate));
+        check["index_scan"] = indexed;
+        check["plan"] = QJsonArray::fromStringList(plan);
+        checks.append(check);
+
+        if (!indexed) {
+            *ok = false;
+            QTextStream(stderr) << "Flight search plan scans the flights table for " << check["route"].toString()
+                                << ":\n" << plan.join('\n') << Qt::endl;
+        }
+    }
+    report["checks"] = checks;
+    return report;
+}
+
+/**
+ * @brief Read the free economy seats and the booking count of a flight
+ */
+static bool readSeatState(QSqlDatabase db, int flightId, int *seats, int *bookings)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT f.available_seats_economy, "
+                  "(SELECT COUNT(*) FROM bookings b WHERE b.flight_id = f.id AND b.seat_class = 'Economy') "
+                  "FROM flights f WHERE f.id = ?");
+    query.addBindValue(flightId);
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Error reading seat state:" << query.lastError().text();
+        return false;
+    }
+    *seats = query.value(0).toInt();
+    *bookings = query.value(1).toInt();
+    return true;
+}
+
+/**
+ * @brief Book the economy seats of some flights from several threads until they are sold out
+ *
+ * Attempts go round the flights and oversubscribe their free seats; afterwards
+ * the seats taken from every flight must match the bookings made for it.
+ * @return JSON entry with the seat counts and booking throughput
+ */
+static QJsonObject bookUntilSoldOut(Database *db, QSqlDatabase connection, const QVector<int> &flights,
+                                    const QVector<int> &userIds, int threads, bool *ok)
+{
+    QJsonObject entry;
+    QVector<int> seatsBefore(flights.size());
+    QVector<int> bookingsBefore(flights.size());
+    int attempts = 0;
+    for (int f = 0; f < flights.size(); f++) {
+        if (!readSeatState(connection, flights[f], &seatsBefore[f], &bookingsBefore[f])) {
+            *ok = false;
+            return entry;
+        }
+        attempts += seatsBefore[f] + 2 * threads;
+    }
+
+    std::atomic<int> nextAttempt(0);
+    std::atomic<int> leaseFailures(0);
+    std::vector<std::atomic<int>> booked(flights.size());
+    for (std::atomic<int> &count : booked) {
+        count = 0;
+    }
+    QVector<QThread*> workers;
+    QElapsedTimer timer;
+    timer.start();
+    for (int t = 0; t < threads; t++) {
+        workers.append(QThread::create([&]() {
+            // Hold a lease for the whole run; bookTicket() shares it. Without one every
+            // booking would fail and pass for a sold-out flight.
+            ConnectionPool::Lease lease = db->connectionPool()->acquire();
+            if (!lease.isValid()) {
+                leaseFailures++;
+                return;
+            }
+            for (int i = nextAttempt++; i < attempts; i = nextAttempt++) {
+                int f = i % flights.size();
+                if (db->bookTicket(flights[f], pick(userIds, i), "Economy", "Stress Passenger", "4500000001") >= 0) {
+                    booked[f]++;
+                }
+            }
+        }));
+        workers.last()->start();
+    }
+    for (QThread *worker : std::as_const(workers)) {
+        worker->wait();
+    }
+    qDeleteAll(workers);
+    double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+    if (leaseFailures > 0) {
+        *ok = false;
+        QTextStream(stderr) << leaseFailures << " of " << threads << " stress threads got no connection: "
+                            << db->connectionPool()->lastError() << Qt::endl;
+        return entry;
+    }
+
+    bool consistent = true;
+    int totalBefore = 0;
+    int totalAfter = 0;
+    int totalBooked = 0;
+    for (int f = 0; f < flights.size(); f++) {
+        int seatsAfter = 0;
+        int bookingsAfter = 0;
+        if (!readSeatState(connection, flights[f], &seatsAfter, &bookingsAfter)) {
+            *ok = false;
+            return entry;
+        }
+
+        int made = booked[f];
+        if (seatsAfter < 0 || made > seatsBefore[f]
+            || seatsBefore[f] - seatsAfter != made || bookingsAfter - bookingsBefore[f] != made) {
+            consistent = false;
+            *ok = false;
+            QTextStream(stderr) << "Flight " << flights[f] << " oversold with " << threads << " threads: "
+                                << seatsBefore[f] << " seats before, " << seatsAfter << " after, "
+                                << made << " bookings made" << Qt::endl;
+        }
+        totalBefore += seatsBefore[f];
+        totalAfter += seatsAfter;
+        totalBooked += made;
+    }
+
+    // A run that booked nothing has not tested anything
+    if (totalBooked == 0) {
+        *ok = false;
+        QTextStream(stderr) << "No seats booked with " << threads << " threads; "
+                            << totalBefore << " seats were free" << Qt::endl;
+    }
+
+    entry["threads"] = threads;
+    entry["attempts"] = attempts;
+    entry["seats_before"] = totalBefore;
+    entry["seats_after"] = totalAfter;
+    entry["booked"] = totalBooked;
+    entry["consistent"] = consistent;
+    entry["elapsed_ms"] = elapsedMs;
+    entry["bookings_per_second"] = elapsedMs > 0.0 ? totalBooked * 1000.0 / elapsedMs : 0.0;
+    return entry;
+}
+
+/**
+ * @brief Book flights from several threads until they are sold out
+ *
+ * Every level books another single flight from 1, 2, 4 ... threads. The
+ * route-day case books all flights of one route and day at once, so it shows
+ * whether bookings of different flights queue behind shared summary rows.
+ * @return JSON report with the booking throughput per thread count
+ */
+static QJsonObject runSeatStress(Database *db, const QVector<int> &flightIds, const QVector<int> &routeDayFlightIds,
+                                 const QVector<int> &userIds, int maxThreads, bool *ok)
+{
+    QJsonObject report;
+    QJsonArray levels;
+    *ok = true;
+
+    QVector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.append(threads);
+    }
+    threadCounts.append(maxThreads);
+
+    // Keep the lease so the pool does not hand this connection to a stress thread
+    ConnectionPool::Lease lease = db->connectionPool()->acquire();
+    if (!lease.isValid()) {
+        *ok = false;
+        return report;
+    }
+    QSqlDatabase connection = lease.database();
+    for (int level = 0; level < threadCounts.size() && level < flightIds.size(); level++) {
+        int flightId = flightIds[flightIds.size() - 1 - level];
+        QJsonObject entry = bookUntilSoldOut(db, connection, {flightId}, userIds, threadCounts[level], ok);
+        if (entry.isEmpty()) {
+            return report;
+        }
+        entry["flight_id"] = flightId;
+        levels.append(entry);
+    }
+    report["levels"] = levels;
+
+    if (routeDayFlightIds.size() > 1) {
+        QJsonObject entry = bookUntilSoldOut(db, connection, routeDayFlightIds, userIds, maxThreads, ok);
+        if (!entry.isEmpty()) {
+            QJsonArray ids;
+            for (int id : routeDayFlightIds) {
+                ids.append(id);
+            }
+            entry["flight_ids"] = ids;
+            report["route_day"] = entry;
+        }
+    }
+    return report;
+}
+
+/**
+ * @brief Нагрузочные тесты слоя базы данных
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return 0 при успехе, 1 при ошибке, 2 при регрессии относительно базового отчета
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AirportInspectorBench");
+    QCoreApplication::setApplicationVersion("1.0.0");
+
+    BenchRunner::Options defaults;
+    ConnectionPool::Settings settings;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures latency and throughput of the Airport Inspector database layer.\n"
+                                     "Seed the database with AirportInspectorDataGen first.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QList<QCommandLineOption> options = {
+        {"iterations", "Measured iterations per case.", "n", QString::number(defaults.iterations)},
+        {"warmup", "Warm-up iterations per case.", "n", QString::number(defaults.warmup)},
+        {"threads", "Concurrent threads per case.", "n", QString::number(defaults.threads)},
+        {"filter", "Run only cases matching a regular expression.", "regex"},
+        {"read-only", "Skip cases that write to the database."},
+        {"output", "Write the JSON report to a file instead of stdout.", "file"},
+        {"baseline", "Compare with a saved JSON report and fail on regressions.", "file"},
+        {"tolerance", "Allowed relative slowdown against the baseline.", "fraction", "0.15"},
+        {"host", "Database host.", "host", settings.hostName},
+        {"port", "Database port.", "port", QString::number(settings.port)},
+        {"database", "Database name.", "name", settings.databaseName},
+        {"user", "Database user.", "user", settings.userName},
+        {"password", "Database password.", "password", settings.password}
+    };
+    parser.addOptions(options);
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    BenchRunner::Options benchOptions;
+    benchOptions.iterations = parser.value("iterations").toInt();
+    benchOptions.warmup = parser.value("warmup").toInt();
+    benchOptions.threads = qMax(1, parser.value("threads").toInt());
+
+    settings.hostName = parser.value("host");
+    settings.port = parser.value("port").toInt();
+    settings.databaseName = parser.value("database");
+    settings.userName = parser.value("user");
+    settings.password = parser.value("password");
+    // Measuring threads, the main thread and the group-commit writer, plus Database workers
+    settings.reservedConnections = benchOptions.threads + 2;
+    settings.maxConnections = settings.reservedConnections + benchOptions.threads;
+
+    Database *db = Database::getInstance();
+    db->setPoolSettings(settings);
+    if (!db->initialize()) {
+        err << "Cannot initialize database: " << db->connectionPool()->lastError() << Qt::endl;
+        return 1;
+    }
+
+    // Inputs are sampled once so every case reads existing rows
+    ConnectionPool::Lease sampleLease = db->connectionPool()->acquire();
+    QSqlDatabase connection = sampleLease.database();
+    QVector<RouteSample> routes = loadRouteSamples(connection, 1000);
+    QVector<QString> airportCodes = loadColumn<QString>(connection, "SELECT code FROM airports ORDER BY id");
+    QVector<int> userIds = loadColumn<int>(connection, "SELECT id FROM users ORDER BY id LIMIT 10000");
+    QVector<QString> usernames = loadColumn<QString>(connection, "SELECT username FROM users ORDER BY id LIMIT 10000");
+    QVector<int> flightIds = loadColumn<int>(connection, "SELECT id FROM flights WHERE available_seats_economy > 0 "
+                                                         "ORDER BY id LIMIT 10000");
+    QVector<int> routeDayFlightIds = loadColumn<int>(connection,
+        "SELECT f.id FROM flights f JOIN (SELECT departure_airport_id, arrival_airport_id, "
+        "CAST(departure_time AS DATE) AS day FROM flights WHERE available_seats_economy > 0 "
+        "GROUP BY 1, 2, 3 ORDER BY COUNT(*) DESC LIMIT 1) r "
+        "ON f.departure_airport_id = r.departure_airport_id AND f.arrival_airport_id = r.arrival_airport_id "
+        "AND CAST(f.departure_time AS DATE) = r.day "
+        "WHERE f.available_seats_economy > 0 ORDER BY f.id LIMIT 16");
+    QVector<qint64> flightCount = loadColumn<qint64>(connection, "SELECT COUNT(*) FROM flights");
+
+    if (routes.isEmpty() || airportCodes.isEmpty() || userIds.isEmpty()) {
+        err << "Database has no flights, airports or users to benchmark" << Qt::endl;
+        return 1;
+    }
+
+    BenchRunner runner(benchOptions);
+    bool writes = !parser.isSet("read-only");
+    QString runTag = QString::number(QDateTime::currentMSecsSinceEpoch(), 36);
+    std::atomic<int> registrations(0);
+
+    runner.add("searchFlights/one_way", [&](int i) {
+        const RouteSample &route = pick(routes, i);
+        db->searchFlights(route.departureCode, route.arrivalCode, route.date);
+        return true;
+    });
+    runner.add("searchFlights/round_trip", [&](int i) {
+        const RouteSample &route = pick(routes, i);
+        db->searchFlights(route.departureCode, route.arrivalCode, route.date, route.date.addDays(3));
+        return true;
+    });
+
+    // The in-memory timetable against the SQL search above
+    QElapsedTimer timetableTimer;
+    timetableTimer.start();
+    QSharedPointer<const TimetableSnapshot> timetable;
+    if (db->rebuildTimetable()) {
+        timetable = db->timetableEngine()->snapshot();
+        err << QString("Timetable snapshot of %1 flights built in %2 ms")
+               .arg(timetable->flightCount()).arg(timetableTimer.elapsed()) << Qt::endl;
+    }
+    if (timetable) {
+        runner.add("searchFlights/timetable_one_way", [&](int i) {
+            const RouteSample &route = pick(routes, i);
+            timetable->searchFlights(route.departureCode, route.arrivalCode, route.date);
+            return true;
+        });
+        runner.add("searchFlights/timetable_round_trip", [&](int i) {
+            const RouteSample &route = pick(routes, i);
+            timetable->searchFlights(route.departureCode, route.arrivalCode, route.date, route.date.addDays(3));
+            return true;
+        });
+        runner.add("searchItineraries", [&](int i) {
+            const RouteSample &route = pick(routes, i);
+            ConnectionScan(timetable).search(route.departureCode, route.arrivalCode, route.date, ItineraryOptions());
+            return true;
+        });
+    }
+    runner.add("searchRoundTripPairs", [&](int i) {
+        const RouteSample &route = pick(routes, i);
+        db->searchRoundTripPairs(route.departureCode, route.arrivalCode, route.date, route.date.addDays(3));
+        return true;
+    });
+    runner.add("getFareCalendar", [&](int i) {
+        const RouteSample &route = pick(routes, i);
+        db->getFareCalendar(route.departureCode, route.arrivalCode, route.date, 30);
+        return true;
+    });
+    runner.add("getAirportLoading", [&](int i) {
+        const RouteSample &route = pick(routes, i);
+        QDateTime from(route.date, QTime(0, 0));
+        return !db->getAirportLoading(route.departureCode, from, from.addDays(1), 60).isEmpty();
+    });
+    runner.add("getNetworkLoading", [&](int i) {
+        QDateTime from(pick(routes, i).date, QTime(0, 0));
+        db->getNetworkLoading(from, from.addDays(1), 60);
+        return true;
+    }, 50);
+
+    // Arbitrary-window movement counts of one airport, in-memory index against SQL
+    QDate firstDay = routes.first().date;
+    QDate lastDay = firstDay;
+    for (const RouteSample &route : std::as_const(routes)) {
+        firstDay = qMin(firstDay, route.date);
+        lastDay = qMax(lastDay, route.date);
+    }
+    QString indexedCode = routes.first().departureCode;
+    int indexedAirportId = db->getAirportInfo(indexedCode).id;
+    auto window = [&](int i) {
+        // Start at any minute of a sampled day, last from 15 minutes to half a day
+        QDateTime from(pick(routes, i).date, QTime(0, 0));
+        from = from.addSecs(qint64(i * 37 % 1440) * 60);
+        return qMakePair(from, from.addSecs(qint64(i * 53 % 706 + 15) * 60));
+    };
+    QElapsedTimer indexTimer;
+    indexTimer.start();
+    QSharedPointer<MovementIndex> movementIndex =
+        db->buildMovementIndex(indexedCode, firstDay, int(firstDay.daysTo(lastDay)) + 2);
+    qint64 indexBuildMs = indexTimer.elapsed();
+    if (movementIndex) {
+        err << QString("Movement index of %1 over %2 days built in %3 ms")
+               .arg(indexedCode).arg(movementIndex->days()).arg(indexBuildMs) << Qt::endl;
+        runner.add("movementIndex/range", [&](int i) {
+            QPair<QDateTime, QDateTime> range = window(i);
+            return movementIndex->count(range.first, range.second).movements() >= 0;
+        });
+        runner.add("movementIndex/recurring_weekday", [&](int i) {
+            QPair<QDateTime, QDateTime> range = window(i);
+            int weekday = 1 << range.first.date().dayOfWeek();
+            return movementIndex->countRecurring(firstDay, lastDay, range.first.time(), range.second.time(),
+                                                 weekday).movements() >= 0;
+        });
+    }
+    runner.add("movementIndex/sql_range", [&](int i) {
+        QPair<QDateTime, QDateTime> range = window(i);
+        ConnectionPool::Lease lease = db->connectionPool()->acquire();
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT (SELECT COUNT(*) FROM flights WHERE departure_airport_id = ? "
+                      "AND departure_time >= CAST(? AS TIMESTAMP) AND departure_time < CAST(? AS TIMESTAMP)), "
+                      "(SELECT COUNT(*) FROM flights WHERE arrival_airport_id = ? "
+                      "AND arrival_time >= CAST(? AS TIMESTAMP) AND arrival_time < CAST(? AS TIMESTAMP))");
+        for (int side = 0; side < 2; side++) {
+            query.addBindValue(indexedAirportId);
+            query.addBindValue(range.first.toString(Qt::ISODate));
+            query.addBindValue(range.second.toString(Qt::ISODate));
+        }
+        return query.exec() && query.next();
+    });
+
+    // Network dashboard metrics: full map-reduce against a refresh with nothing changed
+    QDateTime networkFrom(routes.first().date, QTime(0, 0));
+    QVector<AirportLoadRow> networkBuckets = db->getNetworkLoading(networkFrom, networkFrom.addDays(1), 60);
+    QStringList networkCodes(airportCodes.begin(), airportCodes.end());
+    NetworkLoadAnalyzer networkAnalyzer;
+    networkAnalyzer.setCapacity(40);
+    runner.add("networkLoad/analyze_full", [&](int) {
+        NetworkLoadAnalyzer analyzer;
+        analyzer.setCapacity(40);
+        return analyzer.analyze(networkCodes, networkFrom, 24, networkBuckets).airports.size() == networkCodes.size();
+    }, 0, false);
+    runner.add("networkLoad/analyze_incremental", [&](int) {
+        return networkAnalyzer.analyze(networkCodes, networkFrom, 24, networkBuckets).airports.size()
+            == networkCodes.size();
+    }, 0, false);
+    runner.add("networkLoad/refresh", [&](int) {
+        QVector<AirportLoadRow> buckets = db->getNetworkLoading(networkFrom, networkFrom.addDays(1), 60);
+        return networkAnalyzer.analyze(networkCodes, networkFrom, 24, buckets).airports.size() == networkCodes.size();
+    }, 0, false);
+    runner.add("getAllAirports", [&](int) {
+        return !db->getAllAirports().isEmpty();
+    });
+    runner.add("getAirportInfo", [&](int i) {
+        return db->getAirportInfo(pick(airportCodes, i)).isValid();
+    });
+    runner.add("getUserBookings", [&](int i) {
+        db->getUserBookings(pick(userIds, i));
+        return true;
+    });
+    runner.add("authenticateUser", [&](int i) {
+        return db->authenticateUser(pick(usernames, i), "password123") >= 0;
+    });
+
+    // Identity checks against sessions opened once per user
+    SessionManager sessions(db);
+    QVector<QString> sessionTokens;
+    for (int i = 0; i < qMin(100, int(usernames.size())); i++) {
+        QString token = sessions.login(usernames[i], "password123");
+        if (!token.isEmpty()) {
+            sessionTokens.append(token);
+        }
+    }
+    if (!sessionTokens.isEmpty()) {
+        runner.add("sessionUser", [&](int i) {
+            return sessions.user(pick(sessionTokens, i)).isValid();
+        });
+    }
+
+    // Password checks per second at several costs, queued on the hashing pool like logins
+    static const int passwordCosts[] = {10000, 100000, 600000};
+    for (int cost : passwordCosts) {
+        QString stored = PasswordHasher::hashPassword("password123", cost);
+        runner.add(QString("verifyPassword/pbkdf2_%1").arg(cost), [db, stored](int) {
+            return db->passwordHasher()->verify("password123", stored).result();
+        }, cost > 100000 ? 20 : 0);
+    }
+    if (writes && !flightIds.isEmpty()) {
+        runner.add("bookTicket", [&](int i) {
+            return db->bookTicket(pick(flightIds, i), pick(userIds, i), "Economy",
+                                  "Bench Passenger", "4500000000") >= 0;
+        });
+        runner.add("bookTickets/group_4", [&](int i) {
+            QVector<Passenger> passengers(4, Passenger{"Bench Passenger", "4500000000"});
+            return !db->bookTickets(pick(flightIds, i), pick(userIds, i), "Economy", passengers).isEmpty();
+        });
+    }
+    // Same bookings as above, committed together with those of the other threads
+    BookingWriteQueue bookingQueue(db);
+    if (writes && !flightIds.isEmpty()) {
+        runner.add("bookTicket/group_commit", [&](int i) {
+            BookingRequest request;
+            request.flightId = pick(flightIds, i);
+            request.userId = pick(userIds, i);
+            request.seatClass = "Economy";
+            request.passengers = {{"Bench Passenger", "4500000000"}};
+            return !bookingQueue.submit(request).result().isEmpty();
+        });
+    }
+    if (writes) {
+        runner.add("registerUser", [&](int) {
+            QString username = QString("bench_%1_%2").arg(runTag).arg(registrations++);
+            return db->registerUser(username, "password123", username + "@example.com", "Bench User") >= 0;
+        });
+    }
+
+    // Decoding of search results: name-keyed maps against typed rows with cached ordinals
+    QVector<QVariantList> rawRows = makeRawFlightRows(decodedRowCount);
+    runner.add("decodeFlights/variant_map", [&](int) {
+        QList<QMap<QString, QVariant>> rows;
+        for (const QVariantList &raw : std::as_const(rawRows)) {
+            QMap<QString, QVariant> row;
+            for (int column = 0; column < raw.size(); column++) {
+                row[flightColumns[column]] = raw[column];
+            }
+            rows.append(row);
+        }
+        double total = 0.0;
+        for (const QMap<QString, QVariant> &row : std::as_const(rows)) {
+            total += row["price_economy"].toDouble() + row["available_seats_economy"].toInt();
+        }
+        return total > 0.0;
+    }, 20, false);
+    runner.add("decodeFlights/typed_row", [&](int) {
+        QVector<FlightRow> rows;
+        rows.reserve(rawRows.size());
+        for (const QVariantList &raw : std::as_const(rawRows)) {
+            FlightRow flight;
+            flight.id = raw[0].toInt();
+            flight.flightNumber = raw[1].toString();
+            flight.airlineName = raw[2].toString();
+            flight.departureCode = raw[3].toString();
+            flight.departureCity = raw[4].toString();
+            flight.arrivalCode = raw[5].toString();
+            flight.arrivalCity = raw[6].toString();
+            flight.departureTime = raw[7].toDateTime();
+            flight.arrivalTime = raw[8].toDateTime();
+            flight.priceEconomy = raw[9].toDouble();
+            flight.priceBusiness = raw[10].toDouble();
+            flight.priceFirst = raw[11].toDouble();
+            flight.availableSeatsEconomy = raw[12].toInt();
+            flight.availableSeatsBusiness = raw[13].toInt();
+            flight.availableSeatsFirst = raw[14].toInt();
+            rows.append(std::move(flight));
+        }
+        double total = 0.0;
+        for (const FlightRow &row : std::as_const(rows)) {
+            total += row.priceEconomy + row.availableSeatsEconomy;
+        }
+        return total > 0.0;
+    }, 20, false);
+
+    QVector<BenchRunner::Result> results = runner.run(parser.value("filter"));
+
+    bool plansOk = true;
+    QJsonObject plans = checkSearchPlans(db, routes, flightCount.value(0), &plansOk);
+
+    // Contended bookings of single flights, checked for overselling
+    bool seatsOk = true;
+    QJsonObject seatStress;
+    QString filter = parser.value("filter");
+    if (writes && !flightIds.isEmpty()
+        && (filter.isEmpty() || QRegularExpression(filter).match("seatStress").hasMatch())) {
+        seatStress = runSeatStress(db, flightIds, routeDayFlightIds, userIds, benchOptions.threads, &seatsOk);
+    }
+
+    StatementRegistry::Stats statements = db->statementStats();
+
+    QJsonObject context;
+    context["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["host"] = settings.hostName;
+    context["database"] = settings.databaseName;
+    context["threads"] = benchOptions.threads;
+    context["warmup"] = benchOptions.warmup;
+    context["flights"] = flightCount.value(0);
+    context["statement_cache_hits"] = double(statements.hits);
+    context["statement_cache_misses"] = double(statements.misses);
+
+    BookingWriteQueue::Stats groupCommit = bookingQueue.stats();
+    if (groupCommit.batches > 0) {
+        QJsonObject batches;
+        batches["requests"] = double(groupCommit.requests);
+        batches["batches"] = double(groupCommit.batches);
+        batches["failures"] = double(groupCommit.failures);
+        batches["mean_batch"] = groupCommit.meanBatch();
+        batches["largest_batch"] = groupCommit.largestBatch;
+        context["group_commit"] = batches;
+    }
+
+    if (movementIndex) {
+        QJsonObject index;
+        index["airport"] = indexedCode;
+        index["days"] = movementIndex->days();
+        index["build_ms"] = double(indexBuildMs);
+        context["movement_index"] = index;
+    }
+
+    QJsonObject report;
+    report["context"] = context;
+    report["benchmarks"] = BenchRunner::toJson(results);
+    report["search_plans"] = plans;
+    if (!seatStress.isEmpty()) {
+        report["seat_stress"] = seatStress;
+    }
+    QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QFile::WriteOnly | QFile::Truncate) || file.write(json) != json.size()) {
+            err << "Cannot write report: " << file.errorString() << Qt::endl;
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    int exitCode = plansOk && seatsOk ? 0 : 2;
+
+    if (parser.isSet("baseline")) {
+        QFile file(parser.value("baseline"));
+        if (!file.open(QFile::ReadOnly)) {
+            err << "Cannot read baseline: " << file.errorString() << Qt::endl;
+            return 1;
+        }
+
+        QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+        QStringList regressions = BenchRunner::compare(results, baseline, parser.value("tolerance").toDouble());
+        if (!regressions.isEmpty()) {
+            err << "Regressed against baseline: " << regressions.join(", ") << Qt::endl;
+            exitCode = 2;
+        }
+    }
+
+    return exitCode;
+}
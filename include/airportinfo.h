@@ -7,6 +7,7 @@
 #include <QPushButton>
 #include <QTableView>
 #include "database.h"
+#include "flightlistmodel.h"
 
 /**
  * @brief The AirportInfo class provides airport information
@@ -64,6 +65,7 @@ private:
     QLabel *countryLabel;
     QLabel *timeZoneLabel;
     QTableView *flightsTable;
+    FlightListModel *flightsModel;
     
     Database *db;
 };
@@ -8,7 +8,10 @@
 #include <QHBoxLayout>
 #include <QDateTime>
 #include <QFrame>
+#include <QDateEdit>
+#include <QComboBox>
 #include "database.h"
+#include "loadingchart.h"
 
 /**
  * @brief Класс для отображения загруженности аэропортов
@@ -54,16 +57,22 @@ private:
     
     /**
      * @brief Создание графика загруженности
-     * @param loadingData Данные о загруженности
+     * @param loadingData Число вылетов и прилетов по интервалам времени
      */
-    void createLoadingChart(const QList<QMap<QString, QVariant>> &loadingData);
+    void createLoadingChart(const QVector<AirportLoadRow> &loadingData);
     
     // Зона 1: Информационная зона
     QLabel *airportNameLabel;
     
+    // Выбор дня и длины интервала
+    QDateEdit *dateEdit;
+    QComboBox *bucketComboBox;
+    QComboBox *periodComboBox;
+    
     // Зона 2: Зона построения графиков
     QFrame *chartFrame;
     QLabel *chartLabel;
+    LoadingChartWidget *chartWidget;
     
     // Зона 3: Кнопка выхода
     QPushButton *closeButton;
@@ -74,6 +83,9 @@ private:
     // Код аэропорта
     QString airportCode;
     
+    // Номер последнего запроса данных; ответы на более ранние отбрасываются
+    int loadingRequest;
+    
     // База данных
     Database *db;
 
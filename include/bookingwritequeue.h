@@ -0,0 +1,100 @@
+#ifndef BOOKINGWRITEQUEUE_H
+#define BOOKINGWRITEQUEUE_H
+
+#include <QFuture>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <vector>
+#include "databaserows.h"
+
+class Database;
+class QThread;
+
+/**
+ * @brief The BookingWriteQueue class groups bookings of concurrent callers into shared commits
+ *
+ * Requests may be submitted from any thread. A writer thread takes them off the
+ * queue in batches of up to maxBatch requests and books each batch with
+ * Database::bookTicketsBatch(), so many bookings share one transaction and one
+ * commit. Requests arriving while a batch is committed form the next batch; an
+ * idle writer waits at most maxDelayMs for a batch to fill up.
+ *
+ * Every request still succeeds or fails on its own, its future receives the
+ * booking IDs or an empty list.
+ *
+ * Grouping only pays off when one process books for many concurrent callers,
+ * so only the benchmark uses the queue. The application books for one user
+ * at a time and calls Database::bookTickets() or confirms a seat hold directly.
+ */
+class BookingWriteQueue
+{
+public:
+    /**
+     * @brief Counters of the requests written so far
+     */
+    struct Stats
+    {
+        qint64 requests = 0;
+        qint64 batches = 0;
+        qint64 failures = 0;
+        int largestBatch = 0;
+
+        /**
+         * @brief Get the average number of requests per commit
+         * @return Mean batch size, 0 before the first batch
+         */
+        double meanBatch() const { return batches > 0 ? double(requests) / batches : 0.0; }
+    };
+
+    /**
+     * @brief Constructor, starts the writer thread
+     * @param db Database to book in
+     * @param maxBatch Most requests committed together
+     * @param maxDelayMs Longest wait for a batch to fill up
+     */
+    explicit BookingWriteQueue(Database *db, int maxBatch = 64, int maxDelayMs = 2);
+
+    /**
+     * @brief Destructor, writes the requests still queued and stops the writer thread
+     */
+    ~BookingWriteQueue();
+
+    BookingWriteQueue(const BookingWriteQueue&) = delete;
+    BookingWriteQueue& operator=(const BookingWriteQueue&) = delete;
+
+    /**
+     * @brief Queue a booking of a group of passengers
+     * @param request Booking request
+     * @return Booking IDs in passenger order, empty if not enough seats are left or on error
+     */
+    QFuture<QVector<int>> submit(const BookingRequest &request);
+
+    /**
+     * @brief Get the counters of the requests written so far
+     * @return Counters
+     */
+    Stats stats() const;
+
+private:
+    struct Pending;
+
+    /**
+     * @brief Take batches off the queue and write them until stopped
+     */
+    void run();
+
+    Database *db;
+    int maxBatch;
+    int maxDelayMs;
+
+    mutable QMutex mutex;
+    QWaitCondition wakeUp;
+    std::vector<Pending> pending;
+    bool stopping = false;
+    Stats counters;
+
+    QThread *writer;
+};
+
+#endif // BOOKINGWRITEQUEUE_H
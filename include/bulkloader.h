@@ -0,0 +1,107 @@
+#ifndef BULKLOADER_H
+#define BULKLOADER_H
+
+#include <QByteArray>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantList>
+
+typedef struct pg_conn PGconn;
+
+/**
+ * @brief The BulkLoader class streams many rows into one table
+ *
+ * On PostgreSQL connections rows go through COPY FROM STDIN on the libpq
+ * handle of the Qt connection; other drivers fall back to multi-row INSERT
+ * batches. The loader does not manage transactions: wrap begin()..finish()
+ * in QSqlDatabase::transaction()/commit() to load atomically.
+ */
+class BulkLoader
+{
+public:
+    /**
+     * @brief Constructor
+     * @param db Open connection to load into
+     * @param batchRows Rows per INSERT statement when COPY is unavailable
+     */
+    explicit BulkLoader(const QSqlDatabase &db, int batchRows = 500);
+
+    /**
+     * @brief Destructor, aborts an unfinished load
+     */
+    ~BulkLoader();
+
+    BulkLoader(const BulkLoader &) = delete;
+    BulkLoader &operator=(const BulkLoader &) = delete;
+
+    /**
+     * @brief Start loading rows into a table
+     * @param table Table name
+     * @param columns Column names in row value order
+     * @return True if successful, false otherwise
+     */
+    bool begin(const QString &table, const QStringList &columns);
+
+    /**
+     * @brief Queue one row
+     * @param values Column values, a null QVariant is stored as NULL
+     * @return True if successful, false otherwise
+     */
+    bool addRow(const QVariantList &values);
+
+    /**
+     * @brief Flush the remaining rows and end the load
+     * @return True if every row was stored
+     */
+    bool finish();
+
+    /**
+     * @brief Check whether rows are streamed with COPY
+     * @return True for the COPY path, false for INSERT batches
+     */
+    bool usesCopy() const;
+
+    /**
+     * @brief Get the number of rows loaded since begin()
+     * @return Row count
+     */
+    qint64 rowCount() const;
+
+    /**
+     * @brief Get the text of the last error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    /**
+     * @brief Append a value in COPY text format to the buffer
+     */
+    void appendCopyValue(const QVariant &value);
+
+    /**
+     * @brief Send buffered COPY data to the server
+     */
+    bool flushCopyBuffer();
+
+    /**
+     * @brief Execute the pending multi-row INSERT
+     */
+    bool flushInsertBatch();
+
+    QSqlDatabase db;
+    PGconn *connection;
+    int batchRows;
+    bool active;
+    QString tableName;
+    QStringList columnNames;
+    QByteArray copyBuffer;
+    QVariantList pendingValues;
+    int pendingRows;
+    qint64 loadedRows;
+    QString errorText;
+};
+
+#endif // BULKLOADER_H
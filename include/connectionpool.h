@@ -0,0 +1,210 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+class QThread;
+class QTimer;
+class StatementRegistry;
+
+/**
+ * @brief The ConnectionPool class manages named per-thread database connections
+ *
+ * Thread affinity: Qt SQL connections may only be used and closed from the
+ * thread that opened them. Every pooled connection is therefore bound to the
+ * thread that first leased it and stays with that thread between leases; it
+ * is never handed to another live thread.
+ *
+ * Only leased connections count against Settings::maxConnections, so an idle
+ * connection kept by a live thread does not take a slot from anyone. Idle
+ * connections are evicted after a timeout: those of the evicting thread are
+ * closed at once, those of other threads are flagged and closed by their
+ * owner at its next acquire(). Connections of finished threads are closed
+ * from the finishing thread and reused by other threads.
+ */
+class ConnectionPool : public QObject
+{
+    Q_OBJECT
+
+    struct PooledConnection;
+
+public:
+    /**
+     * @brief Connection and sizing parameters of the pool
+     */
+    struct Settings
+    {
+        QString driver = "QPSQL";
+        QString hostName = "localhost";
+        QString databaseName = "airport_inspector";
+        QString userName = "postgres";
+        QString password = "postgres";
+        int port = 5432;
+        int maxConnections = 8;
+        // Leases Database keeps free of its workers for the GUI thread and other threads
+        int reservedConnections = 2;
+        int acquireTimeoutMs = 10000;
+        int idleTimeoutMs = 5 * 60 * 1000;
+        int healthCheckIntervalMs = 30 * 1000;
+    };
+
+    /**
+     * @brief RAII handle for a leased connection
+     *
+     * The lease is returned to the pool when the handle is destroyed. Nested
+     * leases taken by the same thread share one connection.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease();
+
+        /**
+         * @brief Check whether the lease holds an open connection
+         * @return True if the connection can be used
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Get the leased connection
+         * @return Database connection valid for the calling thread
+         */
+        QSqlDatabase database() const;
+
+        /**
+         * @brief Get the prepared statements of the leased connection
+         * @return Statement registry, nullptr for an invalid lease
+         */
+        StatementRegistry *statements() const;
+
+        /**
+         * @brief Return the connection to the pool before destruction
+         */
+        void release();
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool *pool, PooledConnection *connection);
+
+        ConnectionPool *pool = nullptr;
+        PooledConnection *connection = nullptr;
+    };
+
+    /**
+     * @brief Constructor
+     * @param settings Connection and sizing parameters
+     * @param parent Parent object
+     */
+    explicit ConnectionPool(const Settings &settings, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor
+     */
+    ~ConnectionPool();
+
+    /**
+     * @brief Lease a connection for the calling thread
+     *
+     * Blocks up to Settings::acquireTimeoutMs when every connection is leased.
+     * @return Lease, invalid if no connection could be opened in time
+     */
+    Lease acquire();
+
+    /**
+     * @brief Evict connections that have not been leased for the idle timeout
+     *
+     * Connections of the calling thread are closed at once, those of other
+     * threads when their thread next acquires.
+     * @return Number of evicted connections
+     */
+    int evictIdle();
+
+    /**
+     * @brief Evict all idle connections, as evictIdle() does, and forget their thread bindings
+     */
+    void closeAll();
+
+    /**
+     * @brief Get the pool settings
+     * @return Settings the pool was created with
+     */
+    const Settings &settings() const;
+
+    /**
+     * @brief Get the number of connections managed by the pool, leased or idle
+     * @return Connection count
+     */
+    int size() const;
+
+    /**
+     * @brief Get the number of currently leased connections
+     * @return Leased connection count
+     */
+    int leasedCount() const;
+
+    /**
+     * @brief Get the text of the last connection error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    /**
+     * @brief Return a lease taken by acquire()
+     * @param connection Leased connection
+     */
+    void release(PooledConnection *connection);
+
+    /**
+     * @brief Open the connection or verify it is still alive
+     * @param connection Connection leased by the calling thread
+     * @param checkHealth Ping an open connection if the check interval has passed
+     * @return True if the connection is usable
+     */
+    bool ensureOpen(PooledConnection *connection, bool checkHealth);
+
+    /**
+     * @brief Close a connection and drop it from the Qt connection registry
+     *
+     * Must run in the owning thread, or once that thread has finished.
+     * @param connection Connection that is not leased
+     */
+    void discard(PooledConnection *connection);
+
+    /**
+     * @brief Close a connection now if the calling thread owns it, otherwise mark it stale
+     * @param connection Connection that is not leased
+     * @return True if the connection was closed
+     */
+    bool retire(PooledConnection *connection);
+
+    /**
+     * @brief Release the connection of a thread that has finished
+     * @param thread Finished thread
+     */
+    void threadFinished(QThread *thread);
+
+    Settings poolSettings;
+    mutable QMutex mutex;
+    QWaitCondition connectionAvailable;
+    QList<PooledConnection*> connections;
+    QSet<QThread*> watchedThreads;
+    QString errorText;
+    int nextConnectionId;
+    int leasedConnections;
+    QTimer *evictionTimer;
+};
+
+#endif // CONNECTIONPOOL_H
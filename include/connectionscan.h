@@ -0,0 +1,58 @@
+#ifndef CONNECTIONSCAN_H
+#define CONNECTIONSCAN_H
+
+#include <QDate>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include "databaserows.h"
+
+class TimetableSnapshot;
+
+/**
+ * @brief Limits of a connecting itinerary search
+ */
+struct ItineraryOptions
+{
+    int maxLegs = 3;
+    int minConnectionMinutes = 45;
+    int maxTravelHours = 36;
+    QString seatClass = "Economy";
+};
+
+/**
+ * @brief The ConnectionScan class finds connecting itineraries in a timetable snapshot
+ *
+ * A multi-criteria connection scan: every flight of the travel window is
+ * visited once in departure order and extends the Pareto sets of partial
+ * journeys kept per airport. Journeys are compared by arrival time, start
+ * time, total price of the seat class and number of legs; only journeys that
+ * no other journey beats on all four criteria are returned. The start time
+ * matters because a later start may still fit the travel time limit where an
+ * earlier one does not.
+ */
+class ConnectionScan
+{
+public:
+    /**
+     * @brief Constructor
+     * @param snapshot Timetable to search
+     */
+    explicit ConnectionScan(const QSharedPointer<const TimetableSnapshot> &snapshot);
+
+    /**
+     * @brief Search Pareto-optimal itineraries
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param departureDate Date the first leg departs
+     * @param options Search limits
+     * @return Itineraries ordered by arrival time, then price
+     */
+    QVector<ItineraryRow> search(const QString &departureCity, const QString &arrivalCity,
+                                 const QDate &departureDate, const ItineraryOptions &options) const;
+
+private:
+    QSharedPointer<const TimetableSnapshot> snapshot;
+};
+
+#endif // CONNECTIONSCAN_H
@@ -11,6 +11,21 @@
 #include <QList>
 #include <QMap>
 #include <QString>
+#include <QStringList>
+#include <QFuture>
+#include <QThreadPool>
+#include <atomic>
+#include <QMutex>
+#include <QSharedPointer>
+#include "connectionpool.h"
+#include "databaserows.h"
+#include "statementregistry.h"
+#include "referencedatacache.h"
+#include "timetableengine.h"
+#include "connectionscan.h"
+#include "passwordhasher.h"
+#include "loadrollup.h"
+#include "movementindex.h"
 
 /**
  * @brief The Database class handles all database operations
@@ -27,41 +42,245 @@ public:
     static Database* getInstance();
 
     /**
-     * @brief Initialize the database connection
+     * @brief Configure the connection pool before initialize() is called
+     * @param settings Connection parameters and pool size
+     */
+    void setPoolSettings(const ConnectionPool::Settings& settings);
+
+    /**
+     * @brief Initialize the database connection pool
      * @return True if successful, false otherwise
      */
     bool initialize();
 
     /**
-     * @brief Close the database connection
+     * @brief Close all pooled database connections
      */
     void close();
 
+    /**
+     * @brief Get the connection pool
+     * @return Connection pool, nullptr before initialize()
+     */
+    ConnectionPool* connectionPool() const;
+
     /**
      * @brief Search for flights based on criteria
-     * @param departureCity Departure city
-     * @param arrivalCity Arrival city
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
      * @param departureDate Departure date
      * @param returnDate Optional return date for round trips
-     * @return List of flights matching the criteria
+     * @return Flights matching the criteria, return legs have isReturn set and follow the outbound legs
+     */
+    QVector<FlightRow> searchFlights(const QString& departureCity, 
+                                     const QString& arrivalCity, 
+                                     const QDate& departureDate, 
+                                     const QDate& returnDate = QDate());
+
+    /**
+     * @brief Serve searchFlights() from the in-memory timetable
+     *
+     * The timetable is built in the background on the first search and rebuilt
+     * whenever it is older than the maximum age; searches use SQL meanwhile.
+     * @param enabled True to use the timetable
+     * @param maxAgeMs Age after which the snapshot is rebuilt
+     */
+    void setTimetableEnabled(bool enabled, int maxAgeMs = 60 * 1000);
+
+    /**
+     * @brief Build a new timetable snapshot now
+     *
+     * If a rebuild is already running, waits for it instead of starting another.
+     * @return True if successful, false otherwise
+     */
+    bool rebuildTimetable();
+
+    /**
+     * @brief Get the timetable engine
+     * @return Timetable engine
+     */
+    TimetableEngine* timetableEngine();
+
+    /**
+     * @brief Search itineraries with up to options.maxLegs connecting flights
+     *
+     * Runs a connection scan over the in-memory timetable, building it first if
+     * none exists. A stale snapshot is still used and refreshed in the background.
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param departureDate Date the first leg departs
+     * @param options Connection time, leg and travel time limits and seat class
+     * @return Pareto-optimal itineraries by arrival time, price and number of legs
+     */
+    QVector<ItineraryRow> searchItineraries(const QString& departureCity,
+                                            const QString& arrivalCity,
+                                            const QDate& departureDate,
+                                            const ItineraryOptions& options = ItineraryOptions());
+
+    /**
+     * @brief Search round trips ranked by total price
+     *
+     * Pairs are formed and ranked by the server. A return flight must leave
+     * after the outbound flight lands and both need a free seat in the class.
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param departureDate Outbound departure date
+     * @param returnDate Return departure date
+     * @param seatClass Seat class whose prices are added up (Economy, Business, First)
+     * @param limit Maximum number of pairs
+     * @return Pairs, cheapest first
+     */
+    QVector<RoundTripRow> searchRoundTripPairs(const QString& departureCity,
+                                               const QString& arrivalCity,
+                                               const QDate& departureDate,
+                                               const QDate& returnDate,
+                                               const QString& seatClass = "Economy",
+                                               int limit = 50);
+
+    /**
+     * @brief Get the cheapest fares of a route for every day around a date
+     *
+     * Reads the route_day_fares summary, which triggers on the flights table
+     * keep current, so the window costs one index range scan. Seat counter
+     * changes are only logged by the booking path and folded in first.
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param centerDate Middle of the window
+     * @param days Days before and after the center date
+     * @return Days with flights, ordered by date
+     */
+    QVector<FareDayRow> getFareCalendar(const QString& departureCity,
+                                        const QString& arrivalCity,
+                                        const QDate& centerDate,
+                                        int days = 30);
+
+    /**
+     * @brief Get the query plan of the flight search statement
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param departureDate Departure date
+     * @return EXPLAIN output lines, empty on error
+     */
+    QStringList explainSearchFlights(const QString& departureCity,
+                                     const QString& arrivalCity,
+                                     const QDate& departureDate);
+
+    /**
+     * @brief Get a single flight
+     * @param flightId Flight ID
+     * @return Flight, invalid if not found
+     */
+    FlightRow getFlight(int flightId);
+
+    /**
+     * @brief Get one page of the departures of an airport
+     * @param airportCode Departure airport IATA code
+     * @param after Last row of the previous page, invalid for the first page
+     * @param limit Maximum number of flights
+     * @return Flights ordered by departure time and id
+     */
+    QVector<FlightRow> getDeparturesPage(const QString& airportCode, const FlightCursor& after, int limit);
+
+    /**
+     * @brief Count the departures and arrivals of an airport per time bucket
+     *
+     * Buckets of whole clock hours add up rows of the airport_hourly_load rollup;
+     * other buckets are counted from the flights table in one grouped query over
+     * range scans of the departure and arrival time indexes.
+     * @param airportCode Airport IATA code
+     * @param from Start of the first bucket
+     * @param to End of the range, the last bucket may extend past it
+     * @param bucketMinutes Bucket length in minutes
+     * @return One row per bucket in time order, quiet buckets included
+     */
+    QVector<AirportLoadRow> getAirportLoading(const QString& airportCode, const QDateTime& from,
+                                              const QDateTime& to, int bucketMinutes = 60);
+
+    /**
+     * @brief Count the departures and arrivals of every airport per time bucket
+     * @param from Start of the first bucket
+     * @param to End of the range, the last bucket may extend past it
+     * @param bucketMinutes Bucket length in minutes
+     * @return Buckets with movements, ordered by airport code and time
+     */
+    QVector<AirportLoadRow> getNetworkLoading(const QDateTime& from, const QDateTime& to, int bucketMinutes = 60);
+
+    /**
+     * @brief Recompute the hourly loading rollup from the flights and bookings tables
+     * @return True if successful, false otherwise
+     */
+    bool rebuildLoadRollup();
+
+    /**
+     * @brief Compare the hourly loading rollup with the flights and bookings tables
+     * @param report Receives the differing hours
+     * @return True if the check ran
+     */
+    bool checkLoadRollup(LoadRollup::Report* report);
+
+    /**
+     * @brief Build a per-minute movement index of an airport for arbitrary window counts
+     *
+     * The index is not kept up to date with later flight changes; build a new
+     * one to see them.
+     * @param airportCode Airport IATA code
+     * @param firstDay First day covered
+     * @param days Number of days covered
+     * @return Index, null if the airport is unknown or the flights could not be read
+     */
+    QSharedPointer<MovementIndex> buildMovementIndex(const QString& airportCode, const QDate& firstDay, int days);
+
+    /**
+     * @brief Get the reference data snapshot, loading it if needed
+     * @return Airports and airlines with lookup indexes
+     */
+    QSharedPointer<const ReferenceData> referenceData();
+
+    /**
+     * @brief Reload airports and airlines from the database
+     * @return True if successful, false otherwise
      */
-    QList<QMap<QString, QVariant>> searchFlights(const QString& departureCity, 
-                                                const QString& arrivalCity, 
-                                                const QDate& departureDate, 
-                                                const QDate& returnDate = QDate());
+    bool reloadReferenceData();
 
     /**
-     * @brief Get information about an airport
+     * @brief Drop cached airports and airlines, the next lookup reloads them
+     *
+     * Call after changing the airports or airlines tables.
+     */
+    void invalidateReferenceData();
+
+    /**
+     * @brief Get information about an airport, served from the reference data cache
      * @param airportCode IATA code of the airport
-     * @return Map containing airport information
+     * @return Airport information, invalid if not found
+     */
+    AirportRow getAirportInfo(const QString& airportCode);
+
+    /**
+     * @brief Get an airport by id, served from the reference data cache
+     * @param airportId Airport ID
+     * @return Airport information, invalid if not found
      */
-    QMap<QString, QVariant> getAirportInfo(const QString& airportCode);
+    AirportRow getAirport(int airportId);
 
     /**
-     * @brief Get all available airports
-     * @return List of airports
+     * @brief Get all available airports, served from the reference data cache
+     * @return List of airports ordered by city and name
      */
-    QList<QMap<QString, QVariant>> getAllAirports();
+    QVector<AirportRow> getAllAirports();
+
+    /**
+     * @brief Get an airline by id, served from the reference data cache
+     * @param airlineId Airline ID
+     * @return Airline, invalid if not found
+     */
+    AirlineRow getAirline(int airlineId);
+
+    /**
+     * @brief Get all airlines, served from the reference data cache
+     * @return List of airlines ordered by name
+     */
+    QVector<AirlineRow> getAllAirlines();
 
     /**
      * @brief Book a ticket for a flight
@@ -70,17 +289,78 @@ public:
      * @param seatClass Seat class (Economy, Business, First)
      * @param passengerName Passenger name
      * @param passengerPassport Passenger passport number
-     * @return Booking ID if successful, -1 otherwise
+     * @return Booking ID if successful, -1 if sold out or on error
      */
     int bookTicket(int flightId, int userId, const QString& seatClass, 
                   const QString& passengerName, const QString& passengerPassport);
 
+    /**
+     * @brief Book tickets for a group of passengers on one flight
+     *
+     * The seats are taken with one conditional update and all bookings are
+     * inserted with one statement; either every passenger is booked or none.
+     * @param flightId Flight ID
+     * @param userId User ID
+     * @param seatClass Seat class (Economy, Business, First)
+     * @param passengers One to MaxPassengersPerBooking passengers
+     * @return Booking IDs in passenger order, empty if not enough seats or on error
+     */
+    QVector<int> bookTickets(int flightId, int userId, const QString& seatClass,
+                             const QVector<Passenger>& passengers);
+
+    /**
+     * @brief Book several independent requests in one transaction
+     *
+     * Each request succeeds or fails on its own, but all of them share one
+     * commit. Used by BookingWriteQueue to group commits of concurrent callers;
+     * the benchmark is its only user.
+     * @param requests Booking requests
+     * @return Booking IDs per request, empty for requests that could not be booked
+     */
+    QVector<QVector<int>> bookTicketsBatch(const QVector<BookingRequest>& requests);
+
+    /**
+     * @brief Take seats off a flight for a limited time
+     *
+     * The seats leave the flight counter at once and return when the hold is
+     * released or expires. Use SeatHoldService to expire holds on time.
+     * @param flightId Flight ID
+     * @param userId User ID
+     * @param seatClass Seat class (Economy, Business, First)
+     * @param count Number of seats
+     * @param ttlSeconds Seconds until the hold expires
+     * @return Hold, invalid if not enough seats or on error; SeatHold::remainingSeats
+     *         tells the two apart
+     */
+    SeatHold holdSeats(int flightId, int userId, const QString& seatClass, int count, int ttlSeconds);
+
+    /**
+     * @brief Turn an unexpired hold into bookings without checking availability again
+     * @param holdId Hold ID
+     * @param passengers One passenger per held seat
+     * @return Booking IDs in passenger order, empty if the hold expired or on error
+     */
+    QVector<int> confirmHold(qint64 holdId, const QVector<Passenger>& passengers);
+
+    /**
+     * @brief Return the seats of a hold to the flight
+     * @param holdId Hold ID
+     * @return True if successful, also when the hold no longer exists
+     */
+    bool releaseHold(qint64 holdId);
+
+    /**
+     * @brief Return the seats of all expired holds, including those of other clients
+     * @return Number of flights whose counters were restored, -1 on error
+     */
+    int releaseExpiredHolds();
+
     /**
      * @brief Get user bookings
      * @param userId User ID
      * @return List of bookings
      */
-    QList<QMap<QString, QVariant>> getUserBookings(int userId);
+    QVector<BookingRow> getUserBookings(int userId);
 
     /**
      * @brief Register a new user
@@ -95,6 +375,9 @@ public:
 
     /**
      * @brief Authenticate a user
+     *
+     * The password is verified on the password hasher pool. Hashes weaker than
+     * the current cost, including legacy SHA-256 digests, are replaced on success.
      * @param username Username
      * @param password Password
      * @return User ID if successful, -1 otherwise
@@ -104,9 +387,9 @@ public:
     /**
      * @brief Get user profile information
      * @param userId User ID
-     * @return Map containing user information
+     * @return User information, invalid if not found
      */
-    QMap<QString, QVariant> getUserProfile(int userId);
+    UserProfileRow getUserProfile(int userId);
 
     /**
      * @brief Update user profile information
@@ -117,6 +400,133 @@ public:
      */
     bool updateUserProfile(int userId, const QString& email, const QString& fullName);
 
+    /**
+     * @brief Get prepared statement cache counters
+     * @return Prepare hits and misses across all pooled connections
+     */
+    StatementRegistry::Stats statementStats() const;
+
+    /**
+     * @brief Get the thread pool that runs asynchronous queries
+     * @return Database worker pool
+     */
+    QThreadPool* workerPool();
+
+    /**
+     * @brief Get the password hasher used by registration and login
+     * @return Password hasher
+     */
+    PasswordHasher* passwordHasher();
+
+    /**
+     * @brief Asynchronous variant of searchFlights()
+     */
+    QFuture<QVector<FlightRow>> searchFlightsAsync(const QString& departureCity,
+                                                   const QString& arrivalCity,
+                                                   const QDate& departureDate,
+                                                   const QDate& returnDate = QDate());
+
+    /**
+     * @brief Asynchronous variant of searchItineraries()
+     */
+    QFuture<QVector<ItineraryRow>> searchItinerariesAsync(const QString& departureCity,
+                                                          const QString& arrivalCity,
+                                                          const QDate& departureDate,
+                                                          const ItineraryOptions& options = ItineraryOptions());
+
+    /**
+     * @brief Asynchronous variant of searchRoundTripPairs()
+     */
+    QFuture<QVector<RoundTripRow>> searchRoundTripPairsAsync(const QString& departureCity,
+                                                             const QString& arrivalCity,
+                                                             const QDate& departureDate,
+                                                             const QDate& returnDate,
+                                                             const QString& seatClass = "Economy",
+                                                             int limit = 50);
+
+    /**
+     * @brief Asynchronous variant of getFareCalendar()
+     */
+    QFuture<QVector<FareDayRow>> getFareCalendarAsync(const QString& departureCity,
+                                                      const QString& arrivalCity,
+                                                      const QDate& centerDate,
+                                                      int days = 30);
+
+    /**
+     * @brief Asynchronous variant of getFlight()
+     */
+    QFuture<FlightRow> getFlightAsync(int flightId);
+
+    /**
+     * @brief Asynchronous variant of getDeparturesPage()
+     */
+    QFuture<QVector<FlightRow>> getDeparturesPageAsync(const QString& airportCode, const FlightCursor& after, int limit);
+
+    /**
+     * @brief Asynchronous variant of getAirportLoading()
+     */
+    QFuture<QVector<AirportLoadRow>> getAirportLoadingAsync(const QString& airportCode, const QDateTime& from,
+                                                            const QDateTime& to, int bucketMinutes = 60);
+
+    /**
+     * @brief Asynchronous variant of getNetworkLoading()
+     */
+    QFuture<QVector<AirportLoadRow>> getNetworkLoadingAsync(const QDateTime& from, const QDateTime& to,
+                                                            int bucketMinutes = 60);
+
+    /**
+     * @brief Asynchronous variant of getAirportInfo()
+     */
+    QFuture<AirportRow> getAirportInfoAsync(const QString& airportCode);
+
+    /**
+     * @brief Asynchronous variant of getAllAirports()
+     */
+    QFuture<QVector<AirportRow>> getAllAirportsAsync();
+
+    /**
+     * @brief Asynchronous variant of confirmHold()
+     */
+    QFuture<QVector<int>> confirmHoldAsync(qint64 holdId, const QVector<Passenger>& passengers);
+
+    /**
+     * @brief Asynchronous variant of bookTicket()
+     */
+    QFuture<int> bookTicketAsync(int flightId, int userId, const QString& seatClass,
+                                 const QString& passengerName, const QString& passengerPassport);
+
+    /**
+     * @brief Asynchronous variant of bookTickets()
+     */
+    QFuture<QVector<int>> bookTicketsAsync(int flightId, int userId, const QString& seatClass,
+                                           const QVector<Passenger>& passengers);
+
+    /**
+     * @brief Asynchronous variant of getUserBookings()
+     */
+    QFuture<QVector<BookingRow>> getUserBookingsAsync(int userId);
+
+    /**
+     * @brief Asynchronous variant of registerUser()
+     */
+    QFuture<int> registerUserAsync(const QString& username, const QString& password,
+                                   const QString& email, const QString& fullName);
+
+    /**
+     * @brief Asynchronous variant of authenticateUser()
+     */
+    QFuture<int> authenticateUserAsync(const QString& username, const QString& password);
+
+    /**
+     * @brief Asynchronous variant of getUserProfile()
+     */
+    QFuture<UserProfileRow> getUserProfileAsync(int userId);
+
+    /**
+     * @brief Asynchronous variant of updateUserProfile()
+     */
+    QFuture<bool> updateUserProfileAsync(int userId, const QString& email, const QString& fullName);
+
 private:
     /**
      * @brief Private constructor for singleton pattern
@@ -129,17 +539,49 @@ private:
     ~Database();
 
     /**
-     * @brief Create database tables if they don't exist
+     * @brief Apply pending schema migrations
+     * @return True if the schema is up to date
+     */
+    bool migrateSchema();
+
+    /**
+     * @brief Populate database with sample data in one bulk-loaded transaction
+     * @return True if successful, false otherwise
+     */
+    bool populateSampleData();
+
+    /**
+     * @brief Queue a background timetable rebuild unless one is queued or running
+     */
+    void scheduleTimetableRebuild();
+
+    /**
+     * @brief Load a timetable snapshot after TimetableEngine::startRebuild() succeeded
+     * @return True if successful, false otherwise
+     */
+    bool loadTimetable();
+
+    /**
+     * @brief Read all airports from the database
+     * @param ok Set to false if the airports could not be read
      */
-    void createTables();
+    QVector<AirportRow> queryAllAirports(bool* ok);
 
     /**
-     * @brief Populate database with sample data
+     * @brief Read all airlines from the database
+     * @param ok Set to false if the airlines could not be read
      */
-    void populateSampleData();
+    QVector<AirlineRow> queryAllAirlines(bool* ok);
 
     static Database* instance;
-    QSqlDatabase db;
+    ConnectionPool::Settings poolSettings;
+    ConnectionPool *pool;
+    QThreadPool workers;
+    ReferenceDataCache referenceCache;
+    QMutex referenceLoadMutex;
+    TimetableEngine timetable;
+    PasswordHasher passwords;
+    std::atomic<bool> timetableEnabled;
 };
 
 #endif // DATABASE_H 
\ No newline at end of file
@@ -0,0 +1,292 @@
+#ifndef DATABASEROWS_H
+#define DATABASEROWS_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief One row of the airports table
+ */
+struct AirportRow
+{
+    int id = -1;
+    QString code;
+    QString name;
+    QString city;
+    QString country;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    QString timezone;
+    QString description;
+
+    /**
+     * @brief Check whether the row was loaded
+     * @return True if the row holds an airport
+     */
+    bool isValid() const { return id >= 0; }
+};
+
+/**
+ * @brief One row of the airlines table
+ */
+struct AirlineRow
+{
+    int id = -1;
+    QString code;
+    QString name;
+    QString country;
+    QString logo;
+
+    /**
+     * @brief Check whether the row was loaded
+     * @return True if the row holds an airline
+     */
+    bool isValid() const { return id >= 0; }
+};
+
+/**
+ * @brief A flight joined with its airline and airports
+ */
+struct FlightRow
+{
+    int id = -1;
+    QString flightNumber;
+    QString airlineName;
+    QString departureCode;
+    QString departureCity;
+    QString arrivalCode;
+    QString arrivalCity;
+    QDateTime departureTime;
+    QDateTime arrivalTime;
+    double priceEconomy = 0.0;
+    double priceBusiness = 0.0;
+    double priceFirst = 0.0;
+    int availableSeatsEconomy = 0;
+    int availableSeatsBusiness = 0;
+    int availableSeatsFirst = 0;
+    bool isReturn = false;
+
+    /**
+     * @brief Check whether the row was loaded
+     * @return True if the row holds a flight
+     */
+    bool isValid() const { return id >= 0; }
+
+    /**
+     * @brief Get the price for a seat class
+     * @param seatClass Seat class (Economy, Business, First)
+     * @return Price, 0 for an unknown class
+     */
+    double price(const QString &seatClass) const
+    {
+        if (seatClass == "Economy") {
+            return priceEconomy;
+        } else if (seatClass == "Business") {
+            return priceBusiness;
+        } else if (seatClass == "First") {
+            return priceFirst;
+        }
+        return 0.0;
+    }
+
+    /**
+     * @brief Get the number of available seats for a seat class
+     * @param seatClass Seat class (Economy, Business, First)
+     * @return Available seats, 0 for an unknown class
+     */
+    int availableSeats(const QString &seatClass) const
+    {
+        if (seatClass == "Economy") {
+            return availableSeatsEconomy;
+        } else if (seatClass == "Business") {
+            return availableSeatsBusiness;
+        } else if (seatClass == "First") {
+            return availableSeatsFirst;
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief Keyset position in a list of flights ordered by departure time and id
+ */
+struct FlightCursor
+{
+    QDateTime departureTime;
+    int id = -1;
+
+    /**
+     * @brief Check whether the cursor points after a row
+     * @return False for the start of the list
+     */
+    bool isValid() const { return id >= 0; }
+};
+
+/**
+ * @brief An outbound and a return flight offered together
+ */
+struct RoundTripRow
+{
+    FlightRow outbound;
+    FlightRow returnFlight;
+    double totalPrice = 0.0;
+};
+
+/**
+ * @brief A journey of one or more connecting flights
+ */
+struct ItineraryRow
+{
+    QVector<FlightRow> legs;
+    double totalPrice = 0.0;
+
+    /**
+     * @brief Get the departure time of the first leg
+     * @return Departure time, invalid for an empty itinerary
+     */
+    QDateTime departureTime() const { return legs.isEmpty() ? QDateTime() : legs.first().departureTime; }
+
+    /**
+     * @brief Get the arrival time of the last leg
+     * @return Arrival time, invalid for an empty itinerary
+     */
+    QDateTime arrivalTime() const { return legs.isEmpty() ? QDateTime() : legs.last().arrivalTime; }
+};
+
+/**
+ * @brief Cheapest fares and free seats of a route on one day
+ */
+struct FareDayRow
+{
+    QDate date;
+    int flightCount = 0;
+    double minPriceEconomy = 0.0;
+    double minPriceBusiness = 0.0;
+    double minPriceFirst = 0.0;
+    int availableSeatsEconomy = 0;
+    int availableSeatsBusiness = 0;
+    int availableSeatsFirst = 0;
+
+    /**
+     * @brief Get the cheapest price for a seat class
+     * @param seatClass Seat class (Economy, Business, First)
+     * @return Price, 0 if the class is sold out or unknown
+     */
+    double minPrice(const QString &seatClass) const
+    {
+        if (seatClass == "Economy") {
+            return minPriceEconomy;
+        } else if (seatClass == "Business") {
+            return minPriceBusiness;
+        } else if (seatClass == "First") {
+            return minPriceFirst;
+        }
+        return 0.0;
+    }
+};
+
+/**
+ * @brief Departures and arrivals of an airport in one time bucket
+ */
+struct AirportLoadRow
+{
+    QString airportCode;
+    QDateTime bucketStart;
+    int departures = 0;
+    int arrivals = 0;
+    int seatsSold = 0;
+
+    /**
+     * @brief Get all movements of the bucket
+     * @return Departures and arrivals together
+     */
+    int movements() const { return departures + arrivals; }
+};
+
+// Passengers booked together, as most airlines allow on one reservation
+static const int MaxPassengersPerBooking = 9;
+
+/**
+ * @brief A traveller named on a booking
+ */
+struct Passenger
+{
+    QString name;
+    QString passport;
+};
+
+/**
+ * @brief Tickets to book for a group of passengers on one flight
+ */
+struct BookingRequest
+{
+    int flightId = -1;
+    int userId = -1;
+    QString seatClass;
+    QVector<Passenger> passengers;
+};
+
+/**
+ * @brief Seats taken off a flight for a limited time until they are booked
+ */
+struct SeatHold
+{
+    qint64 id = -1;
+    int flightId = -1;
+    int userId = -1;
+    QString seatClass;
+    int seats = 0;
+    QDateTime expiresAt;
+
+    // Seats left in the class after the hold. A hold refused for lack of seats
+    // carries an upper bound below the requested count, -1 on database errors.
+    int remainingSeats = -1;
+
+    /**
+     * @brief Check whether the hold was placed
+     * @return True if the row holds seats
+     */
+    bool isValid() const { return id >= 0; }
+};
+
+/**
+ * @brief A booking joined with its flight
+ */
+struct BookingRow
+{
+    int id = -1;
+    QDateTime bookingDate;
+    QString seatClass;
+    QString passengerName;
+    QString passengerPassport;
+    QString status;
+    QString flightNumber;
+    QString airlineName;
+    QString departureCode;
+    QString departureCity;
+    QString arrivalCode;
+    QString arrivalCity;
+    QDateTime departureTime;
+    QDateTime arrivalTime;
+};
+
+/**
+ * @brief Public profile data of a user
+ */
+struct UserProfileRow
+{
+    int id = -1;
+    QString username;
+    QString email;
+    QString fullName;
+    QDateTime registrationDate;
+
+    /**
+     * @brief Check whether the row was loaded
+     * @return True if the row holds a user
+     */
+    bool isValid() const { return id >= 0; }
+};
+
+#endif // DATABASEROWS_H
@@ -0,0 +1,153 @@
+#ifndef DATASETGENERATOR_H
+#define DATASETGENERATOR_H
+
+#include <QDate>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class ConnectionPool;
+class QSqlDatabase;
+
+/**
+ * @brief Size and distribution knobs of a synthetic dataset
+ */
+struct DatasetOptions
+{
+    quint64 seed = 42;
+    int airports = 200;
+    int airlines = 20;
+    int routes = 2000;
+    int days = 90;
+    int flightsPerDay = 5000;
+    int users = 100000;
+    int bookings = 1000000;
+    int jobs = 4;
+    QDate startDate = QDate::currentDate();
+    double hubFraction = 0.05;
+    double zipfExponent = 1.1;
+    bool reset = false;
+};
+
+/**
+ * @brief The DatasetGenerator class fills the database with a reproducible synthetic dataset
+ *
+ * The network is hub-and-spoke: hubs are fully connected, every spoke is tied to
+ * a hub and the remaining routes are drawn with Zipfian airport popularity. Route
+ * traffic and user activity follow Zipf distributions. Flights are generated per
+ * day and bookings per fixed-size chunk, each partition from its own seed, so the
+ * same options always produce the same rows regardless of the number of jobs.
+ * Partitions are bulk-loaded in parallel, one pooled connection per thread.
+ * Flights start with their full capacity; once bookings are loaded, bookings
+ * beyond the capacity of a seat class are dropped and the rest are subtracted
+ * from the seat counters.
+ */
+class DatasetGenerator
+{
+public:
+    /**
+     * @brief Constructor
+     * @param pool Connection pool sized for at least options.jobs connections
+     * @param options Dataset size and distribution
+     */
+    DatasetGenerator(ConnectionPool *pool, const DatasetOptions &options);
+
+    /**
+     * @brief Generate and load the whole dataset
+     * @return True if successful, false otherwise
+     */
+    bool generate();
+
+    /**
+     * @brief Get the text of the last error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    struct Airport
+    {
+        QString code;
+        QString name;
+        QString city;
+        QString country;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        QString timezone;
+    };
+
+    struct Route
+    {
+        int departure = 0;
+        int arrival = 0;
+        int durationMinutes = 0;
+        double basePrice = 0.0;
+    };
+
+    /**
+     * @brief Build the airport and route network in memory
+     */
+    void buildNetwork();
+
+    /**
+     * @brief Check the tables are empty or truncate them when reset is requested
+     */
+    bool prepareTables(QSqlDatabase &db);
+
+    /**
+     * @brief Load airports and airlines
+     */
+    bool loadReferenceData(QSqlDatabase &db);
+
+    /**
+     * @brief Load the flights of one day
+     */
+    bool loadFlights(QSqlDatabase &db, int day);
+
+    /**
+     * @brief Load one chunk of users
+     */
+    bool loadUsers(QSqlDatabase &db, int chunk);
+
+    /**
+     * @brief Load one chunk of bookings
+     */
+    bool loadBookings(QSqlDatabase &db, int chunk);
+
+    /**
+     * @brief Cap bookings at the seats of their flight and class and take them off the seat counters
+     */
+    bool settleSeats(QSqlDatabase &db);
+
+    /**
+     * @brief Move the id sequences past the loaded rows
+     */
+    bool finishSequences(QSqlDatabase &db);
+
+    /**
+     * @brief Run partitions in parallel, each in its own transaction
+     * @param name Name of the loaded entity for progress output
+     * @param count Number of partitions
+     * @param load Loads one partition through the connection of the calling thread
+     * @return True if every partition was loaded
+     */
+    bool runPartitions(const QString &name, int count,
+                       const std::function<bool(QSqlDatabase &, int)> &load);
+
+    /**
+     * @brief Record the first error raised by any partition
+     */
+    void setError(const QString &error);
+
+    ConnectionPool *pool;
+    DatasetOptions options;
+    QVector<Airport> airports;
+    QVector<Route> routes;
+    QString passwordHash;
+    int droppedBookings;
+    mutable QMutex errorMutex;
+    QString errorText;
+};
+
+#endif // DATASETGENERATOR_H
@@ -0,0 +1,94 @@
+#ifndef FLIGHTLISTMODEL_H
+#define FLIGHTLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+#include "database.h"
+
+/**
+ * @brief The FlightListModel class shows the departures of an airport page by page
+ *
+ * Pages are fetched asynchronously with keyset pagination as the view scrolls.
+ * Only a bounded number of pages is kept; evicted pages are fetched again from
+ * the cursor remembered for them when they become visible.
+ */
+class FlightListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        FlightNumberColumn,
+        DestinationColumn,
+        DepartureTimeColumn,
+        ArrivalTimeColumn,
+        SeatsColumn,
+        ColumnCount
+    };
+
+    /**
+     * @brief Constructor
+     * @param parent Parent object
+     * @param pageSize Rows per page
+     * @param maxCachedPages Pages kept in memory
+     */
+    explicit FlightListModel(QObject *parent = nullptr, int pageSize = 200, int maxCachedPages = 16);
+
+    /**
+     * @brief Show the departures of an airport
+     * @param airportCode Airport IATA code, empty to clear the list
+     */
+    void setAirport(const QString &airportCode);
+
+    /**
+     * @brief Get the flight shown in a row
+     * @param row Row number
+     * @return Flight, invalid while its page is not loaded
+     */
+    FlightRow flightAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    /**
+     * @brief Start loading a page unless it is already on its way
+     */
+    void requestPage(int page) const;
+
+    /**
+     * @brief Store a loaded page and publish its rows
+     */
+    void pageLoaded(int page, quint64 generation, const QVector<FlightRow> &rows);
+
+    /**
+     * @brief Find a cached page and mark it as recently used
+     */
+    const QVector<FlightRow> *cachedPage(int page) const;
+
+    /**
+     * @brief Drop least recently used pages above the cache limit
+     */
+    void evictPages();
+
+    Database *db;
+    QString airportCode;
+    int pageSize;
+    int maxCachedPages;
+    int rows;
+    bool atEnd;
+    quint64 generation;
+    QVector<FlightCursor> anchors;
+    mutable QHash<int, QVector<FlightRow>> pages;
+    mutable QList<int> recentPages;
+    mutable QSet<int> pendingPages;
+};
+
+#endif // FLIGHTLISTMODEL_H
@@ -5,7 +5,9 @@
 #include <QComboBox>
 #include <QDateEdit>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QTableView>
+#include <QProgressBar>
 #include "database.h"
 
 /**
@@ -52,6 +54,17 @@ private slots:
      * @param index Selected index
      */
     void onFlightSelected(const QModelIndex &index);
+    
+    /**
+     * @brief Load the fare calendar around the selected date
+     */
+    void loadFareCalendar();
+    
+    /**
+     * @brief Search flights on the day picked in the fare calendar
+     * @param index Selected index
+     */
+    void onFareDaySelected(const QModelIndex &index);
 
 private:
     /**
@@ -68,13 +81,29 @@ private:
      * @brief Display search results in the table
      * @param flights List of flights
      */
-    void displaySearchResults(const QList<QMap<QString, QVariant>> &flights);
+    void displaySearchResults(const QVector<FlightRow> &flights);
+    
+    /**
+     * @brief Display connecting itineraries in the table
+     * @param itineraries List of itineraries
+     */
+    void displayItineraries(const QVector<ItineraryRow> &itineraries);
+    
+    /**
+     * @brief Display the fare calendar
+     * @param days Days with flights
+     */
+    void displayFareCalendar(const QVector<FareDayRow> &days);
     
     QComboBox *departureComboBox;
     QComboBox *arrivalComboBox;
     QDateEdit *departureDateEdit;
+    QCheckBox *connectionsCheckBox;
     QPushButton *searchButton;
+    QPushButton *fareCalendarButton;
+    QProgressBar *searchProgress;
     QTableView *flightsTable;
+    QTableView *fareCalendarTable;
     
     int userId;
     
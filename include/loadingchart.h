@@ -0,0 +1,115 @@
+#ifndef LOADINGCHART_H
+#define LOADINGCHART_H
+
+#include <QPixmap>
+#include <QVector>
+#include <QWidget>
+#include "databaserows.h"
+
+/**
+ * @brief The LoadingChartWidget class draws departures and arrivals per time bucket
+ *
+ * The chart is painted with QPainter into a cached pixmap that is only redrawn
+ * when the data, the visible range or the widget size change; other repaints
+ * copy the pixmap. Zoomed in, every bucket is a stacked bar. Zoomed out, each
+ * pixel column shows the peak of the buckets under it, read from a pyramid of
+ * per-block maxima, so a redraw costs about one lookup per column however many
+ * buckets the data holds.
+ *
+ * The wheel zooms around the cursor, dragging pans and a double click shows
+ * the whole range again.
+ */
+class LoadingChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent widget
+     */
+    explicit LoadingChartWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief Show new data and reset the zoom
+     * @param buckets Evenly spaced buckets in time order
+     */
+    void setData(const QVector<AirportLoadRow> &buckets);
+
+    /**
+     * @brief Get the number of buckets shown when fully zoomed out
+     * @return Bucket count
+     */
+    int bucketCount() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    /**
+     * @brief Peaks of one block of buckets
+     */
+    struct Peak
+    {
+        int departures = 0;
+        int total = 0;
+    };
+
+    /**
+     * @brief Rebuild the block maxima after the data changed
+     */
+    void buildLevels();
+
+    /**
+     * @brief Get the peaks of a range of buckets
+     * @param first First bucket
+     * @param last Bucket after the range
+     */
+    Peak peak(int first, int last) const;
+
+    /**
+     * @brief Move the visible range, keeping it inside the data, and schedule a redraw
+     */
+    void setView(double first, double count);
+
+    /**
+     * @brief Draw the chart into the cached pixmap
+     */
+    void render();
+
+    /**
+     * @brief Get the area of the widget the buckets are drawn in
+     */
+    QRectF plotArea() const;
+
+    /**
+     * @brief Get the label of a bucket for the time axis
+     */
+    QString bucketLabel(int bucket) const;
+
+    QVector<qint64> starts;
+    QVector<int> departures;
+    QVector<int> arrivals;
+    qint64 bucketMs = 0;
+
+    // levels[k][i] holds the peaks of buckets [i << k, (i + 1) << k)
+    QVector<QVector<Peak>> levels;
+
+    double viewFirst = 0.0;
+    double viewCount = 0.0;
+
+    QPixmap cache;
+    bool cacheValid = false;
+
+    bool dragging = false;
+    double dragX = 0.0;
+    double dragFirst = 0.0;
+};
+
+#endif // LOADINGCHART_H
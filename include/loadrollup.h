@@ -0,0 +1,68 @@
+#ifndef LOADROLLUP_H
+#define LOADROLLUP_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The LoadRollup class rebuilds and checks the hourly airport loading rollup
+ *
+ * The airport_hourly_load table is kept current by triggers on the flights and
+ * bookings tables. Rebuilding replaces it with the aggregate computed from
+ * scratch by airport_hourly_load_source(); checking compares both without
+ * changing anything.
+ */
+class LoadRollup
+{
+public:
+    /**
+     * @brief Result of a consistency check
+     */
+    struct Report
+    {
+        qint64 rows = 0;
+        qint64 mismatches = 0;
+        QStringList samples;
+
+        /**
+         * @brief Check whether the rollup matched the flights and bookings
+         * @return True if no hour differs
+         */
+        bool isConsistent() const { return mismatches == 0; }
+    };
+
+    /**
+     * @brief Constructor
+     * @param db Open connection, not inside a transaction
+     */
+    explicit LoadRollup(const QSqlDatabase &db);
+
+    /**
+     * @brief Replace the rollup with a fresh aggregate
+     *
+     * Writers of flights and bookings wait until the rebuild commits, so no
+     * trigger delta is lost between the aggregate and the commit.
+     * @return True if successful
+     */
+    bool rebuild();
+
+    /**
+     * @brief Compare the rollup with a fresh aggregate in one snapshot
+     * @param report Receives the differing hours
+     * @return True if the check ran
+     */
+    bool check(Report *report);
+
+    /**
+     * @brief Get the text of the last error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    QSqlDatabase db;
+    QString errorText;
+};
+
+#endif // LOADROLLUP_H
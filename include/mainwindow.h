@@ -15,6 +15,8 @@
 #include "ticketbooking.h"
 #include "userprofile.h"
 #include "airportloading.h"
+#include "networkdashboard.h"
+#include "sessionmanager.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -65,6 +67,11 @@ private slots:
      */
     void showAirportLoading();
     
+    /**
+     * @brief Show the loading dashboard of all airports
+     */
+    void showNetworkLoading();
+    
     /**
      * @brief Show the login dialog
      */
@@ -87,9 +94,9 @@ private slots:
     
     /**
      * @brief Handle user login
-     * @param userId User ID
+     * @param token Session token
      */
-    void onUserLoggedIn(int userId);
+    void onUserLoggedIn(const QString &token);
     
     /**
      * @brief Show the about dialog
@@ -129,13 +136,14 @@ private:
     TicketBooking *ticketBookingPage;
     UserProfile *userProfilePage;
     AirportLoadingWidget *airportLoadingPage;
+    NetworkLoadWidget *networkLoadPage;
     
     QLabel *statusLabel;
     
-    int currentUserId;
-    QString currentUsername;
+    QString currentToken;
     
     Database *db;
+    SessionManager *sessions;
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
@@ -0,0 +1,155 @@
+#ifndef MOVEMENTINDEX_H
+#define MOVEMENTINDEX_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QString>
+#include <QTime>
+#include <QVector>
+
+class QSqlDatabase;
+
+/**
+ * @brief Departures and arrivals counted over a time window
+ */
+struct MovementCount
+{
+    int departures = 0;
+    int arrivals = 0;
+
+    /**
+     * @brief Get all movements of the window
+     * @return Departures and arrivals together
+     */
+    int movements() const { return departures + arrivals; }
+};
+
+/**
+ * @brief The MovementIndex class counts the movements of one airport in any time window
+ *
+ * Departures and arrivals are kept in two Fenwick trees over the minutes of a
+ * range of days, so the count of any window costs two prefix sums of
+ * O(log n) each and a flight change is a point update of the same cost.
+ * Minutes are wall-clock minutes as stored in the flights table.
+ *
+ * A year of minutes takes about 4 MB per airport, so indexes are built for
+ * the airports that are actually analysed rather than for the whole network.
+ * Queries and updates may come from any thread.
+ *
+ * An index is a snapshot of the flights table taken by load(). Nothing feeds
+ * it flight changes: the application never adds, moves or removes flights,
+ * and changes made by other clients are picked up by building a new index.
+ * addDeparture() and addArrival() are for owners that apply their own changes.
+ */
+class MovementIndex
+{
+public:
+    /**
+     * @brief Constructor, creates an index without movements
+     * @param airportId Airport ID
+     * @param firstDay First day covered
+     * @param days Number of days covered
+     */
+    MovementIndex(int airportId, const QDate &firstDay, int days);
+
+    /**
+     * @brief Build the index of an airport from the flights table
+     * @param db Open connection
+     * @param airportId Airport ID
+     * @param firstDay First day covered
+     * @param days Number of days covered
+     * @param error Receives the error text on failure
+     * @return Index, null on error
+     */
+    static QSharedPointer<MovementIndex> load(const QSqlDatabase &db, int airportId, const QDate &firstDay,
+                                              int days, QString *error);
+
+    /**
+     * @brief Get the airport the index counts
+     * @return Airport ID
+     */
+    int airportId() const;
+
+    /**
+     * @brief Get the first day covered
+     * @return Date
+     */
+    QDate firstDay() const;
+
+    /**
+     * @brief Get the number of days covered
+     * @return Day count
+     */
+    int days() const;
+
+    /**
+     * @brief Count departures and arrivals in [from, to) to the minute, clipped to the covered days
+     * @param from Start of the window
+     * @param to End of the window
+     * @return Movement counts
+     */
+    MovementCount count(const QDateTime &from, const QDateTime &to) const;
+
+    /**
+     * @brief Count movements between two times of day on selected weekdays
+     *
+     * For example 06:10 to 09:45 on Tuesdays of a quarter. A window whose end
+     * is not after its start runs past midnight into the next day.
+     * @param firstDay First day of the period
+     * @param lastDay Last day of the period
+     * @param start Start time of day
+     * @param end End time of day
+     * @param weekdays Bit (1 << Qt::DayOfWeek) set for every weekday to count
+     * @return Movement counts summed over the matching days
+     */
+    MovementCount countRecurring(const QDate &firstDay, const QDate &lastDay, const QTime &start,
+                                 const QTime &end, int weekdays) const;
+
+    /**
+     * @brief Add or remove a departure
+     * @param time Departure time, ignored outside the covered days
+     * @param delta 1 for a new flight, -1 for a removed one
+     */
+    void addDeparture(const QDateTime &time, int delta = 1);
+
+    /**
+     * @brief Add or remove an arrival
+     * @param time Arrival time, ignored outside the covered days
+     * @param delta 1 for a new flight, -1 for a removed one
+     */
+    void addArrival(const QDateTime &time, int delta = 1);
+
+private:
+    /**
+     * @brief Get the minute of a time counted from the first covered day
+     */
+    qint64 minuteOf(const QDateTime &time) const;
+
+    /**
+     * @brief Turn per-minute counts into a Fenwick tree in linear time
+     */
+    static void buildTree(QVector<qint32> &tree);
+
+    /**
+     * @brief Sum the first minutes of a tree
+     * @param minutes Number of minutes summed, from 0 to the tree size
+     */
+    static qint32 prefix(const QVector<qint32> &tree, int minutes);
+
+    /**
+     * @brief Add to the count of one minute of a tree
+     */
+    static void add(QVector<qint32> &tree, int minute, int delta);
+
+    int airport;
+    QDate first;
+    int dayCount;
+    mutable QReadWriteLock lock;
+    // One-based Fenwick trees, slot 0 unused
+    QVector<qint32> departureTree;
+    QVector<qint32> arrivalTree;
+};
+
+#endif // MOVEMENTINDEX_H
@@ -0,0 +1,112 @@
+#ifndef NETWORKDASHBOARD_H
+#define NETWORKDASHBOARD_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QSpinBox>
+#include <QTableView>
+#include <QSortFilterProxyModel>
+#include <QTimer>
+#include <QSharedPointer>
+#include "database.h"
+#include "loadingchart.h"
+#include "networkload.h"
+#include "networkloadmodel.h"
+
+/**
+ * @brief Класс для отображения загруженности всех аэропортов сети
+ */
+class NetworkLoadWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор
+     * @param parent Родительский виджет
+     */
+    explicit NetworkLoadWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief Деструктор
+     */
+    ~NetworkLoadWidget();
+
+public slots:
+    /**
+     * @brief Пересчитать показатели; пересчитываются только изменившиеся аэропорты
+     */
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    /**
+     * @brief Обработчик нажатия кнопки выхода
+     */
+    void onCloseButtonClicked();
+
+    /**
+     * @brief Включить или выключить автообновление
+     * @param enabled Автообновление включено
+     */
+    void onAutoRefreshToggled(bool enabled);
+
+    /**
+     * @brief Показать почасовую гистограмму выбранного аэропорта или всей сети
+     */
+    void updateHistogram();
+
+private:
+    /**
+     * @brief Настройка пользовательского интерфейса
+     */
+    void setupUi();
+
+    /**
+     * @brief Показать результат пересчета
+     * @param report Показатели аэропортов
+     */
+    void showReport(const NetworkLoadReport &report);
+
+    // Выбор периода и пропускной способности
+    QDateEdit *dateEdit;
+    QComboBox *periodComboBox;
+    QSpinBox *capacitySpinBox;
+    QCheckBox *autoRefreshCheckBox;
+    QPushButton *refreshButton;
+
+    // Таблица аэропортов и гистограмма по часам суток
+    QTableView *tableView;
+    NetworkLoadModel *model;
+    QSortFilterProxyModel *proxyModel;
+    QLabel *histogramLabel;
+    LoadingChartWidget *histogramWidget;
+    QLabel *statusLabel;
+
+    QPushButton *closeButton;
+
+    // Расчет живет дольше виджета, пока выполняется пересчет
+    QSharedPointer<NetworkLoadAnalyzer> analyzer;
+    QStringList airportCodes;
+    QTimer *refreshTimer;
+    bool refreshing;
+    bool refreshPending;
+
+    // База данных
+    Database *db;
+
+signals:
+    /**
+     * @brief Сигнал о закрытии виджета
+     */
+    void closeRequested();
+};
+
+#endif // NETWORKDASHBOARD_H
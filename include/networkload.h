@@ -0,0 +1,139 @@
+#ifndef NETWORKLOAD_H
+#define NETWORKLOAD_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include "databaserows.h"
+
+/**
+ * @brief Loading metrics of one airport over a period
+ */
+struct AirportLoadSummary
+{
+    QString airportCode;
+    int departures = 0;
+    int arrivals = 0;
+    // Movements per hour of day summed over the period, 24 entries each
+    QVector<int> hourlyDepartures;
+    QVector<int> hourlyArrivals;
+    QDateTime peakStart;
+    int peakMovements = 0;
+    int capacity = 0;
+    int hoursOverCapacity = 0;
+
+    /**
+     * @brief Get all movements of the period
+     * @return Departures and arrivals together
+     */
+    int movements() const { return departures + arrivals; }
+
+    /**
+     * @brief Get the busiest hour as a share of the hourly capacity
+     * @return 1.0 at capacity, 0.0 without a configured capacity
+     */
+    double peakUtilization() const { return capacity > 0 ? double(peakMovements) / capacity : 0.0; }
+};
+
+/**
+ * @brief Loading metrics of every airport of the network
+ */
+struct NetworkLoadReport
+{
+    QDateTime from;
+    int hours = 0;
+    // One entry per analysed airport in the order the codes were given
+    QVector<AirportLoadSummary> airports;
+    // Network movements per hour of day, 24 entries each
+    QVector<int> hourlyDepartures;
+    QVector<int> hourlyArrivals;
+    // Airports recomputed by this analysis; all of them after a reset
+    QVector<int> changed;
+    bool reset = true;
+    qint64 elapsedMs = 0;
+};
+
+/**
+ * @brief The NetworkLoadAnalyzer class computes loading metrics of all airports in parallel
+ *
+ * The hourly buckets of the network are split into one partition per airport.
+ * Partitions are summarised by a map-reduce on a pool of their own, one map per
+ * airport. Summaries are kept between analyses together with a checksum of
+ * their partition, so a refresh only maps the airports whose buckets changed;
+ * a new period or capacity recomputes everything.
+ *
+ * analyze() may be called from any thread, concurrent calls run one after another.
+ */
+class NetworkLoadAnalyzer
+{
+public:
+    /**
+     * @brief Constructor
+     * @param maxThreads Threads of the analysis pool, 0 for one per core
+     */
+    explicit NetworkLoadAnalyzer(int maxThreads = 0);
+
+    /**
+     * @brief Destructor, waits for a running analysis
+     */
+    ~NetworkLoadAnalyzer();
+
+    /**
+     * @brief Set the number of movements per hour the airports can handle
+     * @param movementsPerHour Capacity of airports without an override, 0 for none
+     * @param overrides Capacity by airport IATA code
+     */
+    void setCapacity(int movementsPerHour, const QHash<QString, int> &overrides = QHash<QString, int>());
+
+    /**
+     * @brief Summarise the hourly buckets of a period
+     * @param airportCodes Airports to report, quiet ones included
+     * @param from Start of the period
+     * @param hours Length of the period in hours
+     * @param buckets Hourly buckets ordered by airport code and time, as getNetworkLoading() returns them
+     * @return Metrics of every airport and of the whole network
+     */
+    NetworkLoadReport analyze(const QStringList &airportCodes, const QDateTime &from, int hours,
+                              const QVector<AirportLoadRow> &buckets);
+
+private:
+    /**
+     * @brief Hourly buckets of one airport
+     */
+    struct Partition
+    {
+        QString airportCode;
+        const AirportLoadRow *rows = nullptr;
+        int count = 0;
+        size_t checksum = 0;
+    };
+
+    /**
+     * @brief Compute the metrics of one airport
+     */
+    static AirportLoadSummary summarize(const Partition &partition, const QDateTime &from, int capacity);
+
+    /**
+     * @brief Get the capacity of an airport
+     */
+    int capacityOf(const QString &airportCode) const;
+
+    QMutex mutex;
+    QThreadPool pool;
+
+    int defaultCapacity = 0;
+    QHash<QString, int> capacities;
+    bool capacityChanged = true;
+
+    // State of the previous analysis
+    QStringList lastCodes;
+    QDateTime lastFrom;
+    int lastHours = 0;
+    QHash<QString, size_t> checksums;
+    QHash<QString, AirportLoadSummary> summaries;
+};
+
+#endif // NETWORKLOAD_H
@@ -0,0 +1,67 @@
+#ifndef NETWORKLOADMODEL_H
+#define NETWORKLOADMODEL_H
+
+#include <QAbstractTableModel>
+#include "networkload.h"
+
+/**
+ * @brief The NetworkLoadModel class lists the loading metrics of every airport
+ *
+ * A report that keeps the airport list only updates the rows of the airports
+ * it recomputed, so views keep their selection and scroll position across
+ * refreshes. SortRole holds the raw value of every column for sorting proxies.
+ */
+class NetworkLoadModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        AirportColumn,
+        DeparturesColumn,
+        ArrivalsColumn,
+        PeakColumn,
+        PeakTimeColumn,
+        CapacityColumn,
+        UtilizationColumn,
+        OverCapacityColumn,
+        ColumnCount
+    };
+
+    static const int SortRole = Qt::UserRole;
+
+    /**
+     * @brief Constructor
+     * @param parent Parent object
+     */
+    explicit NetworkLoadModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Show a new report
+     * @param report Report of NetworkLoadAnalyzer::analyze()
+     */
+    void setReport(const NetworkLoadReport &report);
+
+    /**
+     * @brief Get the report shown
+     * @return Report
+     */
+    const NetworkLoadReport &report() const;
+
+    /**
+     * @brief Set the display names of airports
+     * @param names Name by airport IATA code
+     */
+    void setAirportNames(const QHash<QString, QString> &names);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    NetworkLoadReport current;
+    QHash<QString, QString> airportNames;
+};
+
+#endif // NETWORKLOADMODEL_H
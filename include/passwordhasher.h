@@ -0,0 +1,104 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QFuture>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+
+/**
+ * @brief The PasswordHasher class derives salted password hashes on its own thread pool
+ *
+ * Passwords are hashed with PBKDF2-HMAC-SHA256 and a random salt and stored as
+ * "pbkdf2_sha256$<iterations>$<salt>$<hash>" with base64 salt and hash. The
+ * iteration count is the cost of one hash; it is stored with every hash, so it
+ * can be raised without invalidating existing ones.
+ *
+ * Hashes run on a bounded pool separate from the database workers, so a burst
+ * of logins queues up instead of taking every core, and callers get a future
+ * per request. Unsalted SHA-256 hex digests written by older versions are still
+ * verified and reported by needsRehash().
+ */
+class PasswordHasher
+{
+public:
+    /**
+     * @brief Constructor
+     * @param iterations PBKDF2 iterations of new hashes
+     * @param maxThreads Most hashes computed at once, 0 for half of the cores
+     */
+    explicit PasswordHasher(int iterations = 100000, int maxThreads = 0);
+
+    /**
+     * @brief Destructor, waits for queued hashes
+     */
+    ~PasswordHasher();
+
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    /**
+     * @brief Set the PBKDF2 iterations of new hashes
+     * @param iterations Iteration count
+     */
+    void setIterations(int iterations);
+
+    /**
+     * @brief Get the PBKDF2 iterations of new hashes
+     * @return Iteration count
+     */
+    int iterations() const;
+
+    /**
+     * @brief Hash a password on the hashing pool
+     * @param password Password
+     * @return Encoded hash to store
+     */
+    QFuture<QString> hash(const QString &password);
+
+    /**
+     * @brief Check a password against a stored hash on the hashing pool
+     * @param password Password
+     * @param stored Stored hash
+     * @return True if the password matches
+     */
+    QFuture<bool> verify(const QString &password, const QString &stored);
+
+    /**
+     * @brief Spend the cost of a verification without a stored hash
+     *
+     * Lets a login for an unknown user take as long as one with a wrong password.
+     * @param password Password
+     * @return Always false
+     */
+    QFuture<bool> verifyDummy(const QString &password);
+
+    /**
+     * @brief Check whether a stored hash is weaker than new hashes
+     * @param stored Stored hash
+     * @return True for legacy digests and hashes with fewer iterations
+     */
+    bool needsRehash(const QString &stored) const;
+
+    /**
+     * @brief Hash a password on the calling thread
+     * @param password Password
+     * @param iterations PBKDF2 iterations
+     * @return Encoded hash to store
+     */
+    static QString hashPassword(const QString &password, int iterations);
+
+    /**
+     * @brief Check a password against a stored hash on the calling thread
+     * @param password Password
+     * @param stored Stored hash, PBKDF2 or legacy SHA-256
+     * @return True if the password matches
+     */
+    static bool verifyPassword(const QString &password, const QString &stored);
+
+private:
+    QThreadPool pool;
+    std::atomic<int> cost;
+};
+
+#endif // PASSWORDHASHER_H
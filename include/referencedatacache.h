@@ -0,0 +1,133 @@
+#ifndef REFERENCEDATACACHE_H
+#define REFERENCEDATACACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include "databaserows.h"
+
+/**
+ * @brief Immutable snapshot of airports and airlines with lookup indexes
+ *
+ * A snapshot never changes after construction, so any number of threads may
+ * read it without locking while the cache swaps in a newer one.
+ */
+class ReferenceData
+{
+public:
+    /**
+     * @brief Constructor
+     * @param airports Airports ordered for display
+     * @param airlines Airlines
+     */
+    ReferenceData(const QVector<AirportRow> &airports, const QVector<AirlineRow> &airlines);
+
+    /**
+     * @brief Get all airports
+     * @return Airports ordered by city and name
+     */
+    const QVector<AirportRow> &airports() const;
+
+    /**
+     * @brief Get all airlines
+     * @return Airlines ordered by name
+     */
+    const QVector<AirlineRow> &airlines() const;
+
+    /**
+     * @brief Find an airport by id
+     * @param id Airport ID
+     * @return Airport, nullptr if unknown
+     */
+    const AirportRow *airportById(int id) const;
+
+    /**
+     * @brief Find an airport by IATA code
+     * @param code Airport IATA code
+     * @return Airport, nullptr if unknown
+     */
+    const AirportRow *airportByCode(const QString &code) const;
+
+    /**
+     * @brief Find the airports of a city
+     * @param city City name
+     * @return Indexes into airports(), empty if unknown
+     */
+    QVector<int> airportsInCity(const QString &city) const;
+
+    /**
+     * @brief Find airports by city name or IATA code, as flight search does
+     * @param cityOrCode City name or airport IATA code
+     * @return Airport IDs
+     */
+    QVector<int> resolveAirportIds(const QString &cityOrCode) const;
+
+    /**
+     * @brief Find an airline by id
+     * @param id Airline ID
+     * @return Airline, nullptr if unknown
+     */
+    const AirlineRow *airlineById(int id) const;
+
+    /**
+     * @brief Find an airline by code
+     * @param code Airline code
+     * @return Airline, nullptr if unknown
+     */
+    const AirlineRow *airlineByCode(const QString &code) const;
+
+    /**
+     * @brief Get the time the snapshot was loaded
+     * @return Load time
+     */
+    QDateTime loadedAt() const;
+
+private:
+    QVector<AirportRow> airportRows;
+    QVector<AirlineRow> airlineRows;
+    QHash<int, int> airportIds;
+    QHash<QString, int> airportCodes;
+    QHash<QString, QVector<int>> airportCities;
+    QHash<int, int> airlineIds;
+    QHash<QString, int> airlineCodes;
+    QDateTime loadTime;
+};
+
+/**
+ * @brief The ReferenceDataCache class holds the current reference data snapshot
+ *
+ * Readers take a shared pointer to the snapshot and keep using it even if the
+ * cache is refreshed or invalidated meanwhile.
+ */
+class ReferenceDataCache
+{
+public:
+    /**
+     * @brief Get the current snapshot
+     * @return Snapshot, null if not loaded or invalidated
+     */
+    QSharedPointer<const ReferenceData> snapshot() const;
+
+    /**
+     * @brief Replace the snapshot with freshly loaded rows
+     * @param airports Airports ordered for display
+     * @param airlines Airlines
+     * @return The new snapshot
+     */
+    QSharedPointer<const ReferenceData> replace(const QVector<AirportRow> &airports,
+                                                const QVector<AirlineRow> &airlines);
+
+    /**
+     * @brief Drop the snapshot so the next lookup reloads it
+     */
+    void invalidate();
+
+private:
+    mutable QMutex mutex;
+    QSharedPointer<const ReferenceData> current;
+};
+
+#endif // REFERENCEDATACACHE_H
@@ -0,0 +1,77 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief One versioned step of the database schema
+ */
+struct SchemaMigration
+{
+    int version;
+    QString description;
+    QStringList statements;
+};
+
+/**
+ * @brief The SchemaMigrator class brings the database schema to the latest version
+ *
+ * Applied versions are recorded in the schema_migrations table. Every pending
+ * migration runs in its own transaction under an advisory lock, so concurrently
+ * started clients apply each step exactly once.
+ */
+class SchemaMigrator
+{
+public:
+    /**
+     * @brief Constructor
+     * @param db Open connection to migrate
+     */
+    explicit SchemaMigrator(const QSqlDatabase &db);
+
+    /**
+     * @brief Get all known migrations in version order
+     * @return Migration list
+     */
+    static const QVector<SchemaMigration> &migrations();
+
+    /**
+     * @brief Get the newest schema version known to this build
+     * @return Latest version
+     */
+    static int latestVersion();
+
+    /**
+     * @brief Get the schema version of the database
+     * @return Applied version, 0 for an empty database, -1 on error
+     */
+    int currentVersion();
+
+    /**
+     * @brief Apply all pending migrations
+     * @return True if the schema is at the latest version
+     */
+    bool migrate();
+
+    /**
+     * @brief Get the text of the last error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    /**
+     * @brief Apply one migration in a transaction
+     * @param migration Migration to apply
+     * @return True if applied or already present
+     */
+    bool apply(const SchemaMigration &migration);
+
+    QSqlDatabase db;
+    QString errorText;
+};
+
+#endif // SCHEMAMIGRATOR_H
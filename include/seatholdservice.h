@@ -0,0 +1,102 @@
+#ifndef SEATHOLDSERVICE_H
+#define SEATHOLDSERVICE_H
+
+#include <QObject>
+#include <QFuture>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include "databaserows.h"
+
+class Database;
+class QTimer;
+
+/**
+ * @brief The SeatHoldService class keeps seats on hold while a user fills in a booking
+ *
+ * Holds are placed with Database::holdSeats() and tracked in a timer wheel of
+ * one-second slots, so expiring them costs one slot per tick regardless of how
+ * many holds are active. Expired holds are released back to the flights table;
+ * holds left behind by crashed clients are swept periodically.
+ *
+ * Seat counters returned by the database are kept per flight and class, so a
+ * request that recently could not be satisfied is refused without a round
+ * trip. The counters are reconciled with the flights table on every hold and
+ * are forgotten after a few seconds.
+ */
+class SeatHoldService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param db Database to place holds in
+     * @param ttlSeconds Lifetime of a hold
+     * @param parent Parent object
+     */
+    explicit SeatHoldService(Database *db, int ttlSeconds = 10 * 60, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor, releases every hold still active
+     */
+    ~SeatHoldService();
+
+    /**
+     * @brief Hold seats of a flight
+     * @param flightId Flight ID
+     * @param userId User ID
+     * @param seatClass Seat class (Economy, Business, First)
+     * @param count Number of seats
+     * @return Hold, invalid if not enough seats are left
+     */
+    QFuture<SeatHold> hold(int flightId, int userId, const QString &seatClass, int count);
+
+    /**
+     * @brief Book passengers on held seats without re-reading availability
+     * @param holdId Hold ID
+     * @param passengers One passenger per held seat
+     * @return Booking IDs, empty if the hold expired or on error
+     */
+    QFuture<QVector<int>> confirm(qint64 holdId, const QVector<Passenger> &passengers);
+
+    /**
+     * @brief Give held seats back before the hold expires
+     * @param holdId Hold ID
+     */
+    void release(qint64 holdId);
+
+    /**
+     * @brief Get the last known free seats of a flight class
+     * @return Free seats, -1 if not known recently
+     */
+    int availableSeats(int flightId, const QString &seatClass) const;
+
+    /**
+     * @brief Get the number of holds placed by this client and still active
+     * @return Hold count
+     */
+    int activeHolds() const;
+
+signals:
+    /**
+     * @brief Signal emitted when a hold expired and its seats were given back
+     * @param holdId Hold ID
+     */
+    void holdExpired(qint64 holdId);
+
+private:
+    struct State;
+
+    /**
+     * @brief Advance the timer wheel by one slot and release expired holds
+     */
+    void tick();
+
+    Database *db;
+    int ttlSeconds;
+    QTimer *timer;
+    QSharedPointer<State> state;
+};
+
+#endif // SEATHOLDSERVICE_H
@@ -0,0 +1,120 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QDeadlineTimer>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <vector>
+#include "databaserows.h"
+
+class Database;
+
+/**
+ * @brief The SessionManager class issues session tokens after a successful login
+ *
+ * The password is checked and the profile is read once per login; later
+ * identity checks look the opaque token up in memory. Sessions are spread over
+ * shards, each with its own lock, so checks from several threads rarely wait
+ * on each other. A session expires after being unused for the idle timeout;
+ * expired sessions are dropped when they are looked up or when another session
+ * is added to their shard.
+ *
+ * The cached profile is the one read at login; the user ID and username never
+ * change, other fields can be refreshed with updateProfile().
+ */
+class SessionManager
+{
+public:
+    /**
+     * @brief Constructor
+     * @param db Database to authenticate against
+     * @param idleTimeoutSeconds Lifetime of an unused session
+     * @param shardCount Number of independently locked parts of the session map
+     */
+    explicit SessionManager(Database *db, int idleTimeoutSeconds = 8 * 60 * 60, int shardCount = 16);
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    /**
+     * @brief Authenticate a user and open a session
+     * @param username Username
+     * @param password Password
+     * @return Session token, empty if the credentials are wrong
+     */
+    QString login(const QString &username, const QString &password);
+
+    /**
+     * @brief Asynchronous variant of login()
+     */
+    QFuture<QString> loginAsync(const QString &username, const QString &password);
+
+    /**
+     * @brief Get the user of a session and keep the session alive
+     * @param token Session token
+     * @return Cached profile, invalid if the session is unknown or expired
+     */
+    UserProfileRow user(const QString &token);
+
+    /**
+     * @brief Get the user ID of a session and keep the session alive
+     * @param token Session token
+     * @return User ID, -1 if the session is unknown or expired
+     */
+    int userId(const QString &token);
+
+    /**
+     * @brief Replace the cached profile of every session of a user
+     * @param profile Profile as stored in the database
+     */
+    void updateProfile(const UserProfileRow &profile);
+
+    /**
+     * @brief Close a session
+     * @param token Session token
+     */
+    void logout(const QString &token);
+
+    /**
+     * @brief Get the number of open sessions, including expired ones not yet dropped
+     * @return Session count
+     */
+    int sessionCount() const;
+
+private:
+    /**
+     * @brief An open session
+     */
+    struct Session
+    {
+        UserProfileRow profile;
+        QDeadlineTimer expiry;
+    };
+
+    /**
+     * @brief Part of the session map with its own lock
+     */
+    struct Shard
+    {
+        mutable QMutex mutex;
+        QHash<QString, Session> sessions;
+    };
+
+    /**
+     * @brief Get the shard a token belongs to
+     */
+    Shard &shardFor(const QString &token);
+
+    /**
+     * @brief Generate an unguessable token
+     */
+    static QString newToken();
+
+    Database *db;
+    qint64 idleTimeoutMs;
+    std::vector<Shard> shards;
+};
+
+#endif // SESSIONMANAGER_H
@@ -0,0 +1,95 @@
+#ifndef STATEMENTREGISTRY_H
+#define STATEMENTREGISTRY_H
+
+#include <QHash>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief The StatementRegistry class keeps prepared statements of one connection
+ *
+ * Each hot statement is prepared once per connection and reused on later calls
+ * together with the column ordinals resolved from its result record. A registry
+ * belongs to a pooled connection and must only be used by the thread that
+ * currently leases that connection.
+ */
+class StatementRegistry
+{
+public:
+    /**
+     * @brief Prepare counters shared by all registries
+     */
+    struct Stats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+
+    /**
+     * @brief Constructor
+     * @param connectionName Name of the connection the statements belong to
+     */
+    explicit StatementRegistry(const QString &connectionName);
+
+    /**
+     * @brief Destructor
+     */
+    ~StatementRegistry();
+
+    StatementRegistry(const StatementRegistry &) = delete;
+    StatementRegistry &operator=(const StatementRegistry &) = delete;
+
+    /**
+     * @brief Get a prepared statement, preparing it on first use
+     * @param id Statement identifier
+     * @param sql Statement text, only used on the first call for the id
+     * @return Prepared query, nullptr if preparation failed
+     */
+    QSqlQuery *prepare(int id, const QString &sql);
+
+    /**
+     * @brief Get the ordinals of named result columns of an executed statement
+     *
+     * Ordinals are looked up in the query record once and cached with the
+     * statement; the order follows the names array.
+     * @param id Statement identifier
+     * @param names Column names
+     * @param count Number of column names
+     * @return Column ordinals, -1 for columns missing from the result
+     */
+    const QVector<int> &columns(int id, const char *const *names, int count);
+
+    /**
+     * @brief Drop all prepared statements
+     */
+    void clear();
+
+    /**
+     * @brief Get the process-wide prepare counters
+     * @return Hits and misses since start or last reset
+     */
+    static Stats stats();
+
+    /**
+     * @brief Reset the process-wide prepare counters
+     */
+    static void resetStats();
+
+private:
+    struct Entry
+    {
+        QSqlQuery query;
+        QVector<int> ordinals;
+        bool ordinalsResolved = false;
+    };
+
+    QString connectionName;
+    QHash<int, Entry*> entries;
+
+    static std::atomic<quint64> hitCount;
+    static std::atomic<quint64> missCount;
+};
+
+#endif // STATEMENTREGISTRY_H
@@ -14,6 +14,7 @@
 #include <QTableView>
 #include <QStandardItemModel>
 #include "database.h"
+#include "seatholdservice.h"
 
 /**
  * @brief The TicketBooking class provides ticket booking functionality
@@ -63,6 +64,27 @@ private slots:
      * @param index Selected index
      */
     void updatePrice(int index);
+    
+    /**
+     * @brief Add the entered passenger to the group
+     */
+    void addPassenger();
+    
+    /**
+     * @brief Remove the selected passenger from the group
+     */
+    void removePassenger();
+    
+    /**
+     * @brief Hold seats for the selected class and number of passengers
+     */
+    void placeHold();
+    
+    /**
+     * @brief Handle the expiry of a seat hold
+     * @param holdId Hold ID
+     */
+    void onHoldExpired(qint64 holdId);
 
 private:
     /**
@@ -79,7 +101,24 @@ private:
      * @brief Display user bookings
      * @param bookings List of bookings
      */
-    void displayUserBookings(const QList<QMap<QString, QVariant>> &bookings);
+    void displayUserBookings(const QVector<BookingRow> &bookings);
+    
+    /**
+     * @brief Collect the passengers of the group and the entered passenger
+     * @return Passengers to book
+     */
+    QVector<Passenger> collectPassengers() const;
+    
+    /**
+     * @brief Give back the seats held for the current flight
+     */
+    void releaseHold();
+    
+    /**
+     * @brief Translate the selected seat class for the database
+     * @return Seat class (Economy, Business, First)
+     */
+    QString selectedSeatClass() const;
     
     QLabel *flightNumberLabel;
     QLabel *airlineLabel;
@@ -88,18 +127,28 @@ private:
     QLabel *departureDateTimeLabel;
     QLabel *arrivalDateTimeLabel;
     QLabel *priceLabel;
+    QLabel *holdLabel;
     
     QLineEdit *passengerNameEdit;
     QLineEdit *passengerPassportEdit;
     QComboBox *seatClassComboBox;
+    QPushButton *addPassengerButton;
+    QPushButton *removePassengerButton;
     QPushButton *bookButton;
     
+    QTableView *passengersTableView;
+    QStandardItemModel *passengersModel;
+    
     QTableView *bookingsTableView;
     QStandardItemModel *bookingsModel;
     
     int currentFlightId;
     int currentUserId;
-    QMap<QString, QVariant> currentFlight;
+    FlightRow currentFlight;
+    
+    SeatHoldService *seatHolds;
+    SeatHold currentHold;
+    int holdRequest;
     
     Database *db;
 };
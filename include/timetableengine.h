@@ -0,0 +1,222 @@
+#ifndef TIMETABLEENGINE_H
+#define TIMETABLEENGINE_H
+
+#include <QDate>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include "databaserows.h"
+#include "referencedatacache.h"
+
+class QSqlDatabase;
+
+/**
+ * @brief Immutable in-memory copy of the flights table for direct flight search
+ *
+ * Flights are grouped by route and sorted by departure time within a route.
+ * Each attribute is a separate array indexed by flight slot, so the binary
+ * search only touches the departure times. Airports and airlines are stored as
+ * indexes into the reference data the snapshot was built with.
+ */
+class TimetableSnapshot
+{
+public:
+    /**
+     * @brief Load a snapshot of the flights table
+     * @param db Open connection
+     * @param reference Airports and airlines the flights refer to
+     * @param error Receives the error text on failure
+     * @return Snapshot, null on error
+     */
+    static QSharedPointer<const TimetableSnapshot> load(const QSqlDatabase &db,
+                                                        const QSharedPointer<const ReferenceData> &reference,
+                                                        QString *error);
+
+    /**
+     * @brief Search direct flights, with the same result as Database::searchFlights()
+     * @param departureCity Departure city or airport IATA code
+     * @param arrivalCity Arrival city or airport IATA code
+     * @param departureDate Departure date
+     * @param returnDate Optional return date for round trips
+     * @return Outbound flights followed by return flights, each ordered by departure time
+     */
+    QVector<FlightRow> searchFlights(const QString &departureCity, const QString &arrivalCity,
+                                     const QDate &departureDate, const QDate &returnDate = QDate()) const;
+
+    /**
+     * @brief Get the number of flights in the snapshot
+     * @return Flight count
+     */
+    int flightCount() const;
+
+    /**
+     * @brief Get the milliseconds since the snapshot was loaded
+     * @return Snapshot age
+     */
+    qint64 age() const;
+
+private:
+    friend class ConnectionScan;
+
+    TimetableSnapshot() = default;
+
+    /**
+     * @brief Append the flights of one leg departing on a date
+     */
+    void appendLeg(const QString &departureCity, const QString &arrivalCity, const QDate &date,
+                   bool isReturn, QVector<FlightRow> &results) const;
+
+    /**
+     * @brief Build the result row of a flight slot
+     */
+    FlightRow flightAt(int slot, int departureIndex, int arrivalIndex, bool isReturn) const;
+
+    /**
+     * @brief Get the price of a seat class on a flight slot
+     */
+    float price(int slot, int seatClass) const;
+
+    /**
+     * @brief Get the free seats of a seat class on a flight slot
+     */
+    int seats(int slot, int seatClass) const;
+
+    /**
+     * @brief Key of a route between two airport indexes
+     */
+    static quint64 routeKey(int departureIndex, int arrivalIndex);
+
+    /**
+     * @brief Wall-clock seconds of the start of a day
+     */
+    static qint64 dayStart(const QDate &date);
+
+    /**
+     * @brief Convert wall-clock seconds to a date and time
+     */
+    static QDateTime wallClock(qint64 seconds);
+
+    /**
+     * @brief Map a seat class name to the index used by price() and seats()
+     */
+    static int seatClassIndex(const QString &seatClass);
+
+    QSharedPointer<const ReferenceData> reference;
+    QHash<int, int> airportIndexes;
+    QHash<quint64, QPair<int, int>> routes;
+    QVector<qint64> departures;
+    QVector<qint32> durations;
+    QVector<quint16> departureAirports;
+    QVector<quint16> arrivalAirports;
+    QVector<qint32> departureOrder;
+    QVector<qint32> flightIds;
+    QVector<quint16> airlines;
+    QVector<float> pricesEconomy;
+    QVector<float> pricesBusiness;
+    QVector<float> pricesFirst;
+    QVector<qint32> seatsEconomy;
+    QVector<qint32> seatsBusiness;
+    QVector<qint32> seatsFirst;
+    QVector<QString> flightNumbers;
+    QElapsedTimer loadTimer;
+};
+
+/**
+ * @brief The TimetableEngine class keeps the current timetable snapshot and its freshness
+ *
+ * A snapshot older than the maximum age is stale and is not handed out by
+ * freshSnapshot(), so callers fall back to SQL until it is rebuilt. Seat
+ * counters in engine results may lag bookings by up to the maximum age.
+ */
+class TimetableEngine
+{
+public:
+    /**
+     * @brief Constructor
+     * @param maxAgeMs Age after which a snapshot is stale
+     */
+    explicit TimetableEngine(int maxAgeMs = 60 * 1000);
+
+    /**
+     * @brief Get the snapshot if it is fresh enough to answer searches
+     * @return Snapshot, null if missing or stale
+     */
+    QSharedPointer<const TimetableSnapshot> freshSnapshot() const;
+
+    /**
+     * @brief Get the current snapshot regardless of its age
+     * @return Snapshot, null if none was built
+     */
+    QSharedPointer<const TimetableSnapshot> snapshot() const;
+
+    /**
+     * @brief Load a new snapshot and swap it in
+     *
+     * Only the caller whose startRebuild() returned true may call this.
+     * @param db Open connection
+     * @param reference Airports and airlines the flights refer to
+     * @return True if successful, false otherwise
+     */
+    bool rebuild(const QSqlDatabase &db, const QSharedPointer<const ReferenceData> &reference);
+
+    /**
+     * @brief Claim a background rebuild, so only one is queued at a time
+     * @return True if the caller should queue a task that calls startRebuild(true)
+     */
+    bool beginRebuild();
+
+    /**
+     * @brief Claim the right to load a snapshot, so only one caller loads at a time
+     *
+     * A synchronous caller takes over a queued background rebuild; the queued
+     * task then finds nothing left to do.
+     * @param queued True for the task queued after beginRebuild()
+     * @return True if the caller should call rebuild() or cancelRebuild()
+     */
+    bool startRebuild(bool queued);
+
+    /**
+     * @brief Give up the claim of startRebuild() without loading
+     * @param error Reason the rebuild could not run
+     */
+    void cancelRebuild(const QString &error);
+
+    /**
+     * @brief Wait for the snapshot another caller is loading
+     * @return True if a snapshot is available afterwards
+     */
+    bool waitForRebuild();
+
+    /**
+     * @brief Drop the snapshot, searches use SQL until the next rebuild
+     */
+    void invalidate();
+
+    /**
+     * @brief Set the age after which a snapshot is stale
+     * @param maxAgeMs Maximum age in milliseconds
+     */
+    void setMaxAge(int maxAgeMs);
+
+    /**
+     * @brief Get the text of the last rebuild error
+     * @return Error text
+     */
+    QString lastError() const;
+
+private:
+    enum RebuildState { Idle, Queued, Loading };
+
+    mutable QMutex mutex;
+    QSharedPointer<const TimetableSnapshot> current;
+    QWaitCondition rebuilt;
+    int maxAgeMs;
+    RebuildState rebuildState;
+    QString errorText;
+};
+
+#endif // TIMETABLEENGINE_H
@@ -33,6 +33,13 @@ public:
      */
     ~UserProfile();
 
+signals:
+    /**
+     * @brief Signal emitted when the profile was read from the database
+     * @param profile User profile information
+     */
+    void profileLoaded(const UserProfileRow &profile);
+
 public slots:
     /**
      * @brief Set the user ID
@@ -66,13 +73,13 @@ private:
      * @brief Display user profile information
      * @param profile User profile information
      */
-    void displayUserProfile(const QMap<QString, QVariant> &profile);
+    void displayUserProfile(const UserProfileRow &profile);
     
     /**
      * @brief Display user bookings
      * @param bookings List of bookings
      */
-    void displayUserBookings(const QList<QMap<QString, QVariant>> &bookings);
+    void displayUserBookings(const QVector<BookingRow> &bookings);
     
     QLabel *usernameLabel;
     QLineEdit *emailEdit;
@@ -9,7 +9,6 @@
 #include <QGroupBox>
 #include <QTableView>
 #include <QHeaderView>
-#include <QStandardItemModel>
 
 /**
  * @brief Конструктор класса информации об аэропорте
@@ -80,6 +79,9 @@ void AirportInfo::setupUi()
     flightsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     flightsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     
+    flightsModel = new FlightListModel(this);
+    flightsTable->setModel(flightsModel);
+    
     flightsLayout->addWidget(flightsTable);
     
     // Добавление групп в основную компоновку
@@ -99,19 +101,17 @@ void AirportInfo::loadAirports()
     // Очистка выпадающего списка
     airportComboBox->clear();
     
-    // Загрузка аэропортов из базы данных
-    QList<QMap<QString, QVariant>> airports = db->getAllAirports();
-    
-    for (const QMap<QString, QVariant> &airport : airports) {
-        QString code = airport["code"].toString();
-        QString name = airport["name"].toString();
-        QString display = QString("%1 (%2)").arg(name).arg(code);
+    // Асинхронная загрузка аэропортов из базы данных
+    db->getAllAirportsAsync().then(this, [this](const QVector<AirportRow> &airports) {
+        for (const AirportRow &airport : airports) {
+            QString display = QString("%1 (%2)").arg(airport.name).arg(airport.code);
+            
+            airportComboBox->addItem(display, airport.code);
+        }
         
-        airportComboBox->addItem(display, code);
-    }
-    
-    // Сортировка аэропортов по алфавиту
-    airportComboBox->model()->sort(0);
+        // Сортировка аэропортов по алфавиту
+        airportComboBox->model()->sort(0);
+    });
 }
 
 /**
@@ -128,23 +128,27 @@ void AirportInfo::loadAirportInfo()
     
     QString airportCode = airportComboBox->currentData().toString();
     
-    // Загрузка информации об аэропорте
-    QMap<QString, QVariant> airportInfo = db->getAirportInfo(airportCode);
-    
-    if (airportInfo.isEmpty()) {
-        QMessageBox::warning(this, "Информация об аэропорте", "Не удалось загрузить информацию об аэропорте.");
-        return;
-    }
+    // Асинхронная загрузка информации об аэропорте
+    loadButton->setEnabled(false);
     
-    // Отображение информации об аэропорте
-    nameLabel->setText(airportInfo["name"].toString());
-    codeLabel->setText(airportInfo["code"].toString());
-    cityLabel->setText(airportInfo["city"].toString());
-    countryLabel->setText(airportInfo["country"].toString());
-    timeZoneLabel->setText(airportInfo["timezone"].toString());
-    
-    // Загрузка рейсов из этого аэропорта
-    loadFlights(airportCode);
+    db->getAirportInfoAsync(airportCode).then(this, [this, airportCode](const AirportRow &airportInfo) {
+        loadButton->setEnabled(true);
+        
+        if (!airportInfo.isValid()) {
+            QMessageBox::warning(this, "Информация об аэропорте", "Не удалось загрузить информацию об аэропорте.");
+            return;
+        }
+        
+        // Отображение информации об аэропорте
+        nameLabel->setText(airportInfo.name);
+        codeLabel->setText(airportInfo.code);
+        cityLabel->setText(airportInfo.city);
+        countryLabel->setText(airportInfo.country);
+        timeZoneLabel->setText(airportInfo.timezone);
+        
+        // Загрузка рейсов из этого аэропорта
+        loadFlights(airportCode);
+    });
 }
 
 /**
@@ -153,35 +157,11 @@ void AirportInfo::loadAirportInfo()
  */
 void AirportInfo::loadFlights(const QString &airportCode)
 {
-    // Создание модели для таблицы рейсов
-    QStandardItemModel *model = new QStandardItemModel(0, 5, this);
-    model->setHorizontalHeaderLabels(QStringList() << "Номер рейса" << "Пункт назначения" << "Время отправления" << "Время прибытия" << "Статус");
-    
-    // Загрузка рейсов из базы данных
-    QSqlQuery query;
-    query.prepare("SELECT f.flight_number, a.name, f.departure_time, f.arrival_time, f.status "
-                 "FROM flights f "
-                 "JOIN airports a ON f.arrival_airport_id = a.id "
-                 "WHERE f.departure_airport_id = (SELECT id FROM airports WHERE code = ?) "
-                 "ORDER BY f.departure_time");
-    query.addBindValue(airportCode);
-    
-    if (query.exec()) {
-        int row = 0;
-        while (query.next()) {
-            model->insertRow(row);
-            model->setData(model->index(row, 0), query.value(0).toString());
-            model->setData(model->index(row, 1), query.value(1).toString());
-            model->setData(model->index(row, 2), query.value(2).toString());
-            model->setData(model->index(row, 3), query.value(3).toString());
-            model->setData(model->index(row, 4), query.value(4).toString());
-            row++;
-        }
+    // Модель подгружает рейсы постранично при прокрутке таблицы
+    flightsModel->setAirport(airportCode);
+    if (flightsModel->canFetchMore(QModelIndex())) {
+        flightsModel->fetchMore(QModelIndex());
     }
-    
-    // Установка модели для табличного представления
-    flightsTable->setModel(model);
-    flightsTable->resizeColumnsToContents();
 }
 
 /**
@@ -6,7 +6,7 @@
  * @param parent Родительский виджет
  */
 AirportLoadingWidget::AirportLoadingWidget(QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent), loadingRequest(0)
 {
     // Получение экземпляра базы данных
     db = Database::getInstance();
@@ -44,6 +44,37 @@ void AirportLoadingWidget::setupUi()
     
     mainLayout->addWidget(airportNameLabel);
     
+    // Выбор дня и длины интервала группировки
+    QHBoxLayout *controlsLayout = new QHBoxLayout();
+    dateEdit = new QDateEdit(QDate::currentDate(), this);
+    dateEdit->setCalendarPopup(true);
+    dateEdit->setDisplayFormat("dd.MM.yyyy");
+    
+    bucketComboBox = new QComboBox(this);
+    bucketComboBox->addItem("30 минут", 30);
+    bucketComboBox->addItem("1 час", 60);
+    bucketComboBox->addItem("2 часа", 120);
+    bucketComboBox->addItem("3 часа", 180);
+    bucketComboBox->setCurrentIndex(2);
+    
+    periodComboBox = new QComboBox(this);
+    periodComboBox->addItem("Сутки", 1);
+    periodComboBox->addItem("Неделя", 7);
+    periodComboBox->addItem("Месяц", 30);
+    periodComboBox->addItem("Год", 365);
+    
+    controlsLayout->addWidget(new QLabel("Дата:", this));
+    controlsLayout->addWidget(dateEdit);
+    controlsLayout->addSpacing(20);
+    controlsLayout->addWidget(new QLabel("Период:", this));
+    controlsLayout->addWidget(periodComboBox);
+    controlsLayout->addSpacing(20);
+    controlsLayout->addWidget(new QLabel("Интервал:", this));
+    controlsLayout->addWidget(bucketComboBox);
+    controlsLayout->addStretch();
+    
+    mainLayout->addLayout(controlsLayout);
+    
     // Зона 2: Зона построения графиков
     chartFrame = new QFrame(this);
     chartFrame->setFrameShape(QFrame::StyledPanel);
@@ -57,7 +88,11 @@ void AirportLoadingWidget::setupUi()
     chartLabel->setAlignment(Qt::AlignCenter);
     chartLabel->setStyleSheet("font-size: 12pt; color: #555;");
     
+    // График рисуется напрямую через QPainter; колесо мыши масштабирует, перетаскивание сдвигает
+    chartWidget = new LoadingChartWidget(chartFrame);
+    
     chartLayout->addWidget(chartLabel);
+    chartLayout->addWidget(chartWidget, 1);
     
     mainLayout->addWidget(chartFrame);
     
@@ -73,6 +108,9 @@ void AirportLoadingWidget::setupUi()
     
     // Подключение сигналов
     connect(closeButton, &QPushButton::clicked, this, &AirportLoadingWidget::onCloseButtonClicked);
+    connect(dateEdit, &QDateEdit::dateChanged, this, &AirportLoadingWidget::loadAirportLoadingData);
+    connect(bucketComboBox, &QComboBox::currentIndexChanged, this, &AirportLoadingWidget::loadAirportLoadingData);
+    connect(periodComboBox, &QComboBox::currentIndexChanged, this, &AirportLoadingWidget::loadAirportLoadingData);
     
     // Установка компоновки
     setLayout(mainLayout);
@@ -90,11 +128,11 @@ void AirportLoadingWidget::setAirportCode(const QString &code)
     airportCode = code;
     
     // Получение информации об аэропорте
-    QMap<QString, QVariant> airportInfo = db->getAirportInfo(airportCode);
+    AirportRow airportInfo = db->getAirportInfo(airportCode);
     
-    if (!airportInfo.isEmpty()) {
+    if (airportInfo.isValid()) {
         // Обновление заголовка
-        QString airportName = airportInfo["name"].toString();
+        QString airportName = airportInfo.name;
         airportNameLabel->setText("Загруженность аэропорта: " + airportName + " (" + airportCode + ")");
         
         // Загрузка данных о загруженности
@@ -109,70 +147,56 @@ void AirportLoadingWidget::setAirportCode(const QString &code)
  */
 void AirportLoadingWidget::loadAirportLoadingData()
 {
-    // Здесь должен быть код для получения данных о загруженности аэропорта из базы данных
-    // Для примера создадим тестовые данные
-    QList<QMap<QString, QVariant>> loadingData;
-    
-    // Тестовые данные: количество рейсов по часам
-    QStringList hours = {"00:00", "02:00", "04:00", "06:00", "08:00", "10:00", "12:00", "14:00", "16:00", "18:00", "20:00", "22:00"};
-    
-    // Генерация случайных данных для примера
-    for (const QString &hour : hours) {
-        QMap<QString, QVariant> data;
-        data["time"] = hour;
-        data["departures"] = QVariant(rand() % 20 + 5); // 5-25 вылетов
-        data["arrivals"] = QVariant(rand() % 20 + 5);   // 5-25 прилетов
-        loadingData.append(data);
+    if (airportCode.isEmpty()) {
+        return;
     }
     
-    // Создание графика загруженности
-    createLoadingChart(loadingData);
+    // Вылеты и прилеты за выбранный период, сгруппированные на стороне базы данных
+    QDateTime from(dateEdit->date(), QTime(0, 0));
+    QDateTime to = from.addDays(periodComboBox->currentData().toInt());
+    int bucketMinutes = bucketComboBox->currentData().toInt();
+    
+    chartLabel->setText("Загрузка данных...");
+    int request = ++loadingRequest;
+    db->getAirportLoadingAsync(airportCode, from, to, bucketMinutes).then(this,
+        [this, request](const QVector<AirportLoadRow> &loadingData) {
+        // Ответ на устаревший запрос (другой аэропорт, дата или интервал) не нужен
+        if (request != loadingRequest) {
+            return;
+        }
+        createLoadingChart(loadingData);
+    });
 }
 
 /**
  * @brief Создание графика загруженности
  * @param loadingData Данные о загруженности
  */
-void AirportLoadingWidget::createLoadingChart(const QList<QMap<QString, QVariant>> &loadingData)
+void AirportLoadingWidget::createLoadingChart(const QVector<AirportLoadRow> &loadingData)
 {
-    // В реальном приложении здесь был бы код для создания графика
-    // Для примера просто обновим текст метки
+    chartWidget->setData(loadingData);
     
-    QString chartText = "<h3>Загруженность аэропорта " + airportCode + " по часам</h3>";
-    chartText += "<table border='1' cellspacing='0' cellpadding='5' style='margin: 0 auto;'>";
-    chartText += "<tr><th>Время</th><th>Вылеты</th><th>Прилеты</th><th>Всего</th></tr>";
+    if (loadingData.isEmpty()) {
+        chartLabel->setText("Не удалось загрузить данные о загруженности аэропорта.");
+        return;
+    }
     
+    // Итоги за период над графиком
     int totalDepartures = 0;
     int totalArrivals = 0;
-    
-    for (const QMap<QString, QVariant> &data : loadingData) {
-        int departures = data["departures"].toInt();
-        int arrivals = data["arrivals"].toInt();
-        int total = departures + arrivals;
-        
-        totalDepartures += departures;
-        totalArrivals += arrivals;
-        
-        chartText += "<tr>";
-        chartText += "<td>" + data["time"].toString() + "</td>";
-        chartText += "<td align='center'>" + QString::number(departures) + "</td>";
-        chartText += "<td align='center'>" + QString::number(arrivals) + "</td>";
-        chartText += "<td align='center'>" + QString::number(total) + "</td>";
-        chartText += "</tr>";
+    int busiest = 0;
+    for (int i = 0; i < loadingData.size(); i++) {
+        totalDepartures += loadingData[i].departures;
+        totalArrivals += loadingData[i].arrivals;
+        if (loadingData[i].movements() > loadingData[busiest].movements()) {
+            busiest = i;
+        }
     }
     
-    chartText += "<tr style='font-weight: bold;'>";
-    chartText += "<td>Итого</td>";
-    chartText += "<td align='center'>" + QString::number(totalDepartures) + "</td>";
-    chartText += "<td align='center'>" + QString::number(totalArrivals) + "</td>";
-    chartText += "<td align='center'>" + QString::number(totalDepartures + totalArrivals) + "</td>";
-    chartText += "</tr>";
-    
-    chartText += "</table>";
-    
-    chartText += "<p style='text-align: center; margin-top: 20px;'>В реальном приложении здесь был бы график загруженности аэропорта.</p>";
-    
-    chartLabel->setText(chartText);
+    chartLabel->setText(QString("Вылеты: %1, прилеты: %2, всего: %3. Пик: %4 рейсов, %5")
+                        .arg(totalDepartures).arg(totalArrivals).arg(totalDepartures + totalArrivals)
+                        .arg(loadingData[busiest].movements())
+                        .arg(loadingData[busiest].bucketStart.toString("dd.MM.yyyy hh:mm")));
 }
 
 /**
@@ -0,0 +1,111 @@
+#include "bookingwritequeue.h"
+#include "database.h"
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QPromise>
+#include <QThread>
+#include <iterator>
+
+/**
+ * @brief A queued request and the promise of its caller
+ */
+struct BookingWriteQueue::Pending
+{
+    BookingRequest request;
+    QPromise<QVector<int>> promise;
+};
+
+BookingWriteQueue::BookingWriteQueue(Database *db, int maxBatch, int maxDelayMs)
+    : db(db), maxBatch(qMax(1, maxBatch)), maxDelayMs(qMax(0, maxDelayMs))
+{
+    writer = QThread::create([this]() { run(); });
+    writer->start();
+}
+
+BookingWriteQueue::~BookingWriteQueue()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wakeUp.wakeAll();
+    }
+    writer->wait();
+    delete writer;
+}
+
+QFuture<QVector<int>> BookingWriteQueue::submit(const BookingRequest &request)
+{
+    Pending entry;
+    entry.request = request;
+    entry.promise.start();
+    QFuture<QVector<int>> future = entry.promise.future();
+
+    QMutexLocker locker(&mutex);
+    if (stopping) {
+        entry.promise.addResult(QVector<int>());
+        entry.promise.finish();
+        return future;
+    }
+
+    pending.push_back(std::move(entry));
+
+    // The writer sleeps until the first request, then until the batch is full or due
+    if (pending.size() == 1 || int(pending.size()) == maxBatch) {
+        wakeUp.wakeOne();
+    }
+    return future;
+}
+
+BookingWriteQueue::Stats BookingWriteQueue::stats() const
+{
+    QMutexLocker locker(&mutex);
+    return counters;
+}
+
+void BookingWriteQueue::run()
+{
+    QMutexLocker locker(&mutex);
+    for (;;) {
+        while (pending.empty() && !stopping) {
+            wakeUp.wait(&mutex);
+        }
+        if (pending.empty()) {
+            break;
+        }
+
+        // Give concurrent callers a moment to join the commit
+        QDeadlineTimer deadline(maxDelayMs);
+        while (!stopping && int(pending.size()) < maxBatch && !deadline.hasExpired()) {
+            wakeUp.wait(&mutex, deadline);
+        }
+
+        auto end = pending.begin() + qMin(int(pending.size()), maxBatch);
+        std::vector<Pending> batch(std::make_move_iterator(pending.begin()), std::make_move_iterator(end));
+        pending.erase(pending.begin(), end);
+        locker.unlock();
+
+        QVector<BookingRequest> requests;
+        requests.reserve(int(batch.size()));
+        for (const Pending &entry : batch) {
+            requests.append(entry.request);
+        }
+
+        QVector<QVector<int>> results = db->bookTicketsBatch(requests);
+
+        int failures = 0;
+        for (int i = 0; i < int(batch.size()); i++) {
+            QVector<int> bookingIds = results.value(i);
+            if (bookingIds.isEmpty()) {
+                failures++;
+            }
+            batch[i].promise.addResult(bookingIds);
+            batch[i].promise.finish();
+        }
+
+        locker.relock();
+        counters.requests += int(batch.size());
+        counters.batches++;
+        counters.failures += failures;
+        counters.largestBatch = qMax(counters.largestBatch, int(batch.size()));
+    }
+}
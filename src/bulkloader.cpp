@@ -0,0 +1,231 @@
+#include "bulkloader.h"
+#include <QDateTime>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include <libpq-fe.h>
+
+// Send COPY data in chunks of about this size
+static const int copyFlushBytes = 256 * 1024;
+
+// PostgreSQL limits a statement to 65535 bind parameters
+static const int maxBindParameters = 65535;
+
+BulkLoader::BulkLoader(const QSqlDatabase &db, int batchRows)
+    : db(db), connection(nullptr), batchRows(qMax(1, batchRows)), active(false),
+      pendingRows(0), loadedRows(0)
+{
+    // Use COPY only when the Qt driver exposes its libpq handle
+    QVariant handle = db.driver() ? db.driver()->handle() : QVariant();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "PGconn*") == 0) {
+        connection = *static_cast<PGconn *const *>(handle.data());
+    }
+}
+
+BulkLoader::~BulkLoader()
+{
+    if (active && connection) {
+        PQputCopyEnd(connection, "load aborted");
+        while (PGresult *result = PQgetResult(connection)) {
+            PQclear(result);
+        }
+    }
+}
+
+bool BulkLoader::begin(const QString &table, const QStringList &columns)
+{
+    if (active) {
+        errorText = "Bulk load already in progress";
+        return false;
+    }
+
+    tableName = table;
+    columnNames = columns;
+    copyBuffer.clear();
+    pendingValues.clear();
+    pendingRows = 0;
+    loadedRows = 0;
+    errorText.clear();
+
+    if (connection) {
+        QByteArray sql = QString("COPY %1 (%2) FROM STDIN").arg(table, columns.join(", ")).toUtf8();
+        PGresult *result = PQexec(connection, sql.constData());
+        bool started = PQresultStatus(result) == PGRES_COPY_IN;
+        if (!started) {
+            errorText = QString::fromUtf8(PQerrorMessage(connection));
+        }
+        PQclear(result);
+        if (!started) {
+            return false;
+        }
+    }
+
+    active = true;
+    return true;
+}
+
+bool BulkLoader::addRow(const QVariantList &values)
+{
+    if (!active) {
+        errorText = "Bulk load not started";
+        return false;
+    }
+    if (values.size() != columnNames.size()) {
+        errorText = QString("Expected %1 values, got %2").arg(columnNames.size()).arg(values.size());
+        return false;
+    }
+
+    if (connection) {
+        for (int i = 0; i < values.size(); ++i) {
+            if (i > 0) {
+                copyBuffer.append('\t');
+            }
+            appendCopyValue(values[i]);
+        }
+        copyBuffer.append('\n');
+        loadedRows++;
+
+        return copyBuffer.size() < copyFlushBytes || flushCopyBuffer();
+    }
+
+    pendingValues.append(values);
+    pendingRows++;
+
+    int rowLimit = qMin(batchRows, maxBindParameters / qMax(1, columnNames.size()));
+    return pendingRows < rowLimit || flushInsertBatch();
+}
+
+bool BulkLoader::finish()
+{
+    if (!active) {
+        return errorText.isEmpty();
+    }
+    active = false;
+
+    if (!connection) {
+        return flushInsertBatch();
+    }
+
+    bool ok = flushCopyBuffer();
+    if (PQputCopyEnd(connection, ok ? nullptr : "load aborted") != 1) {
+        errorText = QString::fromUtf8(PQerrorMessage(connection));
+        ok = false;
+    }
+
+    // Drain every result so the connection is usable by Qt again
+    while (PGresult *result = PQgetResult(connection)) {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK && ok) {
+            errorText = QString::fromUtf8(PQresultErrorMessage(result));
+            ok = false;
+        }
+        PQclear(result);
+    }
+
+    if (!ok) {
+        qDebug() << "Error copying rows into" << tableName << ":" << errorText;
+    }
+    return ok;
+}
+
+bool BulkLoader::usesCopy() const
+{
+    return connection != nullptr;
+}
+
+qint64 BulkLoader::rowCount() const
+{
+    return loadedRows;
+}
+
+QString BulkLoader::lastError() const
+{
+    return errorText;
+}
+
+void BulkLoader::appendCopyValue(const QVariant &value)
+{
+    if (value.isNull()) {
+        copyBuffer.append("\\N");
+        return;
+    }
+
+    QByteArray text;
+    switch (value.typeId()) {
+    case QMetaType::Bool:
+        text = value.toBool() ? "t" : "f";
+        break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        text = QByteArray::number(value.toDouble(), 'g', 17);
+        break;
+    case QMetaType::QDateTime:
+        text = value.toDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz").toUtf8();
+        break;
+    case QMetaType::QDate:
+        text = value.toDate().toString(Qt::ISODate).toUtf8();
+        break;
+    default:
+        text = value.toString().toUtf8();
+        break;
+    }
+
+    // Escape the characters that are special in COPY text format
+    for (char c : std::as_const(text)) {
+        switch (c) {
+        case '\\': copyBuffer.append("\\\\"); break;
+        case '\t': copyBuffer.append("\\t"); break;
+        case '\n': copyBuffer.append("\\n"); break;
+        case '\r': copyBuffer.append("\\r"); break;
+        default: copyBuffer.append(c); break;
+        }
+    }
+}
+
+bool BulkLoader::flushCopyBuffer()
+{
+    if (copyBuffer.isEmpty()) {
+        return true;
+    }
+
+    if (PQputCopyData(connection, copyBuffer.constData(), copyBuffer.size()) != 1) {
+        errorText = QString::fromUtf8(PQerrorMessage(connection));
+        return false;
+    }
+
+    copyBuffer.clear();
+    return true;
+}
+
+bool BulkLoader::flushInsertBatch()
+{
+    if (pendingRows == 0) {
+        return true;
+    }
+
+    QString placeholders = "(" + QStringList(columnNames.size(), "?").join(", ") + ")";
+    QStringList rows;
+    rows.reserve(pendingRows);
+    for (int i = 0; i < pendingRows; ++i) {
+        rows.append(placeholders);
+    }
+
+    QSqlQuery query(db);
+    query.prepare(QString("INSERT INTO %1 (%2) VALUES %3")
+                  .arg(tableName, columnNames.join(", "), rows.join(", ")));
+    for (int i = 0; i < pendingValues.size(); ++i) {
+        query.bindValue(i, pendingValues[i]);
+    }
+
+    bool ok = query.exec();
+    if (ok) {
+        loadedRows += pendingRows;
+    } else {
+        errorText = query.lastError().text();
+        qDebug() << "Error inserting rows into" << tableName << ":" << errorText;
+    }
+
+    pendingValues.clear();
+    pendingRows = 0;
+    return ok;
+}
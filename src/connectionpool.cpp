@@ -0,0 +1,358 @@
+#include "connectionpool.h"
+#include "statementregistry.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+/**
+ * @brief Book-keeping for one named connection
+ */
+struct ConnectionPool::PooledConnection
+{
+    QString name;
+    QThread *owner = nullptr;
+    int leases = 0;
+    bool open = false;
+    bool stale = false;
+    StatementRegistry *statements = nullptr;
+    QElapsedTimer idleSince;
+    QElapsedTimer lastHealthCheck;
+};
+
+ConnectionPool::Lease::Lease(ConnectionPool *pool, PooledConnection *connection)
+    : pool(pool), connection(connection)
+{
+}
+
+ConnectionPool::Lease::Lease(Lease &&other) noexcept
+    : pool(other.pool), connection(other.connection)
+{
+    other.pool = nullptr;
+    other.connection = nullptr;
+}
+
+ConnectionPool::Lease &ConnectionPool::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        connection = other.connection;
+        other.pool = nullptr;
+        other.connection = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    release();
+}
+
+bool ConnectionPool::Lease::isValid() const
+{
+    return connection != nullptr;
+}
+
+QSqlDatabase ConnectionPool::Lease::database() const
+{
+    if (!connection) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(connection->name, false);
+}
+
+StatementRegistry *ConnectionPool::Lease::statements() const
+{
+    return connection ? connection->statements : nullptr;
+}
+
+void ConnectionPool::Lease::release()
+{
+    if (pool && connection) {
+        pool->release(connection);
+    }
+    pool = nullptr;
+    connection = nullptr;
+}
+
+ConnectionPool::ConnectionPool(const Settings &settings, QObject *parent)
+    : QObject(parent), poolSettings(settings), nextConnectionId(0), leasedConnections(0), evictionTimer(nullptr)
+{
+    if (poolSettings.maxConnections < 1) {
+        poolSettings.maxConnections = 1;
+    }
+
+    // Periodically close connections nobody has leased for a while
+    if (poolSettings.idleTimeoutMs > 0) {
+        evictionTimer = new QTimer(this);
+        connect(evictionTimer, &QTimer::timeout, this, &ConnectionPool::evictIdle);
+        evictionTimer->start(qMax(1000, poolSettings.idleTimeoutMs / 2));
+    }
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    // The pool goes away at shutdown, after the threads that used it
+    QMutexLocker locker(&mutex);
+    for (PooledConnection *connection : std::as_const(connections)) {
+        discard(connection);
+    }
+    locker.unlock();
+    qDeleteAll(connections);
+}
+
+ConnectionPool::Lease ConnectionPool::acquire()
+{
+    QThread *thread = QThread::currentThread();
+    QDeadlineTimer deadline(poolSettings.acquireTimeoutMs);
+    PooledConnection *connection = nullptr;
+    bool watchThread = false;
+    bool outermostLease = false;
+
+    {
+        QMutexLocker locker(&mutex);
+
+        forever {
+            PooledConnection *own = nullptr;
+            for (PooledConnection *candidate : std::as_const(connections)) {
+                if (candidate->owner == thread) {
+                    own = candidate;
+                    break;
+                }
+            }
+
+            // Nested leases share the connection the thread already holds
+            if (own && own->leases > 0) {
+                connection = own;
+                break;
+            }
+
+            // Only leased connections count against the limit; idle ones stay with their thread
+            if (leasedConnections < poolSettings.maxConnections) {
+                if (own) {
+                    // Evicted while this thread was away; close it here, where it was opened
+                    if (own->stale) {
+                        discard(own);
+                    }
+                    connection = own;
+                    break;
+                }
+
+                // Reuse a connection closed by its finished thread, or open another one
+                for (PooledConnection *candidate : std::as_const(connections)) {
+                    if (!candidate->owner && candidate->leases == 0) {
+                        connection = candidate;
+                        break;
+                    }
+                }
+                if (!connection) {
+                    connection = new PooledConnection;
+                    connection->name = QString("AirportInspector_%1").arg(nextConnectionId++);
+                    connections.append(connection);
+                }
+                break;
+            }
+
+            if (!connectionAvailable.wait(&mutex, deadline)) {
+                errorText = "Connection pool exhausted";
+                qDebug() << "Error acquiring database connection:" << errorText;
+                return Lease();
+            }
+        }
+
+        if (connection->owner != thread) {
+            connection->owner = thread;
+            if (thread != this->thread() && !watchedThreads.contains(thread)) {
+                watchedThreads.insert(thread);
+                watchThread = true;
+            }
+        }
+        outermostLease = connection->leases == 0;
+        if (connection->leases++ == 0) {
+            leasedConnections++;
+        }
+    }
+
+    // Close the connection from its own thread once that thread is gone
+    if (watchThread) {
+        connect(thread, &QThread::finished, this, [this, thread]() {
+            threadFinished(thread);
+        }, Qt::DirectConnection);
+    }
+
+    // Only the owning thread touches a leased connection, so open it unlocked.
+    // Nested leases skip the health check: the outer caller may hold statements.
+    if (!ensureOpen(connection, outermostLease)) {
+        release(connection);
+        return Lease();
+    }
+
+    return Lease(this, connection);
+}
+
+void ConnectionPool::release(PooledConnection *connection)
+{
+    QMutexLocker locker(&mutex);
+
+    if (connection->leases > 0 && --connection->leases == 0) {
+        leasedConnections--;
+        connection->idleSince.start();
+        connectionAvailable.wakeOne();
+    }
+}
+
+bool ConnectionPool::ensureOpen(PooledConnection *connection, bool checkHealth)
+{
+    if (checkHealth && connection->open && poolSettings.healthCheckIntervalMs >= 0
+        && connection->lastHealthCheck.hasExpired(poolSettings.healthCheckIntervalMs)) {
+        bool healthy = false;
+        {
+            QSqlDatabase db = QSqlDatabase::database(connection->name, false);
+            QSqlQuery ping(db);
+            healthy = db.isOpen() && ping.exec("SELECT 1");
+            if (!healthy) {
+                qDebug() << "Database connection" << connection->name << "failed health check:" << ping.lastError().text();
+            }
+        }
+
+        if (healthy) {
+            connection->lastHealthCheck.restart();
+        } else {
+            QMutexLocker locker(&mutex);
+            discard(connection);
+            connection->owner = QThread::currentThread();
+        }
+    }
+
+    if (connection->open) {
+        return true;
+    }
+
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(poolSettings.driver, connection->name);
+        db.setHostName(poolSettings.hostName);
+        db.setDatabaseName(poolSettings.databaseName);
+        db.setUserName(poolSettings.userName);
+        db.setPassword(poolSettings.password);
+        db.setPort(poolSettings.port);
+
+        if (!db.open()) {
+            error = db.lastError().text();
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    if (!error.isEmpty()) {
+        errorText = error;
+        QSqlDatabase::removeDatabase(connection->name);
+        return false;
+    }
+
+    connection->open = true;
+    connection->statements = new StatementRegistry(connection->name);
+    connection->lastHealthCheck.start();
+    return true;
+}
+
+void ConnectionPool::discard(PooledConnection *connection)
+{
+    // Prepared statements hold references to the connection and go first
+    delete connection->statements;
+    connection->statements = nullptr;
+
+    if (connection->open) {
+        QSqlDatabase::removeDatabase(connection->name);
+        connection->open = false;
+    }
+    connection->owner = nullptr;
+    connection->stale = false;
+}
+
+bool ConnectionPool::retire(PooledConnection *connection)
+{
+    // Only the owning thread may close a connection; others just flag it
+    if (connection->owner && connection->owner != QThread::currentThread()) {
+        connection->stale = true;
+        return false;
+    }
+    discard(connection);
+    return true;
+}
+
+int ConnectionPool::evictIdle()
+{
+    QMutexLocker locker(&mutex);
+
+    int evicted = 0;
+    for (PooledConnection *connection : std::as_const(connections)) {
+        if (connection->open && !connection->stale && connection->leases == 0
+            && connection->idleSince.isValid()
+            && connection->idleSince.hasExpired(poolSettings.idleTimeoutMs)) {
+            retire(connection);
+            evicted++;
+        }
+    }
+
+    if (evicted > 0) {
+        connectionAvailable.wakeAll();
+    }
+    return evicted;
+}
+
+void ConnectionPool::closeAll()
+{
+    QMutexLocker locker(&mutex);
+
+    for (PooledConnection *connection : std::as_const(connections)) {
+        if (connection->leases == 0) {
+            retire(connection);
+        }
+    }
+    connectionAvailable.wakeAll();
+}
+
+void ConnectionPool::threadFinished(QThread *thread)
+{
+    QMutexLocker locker(&mutex);
+
+    watchedThreads.remove(thread);
+    for (PooledConnection *connection : std::as_const(connections)) {
+        if (connection->owner == thread) {
+            if (connection->leases > 0) {
+                leasedConnections--;
+                connection->leases = 0;
+            }
+            discard(connection);
+        }
+    }
+    connectionAvailable.wakeAll();
+}
+
+const ConnectionPool::Settings &ConnectionPool::settings() const
+{
+    return poolSettings;
+}
+
+int ConnectionPool::size() const
+{
+    QMutexLocker locker(&mutex);
+    return connections.size();
+}
+
+int ConnectionPool::leasedCount() const
+{
+    QMutexLocker locker(&mutex);
+    return leasedConnections;
+}
+
+QString ConnectionPool::lastError() const
+{
+    QMutexLocker locker(&mutex);
+    return errorText;
+}
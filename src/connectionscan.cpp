@@ -0,0 +1,170 @@
+#include "connectionscan.h"
+#include "timetableengine.h"
+#include <algorithm>
+
+/**
+ * @brief A partial journey ending at an airport
+ */
+struct JourneyLabel
+{
+    qint64 arrival;
+    qint64 start;
+    float price;
+    int legs;
+    int slot;
+    int previous;
+
+    // A later start leaves more of the travel time budget, so it counts as a criterion
+    bool dominates(const JourneyLabel &other) const
+    {
+        return arrival <= other.arrival && start >= other.start && price <= other.price && legs <= other.legs;
+    }
+};
+
+/**
+ * @brief Add a label to a Pareto set unless an existing label is at least as good
+ * @return True if the label was added
+ */
+static bool insertPareto(QVector<int> &bag, const QVector<JourneyLabel> &labels, int candidate)
+{
+    const JourneyLabel &label = labels[candidate];
+    for (int existing : std::as_const(bag)) {
+        if (labels[existing].dominates(label)) {
+            return false;
+        }
+    }
+
+    bag.erase(std::remove_if(bag.begin(), bag.end(), [&](int existing) {
+        return label.dominates(labels[existing]);
+    }), bag.end());
+    bag.append(candidate);
+    return true;
+}
+
+ConnectionScan::ConnectionScan(const QSharedPointer<const TimetableSnapshot> &snapshot)
+    : snapshot(snapshot)
+{
+}
+
+QVector<ItineraryRow> ConnectionScan::search(const QString &departureCity, const QString &arrivalCity,
+                                             const QDate &departureDate, const ItineraryOptions &options) const
+{
+    QVector<ItineraryRow> results;
+    if (!snapshot) {
+        return results;
+    }
+
+    const TimetableSnapshot &timetable = *snapshot;
+    int airportCount = timetable.reference->airports().size();
+
+    QVector<bool> isOrigin(airportCount, false);
+    QVector<bool> isTarget(airportCount, false);
+    for (int id : timetable.reference->resolveAirportIds(departureCity)) {
+        int index = timetable.airportIndexes.value(id, -1);
+        if (index >= 0) {
+            isOrigin[index] = true;
+        }
+    }
+    for (int id : timetable.reference->resolveAirportIds(arrivalCity)) {
+        int index = timetable.airportIndexes.value(id, -1);
+        if (index >= 0 && !isOrigin[index]) {
+            isTarget[index] = true;
+        }
+    }
+    if (!isOrigin.contains(true) || !isTarget.contains(true)) {
+        return results;
+    }
+
+    int seatClass = TimetableSnapshot::seatClassIndex(options.seatClass);
+    int maxLegs = qMax(1, options.maxLegs);
+    qint64 minConnection = qint64(qMax(0, options.minConnectionMinutes)) * 60;
+    qint64 maxTravel = qint64(qMax(1, options.maxTravelHours)) * 3600;
+    qint64 firstDeparture = TimetableSnapshot::dayStart(departureDate);
+    qint64 lastFirstDeparture = firstDeparture + 24 * 3600;
+    qint64 scanEnd = lastFirstDeparture + maxTravel;
+
+    QVector<JourneyLabel> labels;
+    QVector<QVector<int>> bags(airportCount);
+    QVector<int> arrived;
+
+    // Flights in network-wide departure order, starting at the requested day
+    const QVector<qint32> &order = timetable.departureOrder;
+    auto first = std::lower_bound(order.constBegin(), order.constEnd(), firstDeparture,
+                                  [&timetable](qint32 slot, qint64 time) {
+        return timetable.departures[slot] < time;
+    });
+
+    QVector<JourneyLabel> candidates;
+    for (auto it = first; it != order.constEnd(); ++it) {
+        int slot = *it;
+        qint64 departure = timetable.departures[slot];
+        if (departure >= scanEnd) {
+            break;
+        }
+
+        int from = timetable.departureAirports[slot];
+        int to = timetable.arrivalAirports[slot];
+        if (isOrigin[to] || isTarget[from] || timetable.seats(slot, seatClass) <= 0) {
+            continue;
+        }
+
+        qint64 arrival = departure + timetable.durations[slot];
+        float price = timetable.price(slot, seatClass);
+        candidates.clear();
+
+        if (isOrigin[from]) {
+            if (departure < lastFirstDeparture) {
+                candidates.append({arrival, departure, price, 1, slot, -1});
+            }
+        } else {
+            // Extend every journey at the departure airport that makes the connection
+            for (int index : std::as_const(bags[from])) {
+                const JourneyLabel &journey = labels[index];
+                if (journey.legs < maxLegs && journey.arrival + minConnection <= departure
+                    && arrival - journey.start <= maxTravel) {
+                    candidates.append({arrival, journey.start, journey.price + price, journey.legs + 1, slot, index});
+                }
+            }
+        }
+
+        for (const JourneyLabel &candidate : std::as_const(candidates)) {
+            // A journey no better than one already at the destination cannot improve on it
+            bool useless = std::any_of(arrived.constBegin(), arrived.constEnd(), [&](int index) {
+                return labels[index].dominates(candidate);
+            });
+            if (useless) {
+                continue;
+            }
+
+            labels.append(candidate);
+            int index = labels.size() - 1;
+            if (insertPareto(bags[to], labels, index) && isTarget[to]) {
+                insertPareto(arrived, labels, index);
+            }
+        }
+    }
+
+    // Walk the predecessor chains back to the first leg
+    for (int index : std::as_const(arrived)) {
+        ItineraryRow itinerary;
+        itinerary.totalPrice = labels[index].price;
+        for (int step = index; step >= 0; step = labels[step].previous) {
+            int slot = labels[step].slot;
+            itinerary.legs.prepend(timetable.flightAt(slot, timetable.departureAirports[slot],
+                                                      timetable.arrivalAirports[slot], false));
+        }
+        results.append(itinerary);
+    }
+
+    std::sort(results.begin(), results.end(), [](const ItineraryRow &a, const ItineraryRow &b) {
+        if (a.arrivalTime() != b.arrivalTime()) {
+            return a.arrivalTime() < b.arrivalTime();
+        }
+        if (a.totalPrice != b.totalPrice) {
+            return a.totalPrice < b.totalPrice;
+        }
+        return a.legs.size() < b.legs.size();
+    });
+
+    return results;
+}
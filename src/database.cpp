@@ -1,19 +1,403 @@
 #include "database.h"
-#include <QCryptographicHash>
+#include "statementregistry.h"
+#include "schemamigrator.h"
+#include "bulkloader.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QSqlRecord>
 #include <QVariant>
 #include <QDateTime>
 #include <QDebug>
 #include <QDate>
 #include <QRandomGenerator>
+#include <QThread>
 #include <QFile>
 #include <QDir>
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
 
 // Initialize static instance
 Database* Database::instance = nullptr;
 
+/**
+ * @brief Identifiers of the hot statements kept in the per-connection registry
+ */
+enum StatementId {
+    SearchFlightsStatement,
+    SearchRoundTripStatement,
+    SearchRoundTripPairsStatement,
+    GetFareCalendarStatement,
+    FlushFareSummaryStatement,
+    GetFlightStatement,
+    GetDeparturesPageStatement,
+    GetAirportLoadingStatement,
+    GetNetworkLoadingStatement,
+    GetAirportHourlyLoadStatement,
+    GetNetworkHourlyLoadStatement,
+    GetAllAirlinesStatement,
+    GetAllAirportsStatement,
+    TakeEconomySeatsStatement,
+    TakeBusinessSeatsStatement,
+    TakeFirstSeatsStatement,
+    GetUserBookingsStatement,
+    FindUsernameStatement,
+    InsertUserStatement,
+    GetCredentialsStatement,
+    GetUserProfileStatement,
+    UpdateUserProfileStatement,
+    UpdatePasswordStatement,
+    InsertSeatHoldStatement,
+    ConsumeSeatHoldStatement,
+    ReleaseSeatHoldStatement,
+    ReleaseExpiredSeatHoldsStatement,
+    // Followed by one statement per group size up to MaxPassengersPerBooking
+    InsertBookingsStatement
+};
+
+static const char* const flightColumnsSql =
+    "SELECT f.id, f.flight_number, a.name as airline_name, "
+    "dep.code as departure_code, dep.city as departure_city, "
+    "arr.code as arrival_code, arr.city as arrival_city, "
+    "f.departure_time, f.arrival_time, "
+    "f.price_economy, f.price_business, f.price_first, "
+    "f.available_seats_economy, f.available_seats_business, f.available_seats_first, ";
+
+static const char* const flightJoinsSql =
+    "JOIN airlines a ON f.airline_id = a.id "
+    "JOIN airports dep ON f.departure_airport_id = dep.id "
+    "JOIN airports arr ON f.arrival_airport_id = arr.id ";
+
+static const QString flightSelectSql = QString(flightColumnsSql) +
+    "FALSE AS is_return FROM flights f " + flightJoinsSql;
+
+// Airports are matched by city or code; the half-open departure range keeps
+// idx_flights_route_departure usable instead of wrapping the column in date()
+static const char* const flightLegSql =
+    "f.departure_airport_id IN (SELECT id FROM airports WHERE city = ? OR code = ?) "
+    "AND f.arrival_airport_id IN (SELECT id FROM airports WHERE city = ? OR code = ?) "
+    "AND f.departure_time >= ? AND f.departure_time < ? ";
+
+static const QString searchFlightsSql = flightSelectSql + "WHERE " + flightLegSql +
+    "ORDER BY f.departure_time";
+
+// Both legs of a round trip in one statement, told apart by is_return
+static const QString roundTripLegsSql = QString("(SELECT f.*, FALSE AS is_return FROM flights f WHERE ") + flightLegSql +
+    "UNION ALL SELECT f.*, TRUE FROM flights f WHERE " + flightLegSql + ") ";
+
+static const QString searchRoundTripSql = QString(flightColumnsSql) + "f.is_return FROM " +
+    roundTripLegsSql + "f " + flightJoinsSql +
+    "ORDER BY f.is_return, f.departure_time";
+
+// Ranks outbound/return combinations by total price of the seat class on the
+// server and returns the two legs of each pair as consecutive rows
+static const QString searchRoundTripPairsSql =
+    "WITH params AS (SELECT CAST(? AS TEXT) AS seat_class), "
+    "legs AS (SELECT l.*, "
+    "CASE p.seat_class WHEN 'Business' THEN l.price_business WHEN 'First' THEN l.price_first ELSE l.price_economy END AS class_price, "
+    "CASE p.seat_class WHEN 'Business' THEN l.available_seats_business WHEN 'First' THEN l.available_seats_first "
+    "ELSE l.available_seats_economy END AS class_seats "
+    "FROM " + roundTripLegsSql + "l CROSS JOIN params p), "
+    "pairs AS (SELECT o.id AS outbound_id, r.id AS return_id, o.class_price + r.class_price AS total_price, "
+    "ROW_NUMBER() OVER (ORDER BY o.class_price + r.class_price, o.departure_time, r.departure_time) AS pair_rank "
+    "FROM legs o JOIN legs r ON r.is_return AND r.departure_time >= o.arrival_time "
+    "WHERE NOT o.is_return AND o.class_seats > 0 AND r.class_seats > 0 "
+    "ORDER BY pair_rank LIMIT ?) " +
+    QString(flightColumnsSql) + "f.is_return, p.pair_rank, p.total_price "
+    "FROM pairs p JOIN legs f ON (f.id = p.outbound_id AND NOT f.is_return) OR (f.id = p.return_id AND f.is_return) " +
+    flightJoinsSql +
+    "ORDER BY p.pair_rank, f.is_return";
+
+// Several airports of a city fold into one calendar day
+static const char* const getFareCalendarSql =
+    "SELECT r.flight_date, SUM(r.flight_count) AS flight_count, "
+    "MIN(r.min_price_economy) AS min_price_economy, "
+    "MIN(r.min_price_business) AS min_price_business, "
+    "MIN(r.min_price_first) AS min_price_first, "
+    "SUM(r.seats_economy) AS seats_economy, "
+    "SUM(r.seats_business) AS seats_business, "
+    "SUM(r.seats_first) AS seats_first "
+    "FROM route_day_fares r "
+    "WHERE r.departure_airport_id IN (SELECT id FROM airports WHERE city = ? OR code = ?) "
+    "AND r.arrival_airport_id IN (SELECT id FROM airports WHERE city = ? OR code = ?) "
+    "AND r.flight_date BETWEEN CAST(? AS DATE) AND CAST(? AS DATE) "
+    "GROUP BY r.flight_date HAVING SUM(r.flight_count) > 0 "
+    "ORDER BY r.flight_date";
+
+static const QString getFlightSql = QString(flightSelectSql) + "WHERE f.id = ?";
+
+// Keyset pagination over idx_flights_departure_airport, no OFFSET scans
+static const QString getDeparturesPageSql = flightSelectSql +
+    "WHERE f.departure_airport_id = (SELECT id FROM airports WHERE code = ?) "
+    "AND (f.departure_time, f.id) > (CAST(? AS TIMESTAMP), ?) "
+    "ORDER BY f.departure_time, f.id LIMIT ?";
+
+static const char* const loadingBoundsSql =
+    "WITH bounds AS (SELECT CAST(? AS TIMESTAMP) AS range_start, CAST(? AS TIMESTAMP) AS range_end, "
+    "CAST(? AS INTEGER) AS bucket_seconds) "
+    "SELECT a.code, "
+    "CAST(floor(EXTRACT(EPOCH FROM m.moment - b.range_start) / b.bucket_seconds) AS INTEGER) AS bucket, "
+    "SUM(m.departures) AS departures, SUM(m.arrivals) AS arrivals, SUM(m.seats) AS seats_sold "
+    "FROM bounds b CROSS JOIN airports a CROSS JOIN LATERAL (";
+
+// Movements per airport come from range scans of idx_flights_departure_airport and
+// idx_flights_arrival_airport, one pair per airport, and are counted per time bucket
+static const QString rawLoadingSql = QString(loadingBoundsSql) +
+    "SELECT f.departure_time AS moment, 1 AS departures, 0 AS arrivals, "
+    "(SELECT COUNT(*) FROM bookings k WHERE k.flight_id = f.id) AS seats FROM flights f "
+    "WHERE f.departure_airport_id = a.id "
+    "AND f.departure_time >= b.range_start AND f.departure_time < b.range_end "
+    "UNION ALL "
+    "SELECT f.arrival_time, 0, 1, (SELECT COUNT(*) FROM bookings k WHERE k.flight_id = f.id) FROM flights f "
+    "WHERE f.arrival_airport_id = a.id "
+    "AND f.arrival_time >= b.range_start AND f.arrival_time < b.range_end) m ";
+
+// Buckets of whole hours add up the airport_hourly_load rows kept by triggers
+static const QString hourlyLoadingSql = QString(loadingBoundsSql) +
+    "SELECT l.hour_bucket AS moment, l.departures, l.arrivals, l.seats_sold AS seats "
+    "FROM airport_hourly_load l WHERE l.airport_id = a.id "
+    "AND l.hour_bucket >= b.range_start AND l.hour_bucket < b.range_end) m ";
+
+static const QString getAirportLoadingSql = rawLoadingSql +
+    "WHERE a.code = ? GROUP BY a.code, bucket ORDER BY bucket";
+static const QString getNetworkLoadingSql = rawLoadingSql +
+    "GROUP BY a.code, bucket ORDER BY a.code, bucket";
+static const QString getAirportHourlyLoadSql = hourlyLoadingSql +
+    "WHERE a.code = ? GROUP BY a.code, bucket ORDER BY bucket";
+static const QString getNetworkHourlyLoadSql = hourlyLoadingSql +
+    "GROUP BY a.code, bucket ORDER BY a.code, bucket";
+
+// Upper bound on the buckets of one loading query, so a tiny bucket cannot explode the result
+static const int maxLoadingBuckets = 50000;
+
+/**
+ * @brief Result columns decoded into FlightRow, in ordinal cache order
+ */
+enum FlightColumn {
+    FlightIdColumn,
+    FlightNumberColumn,
+    FlightAirlineNameColumn,
+    FlightDepartureCodeColumn,
+    FlightDepartureCityColumn,
+    FlightArrivalCodeColumn,
+    FlightArrivalCityColumn,
+    FlightDepartureTimeColumn,
+    FlightArrivalTimeColumn,
+    FlightPriceEconomyColumn,
+    FlightPriceBusinessColumn,
+    FlightPriceFirstColumn,
+    FlightSeatsEconomyColumn,
+    FlightSeatsBusinessColumn,
+    FlightSeatsFirstColumn,
+    FlightIsReturnColumn,
+    FlightColumnCount
+};
+
+static const char* const flightColumnNames[FlightColumnCount] = {
+    "id", "flight_number", "airline_name",
+    "departure_code", "departure_city", "arrival_code", "arrival_city",
+    "departure_time", "arrival_time",
+    "price_economy", "price_business", "price_first",
+    "available_seats_economy", "available_seats_business", "available_seats_first",
+    "is_return"
+};
+
+/**
+ * @brief Result columns decoded into AirportRow, in ordinal cache order
+ */
+enum AirportColumn {
+    AirportIdColumn,
+    AirportCodeColumn,
+    AirportNameColumn,
+    AirportCityColumn,
+    AirportCountryColumn,
+    AirportLatitudeColumn,
+    AirportLongitudeColumn,
+    AirportTimezoneColumn,
+    AirportDescriptionColumn,
+    AirportColumnCount
+};
+
+static const char* const airportColumnNames[AirportColumnCount] = {
+    "id", "code", "name", "city", "country", "latitude", "longitude", "timezone", "description"
+};
+
+/**
+ * @brief Result columns decoded into AirlineRow, in ordinal cache order
+ */
+enum AirlineColumn {
+    AirlineIdColumn,
+    AirlineCodeColumn,
+    AirlineNameColumn,
+    AirlineCountryColumn,
+    AirlineLogoColumn,
+    AirlineColumnCount
+};
+
+static const char* const airlineColumnNames[AirlineColumnCount] = {
+    "id", "code", "name", "country", "logo"
+};
+
+/**
+ * @brief Result columns decoded into BookingRow, in ordinal cache order
+ */
+enum BookingColumn {
+    BookingIdColumn,
+    BookingDateColumn,
+    BookingSeatClassColumn,
+    BookingPassengerNameColumn,
+    BookingPassengerPassportColumn,
+    BookingStatusColumn,
+    BookingFlightNumberColumn,
+    BookingAirlineNameColumn,
+    BookingDepartureCodeColumn,
+    BookingDepartureCityColumn,
+    BookingArrivalCodeColumn,
+    BookingArrivalCityColumn,
+    BookingDepartureTimeColumn,
+    BookingArrivalTimeColumn,
+    BookingColumnCount
+};
+
+static const char* const bookingColumnNames[BookingColumnCount] = {
+    "id", "booking_date", "seat_class", "passenger_name", "passenger_passport", "status",
+    "flight_number", "airline_name", "departure_code", "departure_city",
+    "arrival_code", "arrival_city", "departure_time", "arrival_time"
+};
+
+// Attempts of a booking transaction that failed on a serialization failure or deadlock
+static const int maxBookingAttempts = 4;
+
+/**
+ * @brief Check whether a failed transaction may succeed when retried
+ */
+static bool isTransientError(const QSqlError& error)
+{
+    // serialization_failure, deadlock_detected
+    return error.nativeErrorCode() == "40001" || error.nativeErrorCode() == "40P01";
+}
+
+/**
+ * @brief Get a hot statement of the leased connection, preparing it on first use
+ */
+static QSqlQuery* preparedStatement(const ConnectionPool::Lease& lease, StatementId id, const QString& sql)
+{
+    StatementRegistry *statements = lease.statements();
+    if (!statements) {
+        return nullptr;
+    }
+    return statements->prepare(id, sql);
+}
+
+/**
+ * @brief Get the cached result column ordinals of an executed hot statement
+ */
+static const QVector<int>& statementColumns(const ConnectionPool::Lease& lease, StatementId id,
+                                            const char* const* names, int count)
+{
+    return lease.statements()->columns(id, names, count);
+}
+
+// Parameters bound per leg by bindFlightLeg()
+static const int FlightLegBindCount = 6;
+
+/**
+ * @brief Bind the airports and departure day of one flight leg
+ */
+static void bindFlightLeg(QSqlQuery& query, int first, const QString& departureCity,
+                          const QString& arrivalCity, const QDate& date)
+{
+    query.bindValue(first, departureCity);
+    query.bindValue(first + 1, departureCity);
+    query.bindValue(first + 2, arrivalCity);
+    query.bindValue(first + 3, arrivalCity);
+    query.bindValue(first + 4, date.toString(Qt::ISODate));
+    query.bindValue(first + 5, date.addDays(1).toString(Qt::ISODate));
+}
+
+/**
+ * @brief Decode the current row of a flight query
+ */
+static FlightRow readFlightRow(const QSqlQuery& query, const QVector<int>& columns)
+{
+    FlightRow flight;
+    flight.id = query.value(columns[FlightIdColumn]).toInt();
+    flight.flightNumber = query.value(columns[FlightNumberColumn]).toString();
+    flight.airlineName = query.value(columns[FlightAirlineNameColumn]).toString();
+    flight.departureCode = query.value(columns[FlightDepartureCodeColumn]).toString();
+    flight.departureCity = query.value(columns[FlightDepartureCityColumn]).toString();
+    flight.arrivalCode = query.value(columns[FlightArrivalCodeColumn]).toString();
+    flight.arrivalCity = query.value(columns[FlightArrivalCityColumn]).toString();
+    flight.departureTime = query.value(columns[FlightDepartureTimeColumn]).toDateTime();
+    flight.arrivalTime = query.value(columns[FlightArrivalTimeColumn]).toDateTime();
+    flight.priceEconomy = query.value(columns[FlightPriceEconomyColumn]).toDouble();
+    flight.priceBusiness = query.value(columns[FlightPriceBusinessColumn]).toDouble();
+    flight.priceFirst = query.value(columns[FlightPriceFirstColumn]).toDouble();
+    flight.availableSeatsEconomy = query.value(columns[FlightSeatsEconomyColumn]).toInt();
+    flight.availableSeatsBusiness = query.value(columns[FlightSeatsBusinessColumn]).toInt();
+    flight.availableSeatsFirst = query.value(columns[FlightSeatsFirstColumn]).toInt();
+    flight.isReturn = query.value(columns[FlightIsReturnColumn]).toBool();
+    return flight;
+}
+
+/**
+ * @brief Decode the current row of an airports query
+ */
+static AirportRow readAirportRow(const QSqlQuery& query, const QVector<int>& columns)
+{
+    AirportRow airport;
+    airport.id = query.value(columns[AirportIdColumn]).toInt();
+    airport.code = query.value(columns[AirportCodeColumn]).toString();
+    airport.name = query.value(columns[AirportNameColumn]).toString();
+    airport.city = query.value(columns[AirportCityColumn]).toString();
+    airport.country = query.value(columns[AirportCountryColumn]).toString();
+    airport.latitude = query.value(columns[AirportLatitudeColumn]).toDouble();
+    airport.longitude = query.value(columns[AirportLongitudeColumn]).toDouble();
+    airport.timezone = query.value(columns[AirportTimezoneColumn]).toString();
+    airport.description = query.value(columns[AirportDescriptionColumn]).toString();
+    return airport;
+}
+
+/**
+ * @brief Decode the current row of an airlines query
+ */
+static AirlineRow readAirlineRow(const QSqlQuery& query, const QVector<int>& columns)
+{
+    AirlineRow airline;
+    airline.id = query.value(columns[AirlineIdColumn]).toInt();
+    airline.code = query.value(columns[AirlineCodeColumn]).toString();
+    airline.name = query.value(columns[AirlineNameColumn]).toString();
+    airline.country = query.value(columns[AirlineCountryColumn]).toString();
+    airline.logo = query.value(columns[AirlineLogoColumn]).toString();
+    return airline;
+}
+
+/**
+ * @brief Decode the current row of a bookings query
+ */
+static BookingRow readBookingRow(const QSqlQuery& query, const QVector<int>& columns)
+{
+    BookingRow booking;
+    booking.id = query.value(columns[BookingIdColumn]).toInt();
+    booking.bookingDate = query.value(columns[BookingDateColumn]).toDateTime();
+    booking.seatClass = query.value(columns[BookingSeatClassColumn]).toString();
+    booking.passengerName = query.value(columns[BookingPassengerNameColumn]).toString();
+    booking.passengerPassport = query.value(columns[BookingPassengerPassportColumn]).toString();
+    booking.status = query.value(columns[BookingStatusColumn]).toString();
+    booking.flightNumber = query.value(columns[BookingFlightNumberColumn]).toString();
+    booking.airlineName = query.value(columns[BookingAirlineNameColumn]).toString();
+    booking.departureCode = query.value(columns[BookingDepartureCodeColumn]).toString();
+    booking.departureCity = query.value(columns[BookingDepartureCityColumn]).toString();
+    booking.arrivalCode = query.value(columns[BookingArrivalCodeColumn]).toString();
+    booking.arrivalCity = query.value(columns[BookingArrivalCityColumn]).toString();
+    booking.departureTime = query.value(columns[BookingDepartureTimeColumn]).toDateTime();
+    booking.arrivalTime = query.value(columns[BookingArrivalTimeColumn]).toDateTime();
+    return booking;
+}
+
 Database* Database::getInstance()
 {
     if (!instance) {
@@ -22,115 +406,92 @@ Database* Database::getInstance()
     return instance;
 }
 
-Database::Database(QObject *parent) : QObject(parent)
+Database::Database(QObject *parent) : QObject(parent), pool(nullptr), timetableEnabled(false)
 {
-    // Initialize database connection
+    // Connections are opened lazily by the pool in initialize().
+    // Worker threads are kept alive so that each keeps its pooled connection.
+    workers.setExpiryTimeout(-1);
 }
 
 Database::~Database()
 {
+    workers.waitForDone();
     close();
 }
 
+void Database::setPoolSettings(const ConnectionPool::Settings& settings)
+{
+    poolSettings = settings;
+}
+
 bool Database::initialize()
 {
-    // Set up PostgreSQL database connection
-    db = QSqlDatabase::addDatabase("QPSQL");
-    db.setHostName("localhost");
-    db.setDatabaseName("airport_inspector");
-    db.setUserName("postgres");
-    db.setPassword("postgres");
-    db.setPort(5432);
+    // Set up the PostgreSQL connection pool; the workers leave the reserved
+    // connections to the GUI thread and other threads using the database
+    if (!pool) {
+        pool = new ConnectionPool(poolSettings, this);
+        const ConnectionPool::Settings& settings = pool->settings();
+        workers.setMaxThreadCount(qMax(1, settings.maxConnections - qMax(0, settings.reservedConnections)));
+    }
     
-    if (!db.open()) {
-        qDebug() << "Error opening PostgreSQL database:" << db.lastError().text();
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        qDebug() << "Error opening PostgreSQL database:" << pool->lastError();
         return false;
     }
     
-    // Create tables if they don't exist
-    createTables();
+    // Bring the schema to the latest version
+    if (!migrateSchema()) {
+        return false;
+    }
     
     // Populate with sample data if needed
-    QSqlQuery query;
+    QSqlQuery query(lease.database());
     query.prepare("SELECT COUNT(*) FROM airports");
     if (query.exec() && query.next() && query.value(0).toInt() == 0) {
+        query.finish();
         populateSampleData();
     }
     
-    return true;
+    // Airports and airlines are served from memory from now on
+    return reloadReferenceData();
 }
 
 void Database::close()
 {
-    if (db.isOpen()) {
-        db.close();
-    }
-}
-
-void Database::createTables()
-{
-    QSqlQuery query;
-    
-    // Create airports table
-    query.exec("CREATE TABLE IF NOT EXISTS airports ("
-               "id SERIAL PRIMARY KEY, "
-               "code TEXT NOT NULL UNIQUE, "
-               "name TEXT NOT NULL, "
-               "city TEXT NOT NULL, "
-               "country TEXT NOT NULL, "
-               "latitude REAL, "
-               "longitude REAL, "
-               "timezone TEXT, "
-               "description TEXT)");
-    
-    // Create airlines table
-    query.exec("CREATE TABLE IF NOT EXISTS airlines ("
-               "id SERIAL PRIMARY KEY, "
-               "code TEXT NOT NULL UNIQUE, "
-               "name TEXT NOT NULL, "
-               "country TEXT NOT NULL, "
-               "logo TEXT)");
-    
-    // Create flights table
-    query.exec("CREATE TABLE IF NOT EXISTS flights ("
-               "id SERIAL PRIMARY KEY, "
-               "flight_number TEXT NOT NULL, "
-               "airline_id INTEGER NOT NULL REFERENCES airlines(id), "
-               "departure_airport_id INTEGER NOT NULL REFERENCES airports(id), "
-               "arrival_airport_id INTEGER NOT NULL REFERENCES airports(id), "
-               "departure_time TIMESTAMP NOT NULL, "
-               "arrival_time TIMESTAMP NOT NULL, "
-               "price_economy REAL NOT NULL, "
-               "price_business REAL NOT NULL, "
-               "price_first REAL NOT NULL, "
-               "available_seats_economy INTEGER NOT NULL, "
-               "available_seats_business INTEGER NOT NULL, "
-               "available_seats_first INTEGER NOT NULL)");
-    
-    // Create users table
-    query.exec("CREATE TABLE IF NOT EXISTS users ("
-               "id SERIAL PRIMARY KEY, "
-               "username TEXT NOT NULL UNIQUE, "
-               "password TEXT NOT NULL, "
-               "email TEXT NOT NULL, "
-               "full_name TEXT NOT NULL, "
-               "registration_date TIMESTAMP NOT NULL)");
-    
-    // Create bookings table
-    query.exec("CREATE TABLE IF NOT EXISTS bookings ("
-               "id SERIAL PRIMARY KEY, "
-               "flight_id INTEGER NOT NULL REFERENCES flights(id), "
-               "user_id INTEGER NOT NULL REFERENCES users(id), "
-               "booking_date TIMESTAMP NOT NULL, "
-               "seat_class TEXT NOT NULL, "
-               "passenger_name TEXT NOT NULL, "
-               "passenger_passport TEXT NOT NULL, "
-               "status TEXT NOT NULL)");
-}
-
-void Database::populateSampleData()
-{
-    QSqlQuery query;
+    if (pool) {
+        pool->closeAll();
+    }
+}
+
+ConnectionPool* Database::connectionPool() const
+{
+    return pool;
+}
+
+bool Database::migrateSchema()
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return false;
+    }
+    
+    SchemaMigrator migrator(lease.database());
+    return migrator.migrate();
+}
+
+bool Database::populateSampleData()
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlDatabase db = lease.database();
+    
+    // Load everything in one transaction so a failure leaves the tables empty
+    if (!db.transaction()) {
+        qDebug() << "Error starting sample data transaction:" << db.lastError().text();
+        return false;
+    }
+    
+    BulkLoader loader(db);
     
     // Insert sample airports
     QList<QStringList> airports = {
@@ -146,19 +507,13 @@ void Database::populateSampleData()
         {"UFA", "Ufa International Airport", "Ufa", "Russia", "54.558", "55.874", "Asia/Yekaterinburg", "International airport serving Ufa"}
     };
     
-    for (const QStringList& airport : airports) {
-        query.prepare("INSERT INTO airports (code, name, city, country, latitude, longitude, timezone, description) "
-                     "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-        query.addBindValue(airport[0]);
-        query.addBindValue(airport[1]);
-        query.addBindValue(airport[2]);
-        query.addBindValue(airport[3]);
-        query.addBindValue(airport[4]);
-        query.addBindValue(airport[5]);
-        query.addBindValue(airport[6]);
-        query.addBindValue(airport[7]);
-        query.exec();
+    bool ok = loader.begin("airports", {"id", "code", "name", "city", "country", "latitude", "longitude", "timezone", "description"});
+    for (int i = 0; ok && i < airports.size(); i++) {
+        const QStringList& airport = airports[i];
+        ok = loader.addRow({i + 1, airport[0], airport[1], airport[2], airport[3],
+                            airport[4], airport[5], airport[6], airport[7]});
     }
+    ok = ok && loader.finish();
     
     // Insert sample airlines
     QList<QStringList> airlines = {
@@ -169,487 +524,1476 @@ void Database::populateSampleData()
         {"PBD", "Pobeda", "Russia", "pobeda.png"}
     };
     
-    for (const QStringList& airline : airlines) {
-        query.prepare("INSERT INTO airlines (code, name, country, logo) VALUES (?, ?, ?, ?)");
-        query.addBindValue(airline[0]);
-        query.addBindValue(airline[1]);
-        query.addBindValue(airline[2]);
-        query.addBindValue(airline[3]);
-        query.exec();
+    ok = ok && loader.begin("airlines", {"id", "code", "name", "country", "logo"});
+    for (int i = 0; ok && i < airlines.size(); i++) {
+        const QStringList& airline = airlines[i];
+        ok = loader.addRow({i + 1, airline[0], airline[1], airline[2], airline[3]});
     }
+    ok = ok && loader.finish();
     
-    // Insert sample flights
-    // Get current date for sample flights
-    QDate currentDate = QDate::currentDate();
+    // Create flights between different city pairs
+    QList<QPair<int, int>> routes = {
+        {1, 3}, // Moscow SVO to Saint Petersburg
+        {3, 1}, // Saint Petersburg to Moscow SVO
+        {1, 4}, // Moscow SVO to Sochi
+        {4, 1}, // Sochi to Moscow SVO
+        {2, 5}, // Moscow DME to Kazan
+        {5, 2}, // Kazan to Moscow DME
+        {1, 6}, // Moscow SVO to Vladivostok
+        {6, 1}, // Vladivostok to Moscow SVO
+        {2, 7}, // Moscow DME to Novosibirsk
+        {7, 2}, // Novosibirsk to Moscow DME
+        {3, 8}, // Saint Petersburg to Krasnodar
+        {8, 3}, // Krasnodar to Saint Petersburg
+        {1, 9}, // Moscow SVO to Rostov-on-Don
+        {9, 1}, // Rostov-on-Don to Moscow SVO
+        {2, 10}, // Moscow DME to Ufa
+        {10, 2}  // Ufa to Moscow DME
+    };
+    
+    // Morning and evening departure windows
+    const QList<QTime> departureWindows = {QTime(8, 0), QTime(16, 0)};
     
     // Create sample flights for the next 30 days
-    for (int day = 0; day < 30; day++) {
+    QDate currentDate = QDate::currentDate();
+    QRandomGenerator *random = QRandomGenerator::global();
+    
+    ok = ok && loader.begin("flights", {"flight_number", "airline_id", "departure_airport_id", "arrival_airport_id",
+                                        "departure_time", "arrival_time", "price_economy", "price_business", "price_first",
+                                        "available_seats_economy", "available_seats_business", "available_seats_first"});
+    for (int day = 0; ok && day < 30; day++) {
         QDate flightDate = currentDate.addDays(day);
         
-        // Create flights between different city pairs
-        QList<QPair<int, int>> routes = {
-            {1, 3}, // Moscow SVO to Saint Petersburg
-            {3, 1}, // Saint Petersburg to Moscow SVO
-            {1, 4}, // Moscow SVO to Sochi
-            {4, 1}, // Sochi to Moscow SVO
-            {2, 5}, // Moscow DME to Kazan
-            {5, 2}, // Kazan to Moscow DME
-            {1, 6}, // Moscow SVO to Vladivostok
-            {6, 1}, // Vladivostok to Moscow SVO
-            {2, 7}, // Moscow DME to Novosibirsk
-            {7, 2}, // Novosibirsk to Moscow DME
-            {3, 8}, // Saint Petersburg to Krasnodar
-            {8, 3}, // Krasnodar to Saint Petersburg
-            {1, 9}, // Moscow SVO to Rostov-on-Don
-            {9, 1}, // Rostov-on-Don to Moscow SVO
-            {2, 10}, // Moscow DME to Ufa
-            {10, 2}  // Ufa to Moscow DME
-        };
-        
         for (const auto& route : routes) {
-            // Morning flight
-            QDateTime departureTime(flightDate, QTime(8, 0).addSecs(QRandomGenerator::global()->bounded(4 * 3600)));
-            QDateTime arrivalTime = departureTime.addSecs(QRandomGenerator::global()->bounded(2 * 3600, 5 * 3600));
-            
-            int airlineId = QRandomGenerator::global()->bounded(1, 6);
-            double basePrice = QRandomGenerator::global()->bounded(3000, 15000);
-            
-            query.prepare("INSERT INTO flights (flight_number, airline_id, departure_airport_id, arrival_airport_id, "
-                         "departure_time, arrival_time, price_economy, price_business, price_first, "
-                         "available_seats_economy, available_seats_business, available_seats_first) "
-                         "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-            
-            query.addBindValue(QString("FL%1").arg(QRandomGenerator::global()->bounded(1000, 9999)));
-            query.addBindValue(airlineId);
-            query.addBindValue(route.first);
-            query.addBindValue(route.second);
-            query.addBindValue(departureTime.toString(Qt::ISODate));
-            query.addBindValue(arrivalTime.toString(Qt::ISODate));
-            query.addBindValue(basePrice);
-            query.addBindValue(basePrice * 2.5);
-            query.addBindValue(basePrice * 4.0);
-            query.addBindValue(QRandomGenerator::global()->bounded(50, 150));
-            query.addBindValue(QRandomGenerator::global()->bounded(10, 30));
-            query.addBindValue(QRandomGenerator::global()->bounded(5, 15));
-            query.exec();
-            
-            // Evening flight
-            departureTime = QDateTime(flightDate, QTime(16, 0).addSecs(QRandomGenerator::global()->bounded(4 * 3600)));
-            arrivalTime = departureTime.addSecs(QRandomGenerator::global()->bounded(2 * 3600, 5 * 3600));
-            
-            airlineId = QRandomGenerator::global()->bounded(1, 6);
-            basePrice = QRandomGenerator::global()->bounded(3000, 15000);
-            
-            query.prepare("INSERT INTO flights (flight_number, airline_id, departure_airport_id, arrival_airport_id, "
-                         "departure_time, arrival_time, price_economy, price_business, price_first, "
-                         "available_seats_economy, available_seats_business, available_seats_first) "
-                         "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-            
-            query.addBindValue(QString("FL%1").arg(QRandomGenerator::global()->bounded(1000, 9999)));
-            query.addBindValue(airlineId);
-            query.addBindValue(route.first);
-            query.addBindValue(route.second);
-            query.addBindValue(departureTime.toString(Qt::ISODate));
-            query.addBindValue(arrivalTime.toString(Qt::ISODate));
-            query.addBindValue(basePrice);
-            query.addBindValue(basePrice * 2.5);
-            query.addBindValue(basePrice * 4.0);
-            query.addBindValue(QRandomGenerator::global()->bounded(50, 150));
-            query.addBindValue(QRandomGenerator::global()->bounded(10, 30));
-            query.addBindValue(QRandomGenerator::global()->bounded(5, 15));
-            query.exec();
+            for (const QTime& window : departureWindows) {
+                QDateTime departureTime(flightDate, window.addSecs(random->bounded(4 * 3600)));
+                QDateTime arrivalTime = departureTime.addSecs(random->bounded(2 * 3600, 5 * 3600));
+                
+                int airlineId = random->bounded(1, 6);
+                double basePrice = random->bounded(3000, 15000);
+                
+                ok = ok && loader.addRow({QString("FL%1").arg(random->bounded(1000, 9999)),
+                                          airlineId, route.first, route.second,
+                                          departureTime.toString(Qt::ISODate), arrivalTime.toString(Qt::ISODate),
+                                          basePrice, basePrice * 2.5, basePrice * 4.0,
+                                          random->bounded(50, 150), random->bounded(10, 30), random->bounded(5, 15)});
+            }
         }
     }
+    ok = ok && loader.finish();
+    
+    // Explicit ids bypass the serial sequences, move them past the loaded rows
+    QSqlQuery query(db);
+    ok = ok && query.exec("SELECT setval(pg_get_serial_sequence('airports', 'id'), (SELECT MAX(id) FROM airports)), "
+                          "setval(pg_get_serial_sequence('airlines', 'id'), (SELECT MAX(id) FROM airlines))");
     
     // Insert sample user
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    hash.addData("password123");
-    QString hashedPassword = QString(hash.result().toHex());
-    
-    query.prepare("INSERT INTO users (username, password, email, full_name, registration_date) "
-                 "VALUES (?, ?, ?, ?, ?) RETURNING id");
-    query.addBindValue("user");
-    query.addBindValue(hashedPassword);
-    query.addBindValue("user@example.com");
-    query.addBindValue("Sample User");
-    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
-    query.exec();
-}
-
-QList<QMap<QString, QVariant>> Database::searchFlights(const QString& departureCity, 
-                                                     const QString& arrivalCity, 
-                                                     const QDate& departureDate, 
-                                                     const QDate& returnDate)
-{
-    QList<QMap<QString, QVariant>> results;
-    
-    QSqlQuery query;
-    query.prepare(
-        "SELECT f.id, f.flight_number, a.name as airline_name, "
-        "dep.code as departure_code, dep.city as departure_city, "
-        "arr.code as arrival_code, arr.city as arrival_city, "
-        "f.departure_time, f.arrival_time, "
-        "f.price_economy, f.price_business, f.price_first, "
-        "f.available_seats_economy, f.available_seats_business, f.available_seats_first "
-        "FROM flights f "
-        "JOIN airlines a ON f.airline_id = a.id "
-        "JOIN airports dep ON f.departure_airport_id = dep.id "
-        "JOIN airports arr ON f.arrival_airport_id = arr.id "
-        "WHERE dep.city = ? AND arr.city = ? "
-        "AND date(f.departure_time) = ? "
-        "ORDER BY f.departure_time"
-    );
+    QString hashedPassword = passwords.hash("password123").result();
     
-    query.addBindValue(departureCity);
-    query.addBindValue(arrivalCity);
-    query.addBindValue(departureDate.toString(Qt::ISODate));
+    if (ok) {
+        query.prepare("INSERT INTO users (username, password, email, full_name, registration_date) "
+                     "VALUES (?, ?, ?, ?, ?)");
+        query.addBindValue("user");
+        query.addBindValue(hashedPassword);
+        query.addBindValue("user@example.com");
+        query.addBindValue("Sample User");
+        query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+        ok = query.exec();
+    }
     
-    if (query.exec()) {
-        while (query.next()) {
-            QMap<QString, QVariant> flight;
-            flight["id"] = query.value("id");
-            flight["flight_number"] = query.value("flight_number");
-            flight["airline_name"] = query.value("airline_name");
-            flight["departure_code"] = query.value("departure_code");
-            flight["departure_city"] = query.value("departure_city");
-            flight["arrival_code"] = query.value("arrival_code");
-            flight["arrival_city"] = query.value("arrival_city");
-            flight["departure_time"] = query.value("departure_time");
-            flight["arrival_time"] = query.value("arrival_time");
-            flight["price_economy"] = query.value("price_economy");
-            flight["price_business"] = query.value("price_business");
-            flight["price_first"] = query.value("price_first");
-            flight["available_seats_economy"] = query.value("available_seats_economy");
-            flight["available_seats_business"] = query.value("available_seats_business");
-            flight["available_seats_first"] = query.value("available_seats_first");
-            
-            results.append(flight);
+    if (!ok || !db.commit()) {
+        QString error = loader.lastError().isEmpty() ? query.lastError().text() : loader.lastError();
+        qDebug() << "Error populating sample data:" << (error.trimmed().isEmpty() ? db.lastError().text() : error);
+        db.rollback();
+        return false;
+    }
+    
+    qDebug() << "Sample data loaded" << (loader.usesCopy() ? "with COPY" : "with multi-row INSERT");
+    return true;
+}
+
+QVector<FlightRow> Database::searchFlights(const QString& departureCity, 
+                                          const QString& arrivalCity, 
+                                          const QDate& departureDate, 
+                                          const QDate& returnDate)
+{
+    // Answer from the in-memory timetable while its snapshot is fresh
+    if (timetableEnabled) {
+        QSharedPointer<const TimetableSnapshot> snapshot = timetable.freshSnapshot();
+        if (snapshot) {
+            return snapshot->searchFlights(departureCity, arrivalCity, departureDate, returnDate);
         }
-    } else {
-        qDebug() << "Error searching flights:" << query.lastError().text();
-    }
-    
-    // If return date is specified, search for return flights
-    if (returnDate.isValid()) {
-        query.prepare(
-            "SELECT f.id, f.flight_number, a.name as airline_name, "
-            "dep.code as departure_code, dep.city as departure_city, "
-            "arr.code as arrival_code, arr.city as arrival_city, "
-            "f.departure_time, f.arrival_time, "
-            "f.price_economy, f.price_business, f.price_first, "
-            "f.available_seats_economy, f.available_seats_business, f.available_seats_first "
-            "FROM flights f "
-            "JOIN airlines a ON f.airline_id = a.id "
-            "JOIN airports dep ON f.departure_airport_id = dep.id "
-            "JOIN airports arr ON f.arrival_airport_id = arr.id "
-            "WHERE dep.city = ? AND arr.city = ? "
-            "AND date(f.departure_time) = ? "
-            "ORDER BY f.departure_time"
-        );
-        
-        query.addBindValue(arrivalCity);
-        query.addBindValue(departureCity);
-        query.addBindValue(returnDate.toString(Qt::ISODate));
         
-        if (query.exec()) {
-            while (query.next()) {
-                QMap<QString, QVariant> flight;
-                flight["id"] = query.value("id");
-                flight["flight_number"] = query.value("flight_number");
-                flight["airline_name"] = query.value("airline_name");
-                flight["departure_code"] = query.value("departure_code");
-                flight["departure_city"] = query.value("departure_city");
-                flight["arrival_code"] = query.value("arrival_code");
-                flight["arrival_city"] = query.value("arrival_city");
-                flight["departure_time"] = query.value("departure_time");
-                flight["arrival_time"] = query.value("arrival_time");
-                flight["price_economy"] = query.value("price_economy");
-                flight["price_business"] = query.value("price_business");
-                flight["price_first"] = query.value("price_first");
-                flight["available_seats_economy"] = query.value("available_seats_economy");
-                flight["available_seats_business"] = query.value("available_seats_business");
-                flight["available_seats_first"] = query.value("available_seats_first");
-                flight["is_return"] = true;
-                
-                results.append(flight);
-            }
-        } else {
-            qDebug() << "Error searching return flights:" << query.lastError().text();
+        // Stale or missing: use SQL now and refresh the snapshot in the background
+        scheduleTimetableRebuild();
+    }
+    
+    QVector<FlightRow> results;
+    
+    // A round trip fetches both legs in one statement
+    bool roundTrip = returnDate.isValid();
+    StatementId statement = roundTrip ? SearchRoundTripStatement : SearchFlightsStatement;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, statement, roundTrip ? searchRoundTripSql : searchFlightsSql);
+    if (!query) {
+        return results;
+    }
+    
+    bindFlightLeg(*query, 0, departureCity, arrivalCity, departureDate);
+    if (roundTrip) {
+        bindFlightLeg(*query, FlightLegBindCount, arrivalCity, departureCity, returnDate);
+    }
+    
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, statement, flightColumnNames, FlightColumnCount);
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            results.append(readFlightRow(*query, columns));
         }
+    } else {
+        qDebug() << "Error searching flights:" << query->lastError().text();
     }
+    query->finish();
     
     return results;
 }
 
-QMap<QString, QVariant> Database::getAirportInfo(const QString& airportCode)
+void Database::setTimetableEnabled(bool enabled, int maxAgeMs)
 {
-    QMap<QString, QVariant> result;
-    
-    QSqlQuery query;
-    query.prepare("SELECT * FROM airports WHERE code = ?");
-    query.addBindValue(airportCode);
-    
-    if (query.exec() && query.next()) {
-        result["id"] = query.value("id");
-        result["code"] = query.value("code");
-        result["name"] = query.value("name");
-        result["city"] = query.value("city");
-        result["country"] = query.value("country");
-        result["latitude"] = query.value("latitude");
-        result["longitude"] = query.value("longitude");
-        result["timezone"] = query.value("timezone");
-        result["description"] = query.value("description");
-    } else {
-        qDebug() << "Error getting airport info:" << query.lastError().text();
+    timetable.setMaxAge(maxAgeMs);
+    timetableEnabled = enabled;
+    if (!enabled) {
+        timetable.invalidate();
+    }
+}
+
+bool Database::rebuildTimetable()
+{
+    // Join a rebuild that is already loading instead of loading a second snapshot
+    if (!timetable.startRebuild(false)) {
+        return timetable.waitForRebuild();
+    }
+    return loadTimetable();
+}
+
+void Database::scheduleTimetableRebuild()
+{
+    if (timetable.beginRebuild()) {
+        QtConcurrent::run(&workers, [this]() {
+            // Skipped if a synchronous rebuild took the work over meanwhile
+            if (timetable.startRebuild(true)) {
+                loadTimetable();
+            }
+        });
+    }
+}
+
+bool Database::loadTimetable()
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        timetable.cancelRebuild(pool->lastError());
+        return false;
+    }
+    return timetable.rebuild(lease.database(), referenceData());
+}
+
+TimetableEngine* Database::timetableEngine()
+{
+    return &timetable;
+}
+
+QVector<ItineraryRow> Database::searchItineraries(const QString& departureCity,
+                                                  const QString& arrivalCity,
+                                                  const QDate& departureDate,
+                                                  const ItineraryOptions& options)
+{
+    // Connections have no SQL fallback, so a stale snapshot beats none
+    QSharedPointer<const TimetableSnapshot> snapshot = timetable.freshSnapshot();
+    if (!snapshot) {
+        snapshot = timetable.snapshot();
+        if (snapshot) {
+            scheduleTimetableRebuild();
+        } else if (rebuildTimetable()) {
+            snapshot = timetable.snapshot();
+        } else {
+            return QVector<ItineraryRow>();
+        }
     }
     
-    return result;
+    return ConnectionScan(snapshot).search(departureCity, arrivalCity, departureDate, options);
 }
 
-QList<QMap<QString, QVariant>> Database::getAllAirports()
+QVector<RoundTripRow> Database::searchRoundTripPairs(const QString& departureCity,
+                                                    const QString& arrivalCity,
+                                                    const QDate& departureDate,
+                                                    const QDate& returnDate,
+                                                    const QString& seatClass,
+                                                    int limit)
 {
-    QList<QMap<QString, QVariant>> results;
+    QVector<RoundTripRow> results;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, SearchRoundTripPairsStatement, searchRoundTripPairsSql);
+    if (!query) {
+        return results;
+    }
     
-    QSqlQuery query("SELECT * FROM airports ORDER BY city, name");
+    query->bindValue(0, seatClass);
+    bindFlightLeg(*query, 1, departureCity, arrivalCity, departureDate);
+    bindFlightLeg(*query, 1 + FlightLegBindCount, arrivalCity, departureCity, returnDate);
+    query->bindValue(1 + 2 * FlightLegBindCount, qMax(1, limit));
     
-    if (query.exec()) {
-        while (query.next()) {
-            QMap<QString, QVariant> airport;
-            airport["id"] = query.value("id");
-            airport["code"] = query.value("code");
-            airport["name"] = query.value("name");
-            airport["city"] = query.value("city");
-            airport["country"] = query.value("country");
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, SearchRoundTripPairsStatement, flightColumnNames, FlightColumnCount);
+        int rankColumn = query->record().indexOf("pair_rank");
+        int totalColumn = query->record().indexOf("total_price");
+        results.reserve(qMax(0, query->size() / 2));
+        
+        // Rows come ordered by pair rank, outbound leg first
+        qint64 currentRank = -1;
+        while (query->next()) {
+            qint64 rank = query->value(rankColumn).toLongLong();
+            if (rank != currentRank) {
+                currentRank = rank;
+                results.append(RoundTripRow());
+                results.last().totalPrice = query->value(totalColumn).toDouble();
+            }
             
-            results.append(airport);
+            FlightRow flight = readFlightRow(*query, columns);
+            if (flight.isReturn) {
+                results.last().returnFlight = std::move(flight);
+            } else {
+                results.last().outbound = std::move(flight);
+            }
         }
     } else {
-        qDebug() << "Error getting all airports:" << query.lastError().text();
+        qDebug() << "Error searching round trip pairs:" << query->lastError().text();
     }
+    query->finish();
     
     return results;
 }
 
-int Database::bookTicket(int flightId, int userId, const QString& seatClass, 
-                       const QString& passengerName, const QString& passengerPassport)
+QVector<FareDayRow> Database::getFareCalendar(const QString& departureCity,
+                                             const QString& arrivalCity,
+                                             const QDate& centerDate,
+                                             int days)
 {
-    QSqlQuery query;
+    QVector<FareDayRow> results;
     
-    // Check if flight exists and has available seats
-    query.prepare("SELECT available_seats_economy, available_seats_business, available_seats_first "
-                 "FROM flights WHERE id = ?");
-    query.addBindValue(flightId);
+    ConnectionPool::Lease lease = pool->acquire();
     
-    if (!query.exec() || !query.next()) {
-        qDebug() << "Error checking flight availability:" << query.lastError().text();
-        return -1;
+    // Seat changes of bookings reach the summary here rather than in the booking transaction
+    QSqlQuery *query = preparedStatement(lease, FlushFareSummaryStatement, "SELECT flush_route_day_fares()");
+    if (!query) {
+        return results;
     }
+    if (!query->exec()) {
+        qDebug() << "Error refreshing fare summary:" << query->lastError().text();
+    }
+    query->finish();
     
-    int availableSeats = 0;
-    QString seatColumn;
-    
-    if (seatClass == "Economy") {
-        availableSeats = query.value("available_seats_economy").toInt();
-        seatColumn = "available_seats_economy";
-    } else if (seatClass == "Business") {
-        availableSeats = query.value("available_seats_business").toInt();
-        seatColumn = "available_seats_business";
-    } else if (seatClass == "First") {
-        availableSeats = query.value("available_seats_first").toInt();
-        seatColumn = "available_seats_first";
-    } else {
-        qDebug() << "Invalid seat class:" << seatClass;
-        return -1;
+    query = preparedStatement(lease, GetFareCalendarStatement, getFareCalendarSql);
+    if (!query) {
+        return results;
     }
     
-    if (availableSeats <= 0) {
-        qDebug() << "No available seats for class:" << seatClass;
-        return -1;
+    days = qMax(0, days);
+    query->bindValue(0, departureCity);
+    query->bindValue(1, departureCity);
+    query->bindValue(2, arrivalCity);
+    query->bindValue(3, arrivalCity);
+    query->bindValue(4, centerDate.addDays(-days).toString(Qt::ISODate));
+    query->bindValue(5, centerDate.addDays(days).toString(Qt::ISODate));
+    
+    if (query->exec()) {
+        results.reserve(2 * days + 1);
+        while (query->next()) {
+            FareDayRow day;
+            day.date = query->value(0).toDate();
+            day.flightCount = query->value(1).toInt();
+            day.minPriceEconomy = query->value(2).toDouble();
+            day.minPriceBusiness = query->value(3).toDouble();
+            day.minPriceFirst = query->value(4).toDouble();
+            day.availableSeatsEconomy = query->value(5).toInt();
+            day.availableSeatsBusiness = query->value(6).toInt();
+            day.availableSeatsFirst = query->value(7).toInt();
+            results.append(day);
+        }
+    } else {
+        qDebug() << "Error loading fare calendar:" << query->lastError().text();
     }
+    query->finish();
     
-    // Begin transaction
-    db.transaction();
+    return results;
+}
+
+QStringList Database::explainSearchFlights(const QString& departureCity,
+                                           const QString& arrivalCity,
+                                           const QDate& departureDate)
+{
+    QStringList plan;
     
-    // Update available seats
-    query.prepare(QString("UPDATE flights SET %1 = %1 - 1 WHERE id = ?").arg(seatColumn));
-    query.addBindValue(flightId);
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlDatabase db = lease.database();
+    if (!db.isOpen()) {
+        return plan;
+    }
     
-    if (!query.exec()) {
-        qDebug() << "Error updating available seats:" << query.lastError().text();
-        db.rollback();
-        return -1;
+    // EXPLAIN cannot be prepared, so inline the parameters as driver-escaped literals
+    QStringList values = {departureCity, departureCity, arrivalCity, arrivalCity,
+                          departureDate.toString(Qt::ISODate),
+                          departureDate.addDays(1).toString(Qt::ISODate)};
+    QString sql = "EXPLAIN " + searchFlightsSql;
+    for (const QString& value : values) {
+        QSqlField field("value", QMetaType(QMetaType::QString));
+        field.setValue(value);
+        sql.replace(sql.indexOf('?'), 1, db.driver()->formatValue(field));
     }
     
-    // Create booking
-    query.prepare("INSERT INTO bookings (flight_id, user_id, booking_date, seat_class, "
-                 "passenger_name, passenger_passport, status) "
-                 "VALUES (?, ?, ?, ?, ?, ?, ?) RETURNING id");
-    query.addBindValue(flightId);
-    query.addBindValue(userId);
-    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
-    query.addBindValue(seatClass);
-    query.addBindValue(passengerName);
-    query.addBindValue(passengerPassport);
-    query.addBindValue("Confirmed");
-    
-    int bookingId = -1;
-    if (query.exec() && query.next()) {
-        bookingId = query.value(0).toInt();
+    QSqlQuery query(db);
+    if (query.exec(sql)) {
+        while (query.next()) {
+            plan.append(query.value(0).toString());
+        }
     } else {
-        qDebug() << "Error creating booking:" << query.lastError().text();
-        db.rollback();
-        return -1;
+        qDebug() << "Error explaining flight search:" << query.lastError().text();
     }
     
-    // Commit transaction
-    if (!db.commit()) {
-        qDebug() << "Error committing transaction:" << db.lastError().text();
-        db.rollback();
-        return -1;
+    return plan;
+}
+
+FlightRow Database::getFlight(int flightId)
+{
+    FlightRow result;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetFlightStatement, getFlightSql);
+    if (!query) {
+        return result;
+    }
+    
+    query->bindValue(0, flightId);
+    
+    if (query->exec() && query->next()) {
+        result = readFlightRow(*query, statementColumns(lease, GetFlightStatement, flightColumnNames, FlightColumnCount));
+    } else {
+        qDebug() << "Error getting flight:" << query->lastError().text();
     }
+    query->finish();
     
-    return bookingId;
+    return result;
 }
 
-QList<QMap<QString, QVariant>> Database::getUserBookings(int userId)
+QVector<FlightRow> Database::getDeparturesPage(const QString& airportCode, const FlightCursor& after, int limit)
 {
-    QList<QMap<QString, QVariant>> results;
+    QVector<FlightRow> results;
     
-    QSqlQuery query;
-    query.prepare(
-        "SELECT b.id, b.booking_date, b.seat_class, b.passenger_name, b.passenger_passport, b.status, "
-        "f.flight_number, a.name as airline_name, "
-        "dep.code as departure_code, dep.city as departure_city, "
-        "arr.code as arrival_code, arr.city as arrival_city, "
-        "f.departure_time, f.arrival_time "
-        "FROM bookings b "
-        "JOIN flights f ON b.flight_id = f.id "
-        "JOIN airlines a ON f.airline_id = a.id "
-        "JOIN airports dep ON f.departure_airport_id = dep.id "
-        "JOIN airports arr ON f.arrival_airport_id = arr.id "
-        "WHERE b.user_id = ? "
-        "ORDER BY f.departure_time DESC"
-    );
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetDeparturesPageStatement, getDeparturesPageSql);
+    if (!query) {
+        return results;
+    }
     
-    query.addBindValue(userId);
+    query->bindValue(0, airportCode);
+    query->bindValue(1, after.isValid() ? after.departureTime.toString(Qt::ISODateWithMs) : QString("-infinity"));
+    query->bindValue(2, after.isValid() ? after.id : 0);
+    query->bindValue(3, qMax(1, limit));
     
-    if (query.exec()) {
-        while (query.next()) {
-            QMap<QString, QVariant> booking;
-            booking["id"] = query.value("id");
-            booking["booking_date"] = query.value("booking_date");
-            booking["seat_class"] = query.value("seat_class");
-            booking["passenger_name"] = query.value("passenger_name");
-            booking["passenger_passport"] = query.value("passenger_passport");
-            booking["status"] = query.value("status");
-            booking["flight_number"] = query.value("flight_number");
-            booking["airline_name"] = query.value("airline_name");
-            booking["departure_code"] = query.value("departure_code");
-            booking["departure_city"] = query.value("departure_city");
-            booking["arrival_code"] = query.value("arrival_code");
-            booking["arrival_city"] = query.value("arrival_city");
-            booking["departure_time"] = query.value("departure_time");
-            booking["arrival_time"] = query.value("arrival_time");
-            
-            results.append(booking);
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, GetDeparturesPageStatement, flightColumnNames, FlightColumnCount);
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            results.append(readFlightRow(*query, columns));
         }
     } else {
-        qDebug() << "Error getting user bookings:" << query.lastError().text();
+        qDebug() << "Error getting departures:" << query->lastError().text();
     }
+    query->finish();
     
     return results;
 }
 
-int Database::registerUser(const QString& username, const QString& password, 
-                         const QString& email, const QString& fullName)
+/**
+ * @brief Run an airport loading statement and read its rows
+ * @param airportCode Airport IATA code, empty for every airport
+ * @return Non-empty buckets, airports and buckets in ascending order
+ */
+static QVector<AirportLoadRow> queryAirportLoading(const ConnectionPool::Lease& lease, const QString& airportCode,
+                                                   const QDateTime& from, int bucketSeconds, int bucketCount)
 {
-    // Check if username already exists
-    QSqlQuery query;
-    query.prepare("SELECT id FROM users WHERE username = ?");
-    query.addBindValue(username);
+    QVector<AirportLoadRow> results;
     
-    if (query.exec() && query.next()) {
-        qDebug() << "Username already exists:" << username;
-        return -1;
+    // The rollup serves buckets made of whole clock hours
+    bool network = airportCode.isEmpty();
+    bool hourly = bucketSeconds % 3600 == 0 && from.time().minute() == 0 && from.time().second() == 0
+        && from.time().msec() == 0;
+    QSqlQuery *query;
+    if (hourly) {
+        query = network
+            ? preparedStatement(lease, GetNetworkHourlyLoadStatement, getNetworkHourlyLoadSql)
+            : preparedStatement(lease, GetAirportHourlyLoadStatement, getAirportHourlyLoadSql);
+    } else {
+        query = network
+            ? preparedStatement(lease, GetNetworkLoadingStatement, getNetworkLoadingSql)
+            : preparedStatement(lease, GetAirportLoadingStatement, getAirportLoadingSql);
+    }
+    if (!query) {
+        return results;
     }
     
-    // Hash password
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    hash.addData(password.toUtf8());
-    QString hashedPassword = QString(hash.result().toHex());
+    query->bindValue(0, from.toString(Qt::ISODate));
+    query->bindValue(1, from.addSecs(qint64(bucketSeconds) * bucketCount).toString(Qt::ISODate));
+    query->bindValue(2, bucketSeconds);
+    if (!network) {
+        query->bindValue(3, airportCode);
+    }
     
-    // Insert new user
-    query.prepare("INSERT INTO users (username, password, email, full_name, registration_date) "
-                 "VALUES (?, ?, ?, ?, ?) RETURNING id");
-    query.addBindValue(username);
-    query.addBindValue(hashedPassword);
-    query.addBindValue(email);
-    query.addBindValue(fullName);
-    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
-    
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    if (query->exec()) {
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            AirportLoadRow row;
+            row.airportCode = query->value(0).toString();
+            row.bucketStart = from.addSecs(qint64(bucketSeconds) * query->value(1).toInt());
+            row.departures = query->value(2).toInt();
+            row.arrivals = query->value(3).toInt();
+            row.seatsSold = query->value(4).toInt();
+            results.append(row);
+        }
     } else {
-        qDebug() << "Error registering user:" << query.lastError().text();
-        return -1;
+        qDebug() << "Error loading airport loading:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return results;
+}
+
+/**
+ * @brief Check the range of a loading query and count its buckets
+ * @return Number of buckets, 0 if the range is invalid
+ */
+static int loadingBucketCount(const QDateTime& from, const QDateTime& to, int bucketMinutes)
+{
+    if (!from.isValid() || !to.isValid() || from >= to || bucketMinutes < 1) {
+        return 0;
     }
+    qint64 bucketSeconds = qint64(bucketMinutes) * 60;
+    qint64 buckets = (from.secsTo(to) + bucketSeconds - 1) / bucketSeconds;
+    if (buckets > maxLoadingBuckets) {
+        qDebug() << "Too many loading buckets:" << buckets;
+        return 0;
+    }
+    return int(buckets);
 }
 
-int Database::authenticateUser(const QString& username, const QString& password)
+QVector<AirportLoadRow> Database::getAirportLoading(const QString& airportCode, const QDateTime& from,
+                                                    const QDateTime& to, int bucketMinutes)
 {
-    QSqlQuery query;
-    query.prepare("SELECT id, password FROM users WHERE username = ?");
-    query.addBindValue(username);
+    QVector<AirportLoadRow> results;
+    int bucketCount = loadingBucketCount(from, to, bucketMinutes);
+    if (bucketCount == 0 || airportCode.isEmpty()) {
+        return results;
+    }
     
-    if (query.exec() && query.next()) {
-        QString storedPassword = query.value("password").toString();
-        
-        // Hash input password
-        QCryptographicHash hash(QCryptographicHash::Sha256);
-        hash.addData(password.toUtf8());
-        QString hashedPassword = QString(hash.result().toHex());
-        
-        if (storedPassword == hashedPassword) {
-            return query.value("id").toInt();
+    ConnectionPool::Lease lease = pool->acquire();
+    QVector<AirportLoadRow> counted = queryAirportLoading(lease, airportCode, from, bucketMinutes * 60, bucketCount);
+    
+    // Every bucket of the range, quiet ones included, so charts get an even time axis
+    results.resize(bucketCount);
+    for (int i = 0; i < bucketCount; i++) {
+        results[i].airportCode = airportCode;
+        results[i].bucketStart = from.addSecs(qint64(bucketMinutes) * 60 * i);
+    }
+    for (const AirportLoadRow& row : std::as_const(counted)) {
+        int bucket = int(from.secsTo(row.bucketStart) / (qint64(bucketMinutes) * 60));
+        if (bucket >= 0 && bucket < bucketCount) {
+            results[bucket] = row;
         }
     }
     
-    return -1;
+    return results;
 }
 
-QMap<QString, QVariant> Database::getUserProfile(int userId)
+QVector<AirportLoadRow> Database::getNetworkLoading(const QDateTime& from, const QDateTime& to, int bucketMinutes)
 {
-    QMap<QString, QVariant> result;
-    
-    QSqlQuery query;
-    query.prepare("SELECT * FROM users WHERE id = ?");
-    query.addBindValue(userId);
+    int bucketCount = loadingBucketCount(from, to, bucketMinutes);
+    if (bucketCount == 0) {
+        return QVector<AirportLoadRow>();
+    }
     
-    if (query.exec() && query.next()) {
-        result["id"] = query.value("id");
-        result["username"] = query.value("username");
-        result["email"] = query.value("email");
-        result["full_name"] = query.value("full_name");
-        result["registration_date"] = query.value("registration_date");
-    } else {
-        qDebug() << "Error getting user profile:" << query.lastError().text();
+    ConnectionPool::Lease lease = pool->acquire();
+    return queryAirportLoading(lease, QString(), from, bucketMinutes * 60, bucketCount);
+}
+
+bool Database::rebuildLoadRollup()
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return false;
     }
     
-    return result;
+    LoadRollup rollup(lease.database());
+    if (!rollup.rebuild()) {
+        qDebug() << "Error rebuilding loading rollup:" << rollup.lastError();
+        return false;
+    }
+    return true;
 }
 
-bool Database::updateUserProfile(int userId, const QString& email, const QString& fullName)
+bool Database::checkLoadRollup(LoadRollup::Report* report)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE users SET email = ?, full_name = ? WHERE id = ?");
-    query.addBindValue(email);
-    query.addBindValue(fullName);
-    query.addBindValue(userId);
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return false;
+    }
     
-    if (query.exec()) {
-        return true;
-    } else {
-        qDebug() << "Error updating user profile:" << query.lastError().text();
+    LoadRollup rollup(lease.database());
+    if (!rollup.check(report)) {
+        qDebug() << "Error checking loading rollup:" << rollup.lastError();
         return false;
     }
-} 
\ No newline at end of file
+    return true;
+}
+
+QSharedPointer<MovementIndex> Database::buildMovementIndex(const QString& airportCode, const QDate& firstDay, int days)
+{
+    const AirportRow *airport = referenceData()->airportByCode(airportCode);
+    if (!airport || days <= 0) {
+        return QSharedPointer<MovementIndex>();
+    }
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return QSharedPointer<MovementIndex>();
+    }
+    
+    QString error;
+    QSharedPointer<MovementIndex> index = MovementIndex::load(lease.database(), airport->id, firstDay, days, &error);
+    if (!index) {
+        qDebug() << "Error building movement index:" << error;
+    }
+    return index;
+}
+
+QSharedPointer<const ReferenceData> Database::referenceData()
+{
+    QSharedPointer<const ReferenceData> data = referenceCache.snapshot();
+    if (data) {
+        return data;
+    }
+    
+    // Load once even if several threads miss at the same time
+    QMutexLocker locker(&referenceLoadMutex);
+    data = referenceCache.snapshot();
+    if (!data) {
+        bool ok = true;
+        QVector<AirportRow> airports = queryAllAirports(&ok);
+        QVector<AirlineRow> airlines = queryAllAirlines(&ok);
+        
+        // A failed read is not cached, so the next lookup tries again
+        if (ok) {
+            data = referenceCache.replace(airports, airlines);
+        } else {
+            data = QSharedPointer<const ReferenceData>(new ReferenceData(airports, airlines));
+        }
+    }
+    return data;
+}
+
+bool Database::reloadReferenceData()
+{
+    QMutexLocker locker(&referenceLoadMutex);
+    
+    bool ok = true;
+    QVector<AirportRow> airports = queryAllAirports(&ok);
+    QVector<AirlineRow> airlines = queryAllAirlines(&ok);
+    if (!ok) {
+        return false;
+    }
+    
+    referenceCache.replace(airports, airlines);
+    return true;
+}
+
+void Database::invalidateReferenceData()
+{
+    referenceCache.invalidate();
+}
+
+AirportRow Database::getAirportInfo(const QString& airportCode)
+{
+    const AirportRow *airport = referenceData()->airportByCode(airportCode);
+    return airport ? *airport : AirportRow();
+}
+
+AirportRow Database::getAirport(int airportId)
+{
+    const AirportRow *airport = referenceData()->airportById(airportId);
+    return airport ? *airport : AirportRow();
+}
+
+QVector<AirportRow> Database::getAllAirports()
+{
+    return referenceData()->airports();
+}
+
+AirlineRow Database::getAirline(int airlineId)
+{
+    const AirlineRow *airline = referenceData()->airlineById(airlineId);
+    return airline ? *airline : AirlineRow();
+}
+
+QVector<AirlineRow> Database::getAllAirlines()
+{
+    return referenceData()->airlines();
+}
+
+QVector<AirportRow> Database::queryAllAirports(bool* ok)
+{
+    QVector<AirportRow> results;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetAllAirportsStatement, "SELECT * FROM airports ORDER BY city, name");
+    if (!query) {
+        *ok = false;
+        return results;
+    }
+    
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, GetAllAirportsStatement, airportColumnNames, AirportColumnCount);
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            results.append(readAirportRow(*query, columns));
+        }
+    } else {
+        *ok = false;
+        qDebug() << "Error getting all airports:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return results;
+}
+
+QVector<AirlineRow> Database::queryAllAirlines(bool* ok)
+{
+    QVector<AirlineRow> results;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetAllAirlinesStatement, "SELECT * FROM airlines ORDER BY name");
+    if (!query) {
+        *ok = false;
+        return results;
+    }
+    
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, GetAllAirlinesStatement, airlineColumnNames, AirlineColumnCount);
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            results.append(readAirlineRow(*query, columns));
+        }
+    } else {
+        *ok = false;
+        qDebug() << "Error getting all airlines:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return results;
+}
+
+/**
+ * @brief Map a seat class to its counter column and seat decrement statement
+ * @return False for an unknown seat class
+ */
+static bool seatClassColumn(const QString& seatClass, QString* column, StatementId* takeSeatsStatement)
+{
+    if (seatClass == "Economy") {
+        *column = "available_seats_economy";
+        *takeSeatsStatement = TakeEconomySeatsStatement;
+    } else if (seatClass == "Business") {
+        *column = "available_seats_business";
+        *takeSeatsStatement = TakeBusinessSeatsStatement;
+    } else if (seatClass == "First") {
+        *column = "available_seats_first";
+        *takeSeatsStatement = TakeFirstSeatsStatement;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Run a transaction, retrying it on serialization failures and deadlocks
+ * @param attempt Runs the transaction once and sets the error that aborted it
+ * @param failed Result returned when the transaction cannot be completed
+ */
+template <typename T, typename Attempt>
+static T retryTransaction(Attempt attempt, const T& failed, const char* operation)
+{
+    for (int attemptNumber = 1; ; attemptNumber++) {
+        QSqlError error;
+        T result = attempt(&error);
+        if (!error.isValid()) {
+            return result;
+        }
+        
+        if (!isTransientError(error) || attemptNumber >= maxBookingAttempts) {
+            qDebug() << "Error" << operation << ":" << error.text();
+            return failed;
+        }
+        
+        // Back off with jitter so the retrying transactions do not collide again
+        QThread::msleep(QRandomGenerator::global()->bounded(1, 5 << attemptNumber));
+    }
+}
+
+/**
+ * @brief Take seats of a flight inside the current transaction
+ *
+ * The row lock serializes concurrent writers of the flight and the seat
+ * condition is re-checked against the latest row version, so seats can
+ * neither be sold twice nor go negative.
+ * @param remaining Receives the seats left in the class
+ * @param error Receives the database error, left unset when the flight is sold out
+ * @return True if the seats were taken, false if sold out or on error
+ */
+static bool takeSeats(const ConnectionPool::Lease& lease, const QString& seatClass, int flightId, int count,
+                      int* remaining, QSqlError* error)
+{
+    QString seatColumn;
+    StatementId statement;
+    if (!seatClassColumn(seatClass, &seatColumn, &statement)) {
+        return false;
+    }
+    
+    QSqlQuery *query = preparedStatement(lease, statement,
+        QString("UPDATE flights SET %1 = %1 - ? WHERE id = ? AND %1 >= ? RETURNING %1").arg(seatColumn));
+    if (!query) {
+        // Not sold out, so callers must not mistake it for that
+        *error = QSqlError(QString(), "Cannot prepare the seat update", QSqlError::StatementError);
+        return false;
+    }
+    query->bindValue(0, count);
+    query->bindValue(1, flightId);
+    query->bindValue(2, count);
+    
+    if (!query->exec()) {
+        *error = query->lastError();
+        return false;
+    }
+    
+    bool taken = query->next();
+    if (taken && remaining) {
+        *remaining = query->value(0).toInt();
+    }
+    query->finish();
+    
+    if (!taken) {
+        qDebug() << "Not enough available seats for class:" << seatClass << "on flight" << flightId;
+    }
+    return taken;
+}
+
+/**
+ * @brief Insert one booking per passenger with a single statement
+ * @param error Receives the database error
+ * @return Booking IDs in passenger order, empty on error
+ */
+static QVector<int> insertBookings(const ConnectionPool::Lease& lease, int flightId, int userId,
+                                   const QString& seatClass, const QVector<Passenger>& passengers, QSqlError* error)
+{
+    QVector<int> bookingIds;
+    int count = passengers.size();
+    
+    // One statement per group size
+    QStringList rows(count, "(?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery *query = preparedStatement(lease, StatementId(InsertBookingsStatement + count - 1),
+        "INSERT INTO bookings (flight_id, user_id, booking_date, seat_class, "
+        "passenger_name, passenger_passport, status) "
+        "VALUES " + rows.join(", ") + " RETURNING id");
+    if (!query) {
+        return bookingIds;
+    }
+    
+    QString bookingDate = QDateTime::currentDateTime().toString(Qt::ISODate);
+    for (int i = 0; i < count; i++) {
+        int first = i * 7;
+        query->bindValue(first, flightId);
+        query->bindValue(first + 1, userId);
+        query->bindValue(first + 2, bookingDate);
+        query->bindValue(first + 3, seatClass);
+        query->bindValue(first + 4, passengers[i].name);
+        query->bindValue(first + 5, passengers[i].passport);
+        query->bindValue(first + 6, "Confirmed");
+    }
+    
+    if (!query->exec()) {
+        *error = query->lastError();
+        return bookingIds;
+    }
+    
+    bookingIds.reserve(count);
+    while (query->next()) {
+        bookingIds.append(query->value(0).toInt());
+    }
+    query->finish();
+    return bookingIds;
+}
+
+/**
+ * @brief Commit the current transaction, or roll it back if the work failed
+ * @param succeeded True if every statement of the transaction succeeded
+ * @return True if committed
+ */
+static bool finishTransaction(QSqlDatabase& db, bool succeeded, QSqlError* error)
+{
+    if (succeeded && db.commit()) {
+        return true;
+    }
+    if (succeeded) {
+        *error = db.lastError();
+    }
+    db.rollback();
+    return false;
+}
+
+int Database::bookTicket(int flightId, int userId, const QString& seatClass, 
+                       const QString& passengerName, const QString& passengerPassport)
+{
+    return bookTickets(flightId, userId, seatClass, {{passengerName, passengerPassport}}).value(0, -1);
+}
+
+QVector<int> Database::bookTickets(int flightId, int userId, const QString& seatClass,
+                                   const QVector<Passenger>& passengers)
+{
+    QString seatColumn;
+    StatementId statement;
+    if (!seatClassColumn(seatClass, &seatColumn, &statement)) {
+        qDebug() << "Invalid seat class:" << seatClass;
+        return QVector<int>();
+    }
+    
+    if (passengers.isEmpty() || passengers.size() > MaxPassengersPerBooking) {
+        qDebug() << "Invalid number of passengers:" << passengers.size();
+        return QVector<int>();
+    }
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return QVector<int>();
+    }
+    
+    // Either every passenger gets a seat and a booking or nothing changes
+    return retryTransaction([&](QSqlError* error) {
+        QVector<int> bookingIds;
+        QSqlDatabase db = lease.database();
+        if (!db.transaction()) {
+            *error = db.lastError();
+            return bookingIds;
+        }
+        
+        if (takeSeats(lease, seatClass, flightId, passengers.size(), nullptr, error)) {
+            bookingIds = insertBookings(lease, flightId, userId, seatClass, passengers, error);
+        }
+        
+        if (!finishTransaction(db, !bookingIds.isEmpty(), error)) {
+            bookingIds.clear();
+        }
+        return bookingIds;
+    }, QVector<int>(), "booking tickets");
+}
+
+QVector<QVector<int>> Database::bookTicketsBatch(const QVector<BookingRequest>& requests)
+{
+    QVector<QVector<int>> results(requests.size());
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid() || requests.isEmpty()) {
+        return results;
+    }
+    
+    // Rows are locked in flight order, so concurrent batches cannot deadlock on each other
+    QVector<int> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&requests](int a, int b) {
+        return requests[a].flightId < requests[b].flightId;
+    });
+    
+    // Without savepoints a failing request aborts the whole batch; that only
+    // happens on bad input, so savepoints are used only to rerun such a batch
+    auto runBatch = [&](bool savepoints, QSqlError* error) {
+        QVector<QVector<int>> batch(requests.size());
+        QSqlDatabase db = lease.database();
+        if (!db.transaction()) {
+            *error = db.lastError();
+            return batch;
+        }
+        
+        QSqlQuery savepoint(db);
+        for (int index : std::as_const(order)) {
+            const BookingRequest& request = requests[index];
+            QString seatColumn;
+            StatementId statement;
+            if (!seatClassColumn(request.seatClass, &seatColumn, &statement)
+                || request.passengers.isEmpty() || request.passengers.size() > MaxPassengersPerBooking) {
+                continue;
+            }
+            
+            if (savepoints && !savepoint.exec("SAVEPOINT booking")) {
+                *error = savepoint.lastError();
+                break;
+            }
+            
+            QSqlError requestError;
+            if (takeSeats(lease, request.seatClass, request.flightId, request.passengers.size(), nullptr, &requestError)) {
+                batch[index] = insertBookings(lease, request.flightId, request.userId, request.seatClass,
+                                              request.passengers, &requestError);
+            }
+            
+            if (!requestError.isValid()) {
+                if (savepoints && !savepoint.exec("RELEASE SAVEPOINT booking")) {
+                    *error = savepoint.lastError();
+                    break;
+                }
+                continue;
+            }
+            
+            batch[index].clear();
+            if (!savepoints || isTransientError(requestError)) {
+                *error = requestError;
+                break;
+            }
+            qDebug() << "Error booking tickets in batch:" << requestError.text();
+            if (!savepoint.exec("ROLLBACK TO SAVEPOINT booking")) {
+                *error = savepoint.lastError();
+                break;
+            }
+        }
+        
+        if (!finishTransaction(db, !error->isValid(), error)) {
+            batch = QVector<QVector<int>>(requests.size());
+        }
+        return batch;
+    };
+    
+    QSqlError error;
+    results = runBatch(false, &error);
+    if (!error.isValid()) {
+        return results;
+    }
+    
+    return retryTransaction([&](QSqlError* error) {
+        return runBatch(true, error);
+    }, QVector<QVector<int>>(requests.size()), "booking tickets in batch");
+}
+
+SeatHold Database::holdSeats(int flightId, int userId, const QString& seatClass, int count, int ttlSeconds)
+{
+    QString seatColumn;
+    StatementId statement;
+    if (!seatClassColumn(seatClass, &seatColumn, &statement) || count < 1 || count > MaxPassengersPerBooking) {
+        qDebug() << "Invalid seat hold:" << seatClass << count;
+        return SeatHold();
+    }
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return SeatHold();
+    }
+    
+    // Held seats leave the counter at once, so other clients see them as taken
+    return retryTransaction([&](QSqlError* error) {
+        SeatHold hold;
+        QSqlDatabase db = lease.database();
+        if (!db.transaction()) {
+            *error = db.lastError();
+            return hold;
+        }
+        
+        int remaining = 0;
+        bool taken = takeSeats(lease, seatClass, flightId, count, &remaining, error);
+        if (!taken && !error->isValid()) {
+            // Sold out rather than failed: fewer seats than requested are left
+            hold.remainingSeats = count - 1;
+        } else if (taken) {
+            QSqlQuery *query = preparedStatement(lease, InsertSeatHoldStatement,
+                "INSERT INTO seat_holds (flight_id, user_id, seat_class, seats, expires_at) "
+                "VALUES (?, ?, ?, ?, LOCALTIMESTAMP + CAST(? AS INTEGER) * INTERVAL '1 second') "
+                "RETURNING id, expires_at");
+            if (query) {
+                query->bindValue(0, flightId);
+                query->bindValue(1, userId);
+                query->bindValue(2, seatClass);
+                query->bindValue(3, count);
+                query->bindValue(4, ttlSeconds);
+                
+                if (query->exec() && query->next()) {
+                    hold.id = query->value(0).toLongLong();
+                    hold.flightId = flightId;
+                    hold.userId = userId;
+                    hold.seatClass = seatClass;
+                    hold.seats = count;
+                    hold.expiresAt = query->value(1).toDateTime();
+                    hold.remainingSeats = remaining;
+                } else {
+                    *error = query->lastError();
+                }
+                query->finish();
+            }
+        }
+        
+        if (!finishTransaction(db, hold.isValid(), error)) {
+            SeatHold refused;
+            refused.remainingSeats = error->isValid() ? -1 : hold.remainingSeats;
+            hold = refused;
+        }
+        return hold;
+    }, SeatHold(), "holding seats");
+}
+
+QVector<int> Database::confirmHold(qint64 holdId, const QVector<Passenger>& passengers)
+{
+    if (passengers.isEmpty() || passengers.size() > MaxPassengersPerBooking) {
+        qDebug() << "Invalid number of passengers:" << passengers.size();
+        return QVector<int>();
+    }
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        return QVector<int>();
+    }
+    
+    // The seats were taken when the hold was placed; consuming the hold is enough
+    return retryTransaction([&](QSqlError* error) {
+        QVector<int> bookingIds;
+        QSqlDatabase db = lease.database();
+        if (!db.transaction()) {
+            *error = db.lastError();
+            return bookingIds;
+        }
+        
+        QSqlQuery *query = preparedStatement(lease, ConsumeSeatHoldStatement,
+            "DELETE FROM seat_holds WHERE id = ? AND seats = ? AND expires_at > LOCALTIMESTAMP "
+            "RETURNING flight_id, user_id, seat_class");
+        if (query) {
+            query->bindValue(0, holdId);
+            query->bindValue(1, passengers.size());
+            
+            if (query->exec()) {
+                if (query->next()) {
+                    int flightId = query->value(0).toInt();
+                    int userId = query->value(1).toInt();
+                    QString seatClass = query->value(2).toString();
+                    query->finish();
+                    bookingIds = insertBookings(lease, flightId, userId, seatClass, passengers, error);
+                } else {
+                    qDebug() << "Seat hold" << holdId << "expired or does not match the passengers";
+                    query->finish();
+                }
+            } else {
+                *error = query->lastError();
+            }
+        }
+        
+        if (!finishTransaction(db, !bookingIds.isEmpty(), error)) {
+            bookingIds.clear();
+        }
+        return bookingIds;
+    }, QVector<int>(), "confirming seat hold");
+}
+
+// Returns the seats of the deleted holds to the flight counters
+static const char* const returnHeldSeatsSql =
+    "totals AS (SELECT flight_id, "
+    "SUM(CASE seat_class WHEN 'Economy' THEN seats ELSE 0 END) AS economy, "
+    "SUM(CASE seat_class WHEN 'Business' THEN seats ELSE 0 END) AS business, "
+    "SUM(CASE seat_class WHEN 'First' THEN seats ELSE 0 END) AS first "
+    "FROM released GROUP BY flight_id) "
+    "UPDATE flights f SET "
+    "available_seats_economy = f.available_seats_economy + t.economy, "
+    "available_seats_business = f.available_seats_business + t.business, "
+    "available_seats_first = f.available_seats_first + t.first "
+    "FROM totals t WHERE f.id = t.flight_id";
+
+bool Database::releaseHold(qint64 holdId)
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, ReleaseSeatHoldStatement,
+        QString("WITH released AS (DELETE FROM seat_holds WHERE id = ? "
+                "RETURNING flight_id, seat_class, seats), ") + returnHeldSeatsSql);
+    if (!query) {
+        return false;
+    }
+    query->bindValue(0, holdId);
+    
+    // A hold that was confirmed or swept meanwhile is simply gone
+    bool success = query->exec();
+    if (!success) {
+        qDebug() << "Error releasing seat hold:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return success;
+}
+
+int Database::releaseExpiredHolds()
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, ReleaseExpiredSeatHoldsStatement,
+        QString("WITH released AS (DELETE FROM seat_holds WHERE expires_at <= LOCALTIMESTAMP "
+                "RETURNING flight_id, seat_class, seats), ") + returnHeldSeatsSql);
+    if (!query) {
+        return -1;
+    }
+    
+    int flights = -1;
+    if (query->exec()) {
+        flights = query->numRowsAffected();
+    } else {
+        qDebug() << "Error releasing expired seat holds:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return flights;
+}
+
+QVector<BookingRow> Database::getUserBookings(int userId)
+{
+    QVector<BookingRow> results;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetUserBookingsStatement,
+        "SELECT b.id, b.booking_date, b.seat_class, b.passenger_name, b.passenger_passport, b.status, "
+        "f.flight_number, a.name as airline_name, "
+        "dep.code as departure_code, dep.city as departure_city, "
+        "arr.code as arrival_code, arr.city as arrival_city, "
+        "f.departure_time, f.arrival_time "
+        "FROM bookings b "
+        "JOIN flights f ON b.flight_id = f.id "
+        "JOIN airlines a ON f.airline_id = a.id "
+        "JOIN airports dep ON f.departure_airport_id = dep.id "
+        "JOIN airports arr ON f.arrival_airport_id = arr.id "
+        "WHERE b.user_id = ? "
+        "ORDER BY f.departure_time DESC"
+    );
+    if (!query) {
+        return results;
+    }
+    
+    query->bindValue(0, userId);
+    
+    if (query->exec()) {
+        const QVector<int>& columns = statementColumns(lease, GetUserBookingsStatement, bookingColumnNames, BookingColumnCount);
+        results.reserve(qMax(0, query->size()));
+        while (query->next()) {
+            results.append(readBookingRow(*query, columns));
+        }
+    } else {
+        qDebug() << "Error getting user bookings:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return results;
+}
+
+int Database::registerUser(const QString& username, const QString& password, 
+                         const QString& email, const QString& fullName)
+{
+    // Check if username already exists
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, FindUsernameStatement, "SELECT id FROM users WHERE username = ?");
+    if (!query) {
+        return -1;
+    }
+    query->bindValue(0, username);
+    
+    bool exists = query->exec() && query->next();
+    query->finish();
+    if (exists) {
+        qDebug() << "Username already exists:" << username;
+        return -1;
+    }
+    
+    // Hash password without holding a connection for the length of the KDF
+    lease.release();
+    QString hashedPassword = passwords.hash(password).result();
+    
+    // Insert new user
+    lease = pool->acquire();
+    query = preparedStatement(lease, InsertUserStatement,
+        "INSERT INTO users (username, password, email, full_name, registration_date) "
+        "VALUES (?, ?, ?, ?, ?) RETURNING id");
+    if (!query) {
+        return -1;
+    }
+    query->bindValue(0, username);
+    query->bindValue(1, hashedPassword);
+    query->bindValue(2, email);
+    query->bindValue(3, fullName);
+    query->bindValue(4, QDateTime::currentDateTime().toString(Qt::ISODate));
+    
+    int userId = -1;
+    if (query->exec() && query->next()) {
+        userId = query->value(0).toInt();
+    } else {
+        qDebug() << "Error registering user:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return userId;
+}
+
+int Database::authenticateUser(const QString& username, const QString& password)
+{
+    int userId = -1;
+    QString storedPassword;
+    {
+        ConnectionPool::Lease lease = pool->acquire();
+        QSqlQuery *query = preparedStatement(lease, GetCredentialsStatement, "SELECT id, password FROM users WHERE username = ?");
+        if (!query) {
+            return -1;
+        }
+        query->bindValue(0, username);
+        
+        if (query->exec() && query->next()) {
+            userId = query->value(0).toInt();
+            storedPassword = query->value(1).toString();
+        }
+        query->finish();
+    }
+    
+    // Unknown users cost a KDF run too, so timing does not reveal which names exist
+    if (userId < 0) {
+        passwords.verifyDummy(password).waitForFinished();
+        return -1;
+    }
+    if (!passwords.verify(password, storedPassword).result()) {
+        return -1;
+    }
+    
+    // Upgrade weak hashes while the password is at hand; a concurrent change wins
+    if (passwords.needsRehash(storedPassword)) {
+        QString hashedPassword = passwords.hash(password).result();
+        ConnectionPool::Lease lease = pool->acquire();
+        QSqlQuery *query = preparedStatement(lease, UpdatePasswordStatement,
+            "UPDATE users SET password = ? WHERE id = ? AND password = ?");
+        if (query) {
+            query->bindValue(0, hashedPassword);
+            query->bindValue(1, userId);
+            query->bindValue(2, storedPassword);
+            if (!query->exec()) {
+                qDebug() << "Error rehashing password:" << query->lastError().text();
+            }
+            query->finish();
+        }
+    }
+    
+    return userId;
+}
+
+UserProfileRow Database::getUserProfile(int userId)
+{
+    UserProfileRow result;
+    
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, GetUserProfileStatement,
+        "SELECT id, username, email, full_name, registration_date FROM users WHERE id = ?");
+    if (!query) {
+        return result;
+    }
+    query->bindValue(0, userId);
+    
+    if (query->exec() && query->next()) {
+        result.id = query->value(0).toInt();
+        result.username = query->value(1).toString();
+        result.email = query->value(2).toString();
+        result.fullName = query->value(3).toString();
+        result.registrationDate = query->value(4).toDateTime();
+    } else {
+        qDebug() << "Error getting user profile:" << query->lastError().text();
+    }
+    query->finish();
+    
+    return result;
+}
+
+bool Database::updateUserProfile(int userId, const QString& email, const QString& fullName)
+{
+    ConnectionPool::Lease lease = pool->acquire();
+    QSqlQuery *query = preparedStatement(lease, UpdateUserProfileStatement,
+        "UPDATE users SET email = ?, full_name = ? WHERE id = ?");
+    if (!query) {
+        return false;
+    }
+    query->bindValue(0, email);
+    query->bindValue(1, fullName);
+    query->bindValue(2, userId);
+    
+    bool updated = query->exec();
+    if (!updated) {
+        qDebug() << "Error updating user profile:" << query->lastError().text();
+    }
+    query->finish();
+    return updated;
+}
+
+StatementRegistry::Stats Database::statementStats() const
+{
+    return StatementRegistry::stats();
+}
+
+QThreadPool* Database::workerPool()
+{
+    return &workers;
+}
+
+PasswordHasher* Database::passwordHasher()
+{
+    return &passwords;
+}
+
+QFuture<QVector<FlightRow>> Database::searchFlightsAsync(const QString& departureCity,
+                                                        const QString& arrivalCity,
+                                                        const QDate& departureDate,
+                                                        const QDate& returnDate)
+{
+    return QtConcurrent::run(&workers, [this, departureCity, arrivalCity, departureDate, returnDate]() {
+        return searchFlights(departureCity, arrivalCity, departureDate, returnDate);
+    });
+}
+
+QFuture<QVector<ItineraryRow>> Database::searchItinerariesAsync(const QString& departureCity,
+                                                               const QString& arrivalCity,
+                                                               const QDate& departureDate,
+                                                               const ItineraryOptions& options)
+{
+    return QtConcurrent::run(&workers, [this, departureCity, arrivalCity, departureDate, options]() {
+        return searchItineraries(departureCity, arrivalCity, departureDate, options);
+    });
+}
+
+QFuture<QVector<RoundTripRow>> Database::searchRoundTripPairsAsync(const QString& departureCity,
+                                                                 const QString& arrivalCity,
+                                                                 const QDate& departureDate,
+                                                                 const QDate& returnDate,
+                                                                 const QString& seatClass,
+                                                                 int limit)
+{
+    return QtConcurrent::run(&workers, [this, departureCity, arrivalCity, departureDate, returnDate, seatClass, limit]() {
+        return searchRoundTripPairs(departureCity, arrivalCity, departureDate, returnDate, seatClass, limit);
+    });
+}
+
+QFuture<QVector<FareDayRow>> Database::getFareCalendarAsync(const QString& departureCity,
+                                                           const QString& arrivalCity,
+                                                           const QDate& centerDate,
+                                                           int days)
+{
+    return QtConcurrent::run(&workers, [this, departureCity, arrivalCity, centerDate, days]() {
+        return getFareCalendar(departureCity, arrivalCity, centerDate, days);
+    });
+}
+
+QFuture<FlightRow> Database::getFlightAsync(int flightId)
+{
+    return QtConcurrent::run(&workers, [this, flightId]() {
+        return getFlight(flightId);
+    });
+}
+
+QFuture<QVector<FlightRow>> Database::getDeparturesPageAsync(const QString& airportCode, const FlightCursor& after, int limit)
+{
+    return QtConcurrent::run(&workers, [this, airportCode, after, limit]() {
+        return getDeparturesPage(airportCode, after, limit);
+    });
+}
+
+QFuture<QVector<AirportLoadRow>> Database::getAirportLoadingAsync(const QString& airportCode, const QDateTime& from,
+                                                                 const QDateTime& to, int bucketMinutes)
+{
+    return QtConcurrent::run(&workers, [this, airportCode, from, to, bucketMinutes]() {
+        return getAirportLoading(airportCode, from, to, bucketMinutes);
+    });
+}
+
+QFuture<QVector<AirportLoadRow>> Database::getNetworkLoadingAsync(const QDateTime& from, const QDateTime& to,
+                                                                 int bucketMinutes)
+{
+    return QtConcurrent::run(&workers, [this, from, to, bucketMinutes]() {
+        return getNetworkLoading(from, to, bucketMinutes);
+    });
+}
+
+QFuture<AirportRow> Database::getAirportInfoAsync(const QString& airportCode)
+{
+    return QtConcurrent::run(&workers, [this, airportCode]() {
+        return getAirportInfo(airportCode);
+    });
+}
+
+QFuture<QVector<AirportRow>> Database::getAllAirportsAsync()
+{
+    return QtConcurrent::run(&workers, [this]() {
+        return getAllAirports();
+    });
+}
+
+QFuture<QVector<int>> Database::bookTicketsAsync(int flightId, int userId, const QString& seatClass,
+                                                const QVector<Passenger>& passengers)
+{
+    return QtConcurrent::run(&workers, [this, flightId, userId, seatClass, passengers]() {
+        return bookTickets(flightId, userId, seatClass, passengers);
+    });
+}
+
+QFuture<QVector<int>> Database::confirmHoldAsync(qint64 holdId, const QVector<Passenger>& passengers)
+{
+    return QtConcurrent::run(&workers, [this, holdId, passengers]() {
+        return confirmHold(holdId, passengers);
+    });
+}
+
+QFuture<int> Database::bookTicketAsync(int flightId, int userId, const QString& seatClass,
+                                       const QString& passengerName, const QString& passengerPassport)
+{
+    return QtConcurrent::run(&workers, [this, flightId, userId, seatClass, passengerName, passengerPassport]() {
+        return bookTicket(flightId, userId, seatClass, passengerName, passengerPassport);
+    });
+}
+
+QFuture<QVector<BookingRow>> Database::getUserBookingsAsync(int userId)
+{
+    return QtConcurrent::run(&workers, [this, userId]() {
+        return getUserBookings(userId);
+    });
+}
+
+QFuture<int> Database::registerUserAsync(const QString& username, const QString& password,
+                                         const QString& email, const QString& fullName)
+{
+    return QtConcurrent::run(&workers, [this, username, password, email, fullName]() {
+        return registerUser(username, password, email, fullName);
+    });
+}
+
+QFuture<int> Database::authenticateUserAsync(const QString& username, const QString& password)
+{
+    return QtConcurrent::run(&workers, [this, username, password]() {
+        return authenticateUser(username, password);
+    });
+}
+
+QFuture<UserProfileRow> Database::getUserProfileAsync(int userId)
+{
+    return QtConcurrent::run(&workers, [this, userId]() {
+        return getUserProfile(userId);
+    });
+}
+
+QFuture<bool> Database::updateUserProfileAsync(int userId, const QString& email, const QString& fullName)
+{
+    return QtConcurrent::run(&workers, [this, userId, email, fullName]() {
+        return updateUserProfile(userId, email, fullName);
+    });
+}
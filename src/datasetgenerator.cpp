@@ -0,0 +1,619 @@
+#include "datasetgenerator.h"
+#include "bulkloader.h"
+#include "connectionpool.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+
+// Rows per user or booking partition
+static const int rowsPerChunk = 100000;
+
+// Independent random streams, so changing one size does not reshuffle the others
+enum RandomStream {
+    NetworkStream = 1,
+    FlightStream,
+    UserStream,
+    BookingStream
+};
+
+// Share of departures per hour of the day, morning and evening banks
+static const int departureHourWeights[24] = {
+    1, 0, 0, 0, 1, 3, 8, 10, 9, 7, 6, 5, 5, 6, 6, 7, 8, 9, 9, 8, 6, 4, 3, 2
+};
+
+static const char *const countries[] = {
+    "Russia", "Kazakhstan", "Uzbekistan", "Armenia", "Georgia", "Turkey", "UAE", "China"
+};
+
+static quint64 splitMix64(quint64 value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Seed of one partition, independent of how partitions are spread over threads
+static quint64 partitionSeed(quint64 seed, RandomStream stream, int partition)
+{
+    return splitMix64(seed ^ splitMix64((quint64(stream) << 32) | quint32(partition)));
+}
+
+// The standard distributions are implementation-defined; map raw engine output
+// by hand so a seed gives the same dataset with every standard library
+static int uniformInt(std::mt19937_64 &random, int low, int high)
+{
+    return low + int(random() % quint64(high - low + 1));
+}
+
+static double uniformReal(std::mt19937_64 &random)
+{
+    return (random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Zipf distribution over ranks 1..n sampled by rejection-inversion
+ *
+ * Hörmann and Derflinger's method needs constant memory, so it scales to
+ * millions of ranks without a cumulative table.
+ */
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(int count, double exponent)
+        : count(qMax(1, count)), exponent(exponent)
+    {
+        hIntegralX1 = hIntegral(1.5) - 1.0;
+        hIntegralN = hIntegral(this->count + 0.5);
+        threshold = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+
+    int operator()(std::mt19937_64 &random) const
+    {
+        forever {
+            double u = hIntegralN + uniformReal(random) * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            double k = std::floor(x + 0.5);
+            k = qBound(1.0, k, double(count));
+            if (k - x <= threshold || u >= hIntegral(k + 0.5) - h(k)) {
+                return int(k);
+            }
+        }
+    }
+
+private:
+    double h(double x) const
+    {
+        return std::exp(-exponent * std::log(x));
+    }
+
+    double hIntegral(double x) const
+    {
+        double logX = std::log(x);
+        return helper2((1.0 - exponent) * logX) * logX;
+    }
+
+    double hIntegralInverse(double x) const
+    {
+        double t = qMax(-1.0, x * (1.0 - exponent));
+        return std::exp(helper1(t) * x);
+    }
+
+    static double helper1(double x)
+    {
+        return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    static double helper2(double x)
+    {
+        return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+
+    int count;
+    double exponent;
+    double hIntegralX1;
+    double hIntegralN;
+    double threshold;
+};
+
+// Three-letter code of an index, scattered so neighbouring ids do not share prefixes
+static QString letterCode(int index)
+{
+    int value = int((qint64(index) * 7919) % (26 * 26 * 26));
+    QString code(3, 'A');
+    for (int i = 2; i >= 0; i--) {
+        code[i] = QChar('A' + value % 26);
+        value /= 26;
+    }
+    return code;
+}
+
+static double distanceKm(double latitude1, double longitude1, double latitude2, double longitude2)
+{
+    const double radians = 3.14159265358979323846 / 180.0;
+    double dLatitude = (latitude2 - latitude1) * radians;
+    double dLongitude = (longitude2 - longitude1) * radians;
+    double a = std::sin(dLatitude / 2) * std::sin(dLatitude / 2)
+               + std::cos(latitude1 * radians) * std::cos(latitude2 * radians)
+               * std::sin(dLongitude / 2) * std::sin(dLongitude / 2);
+    return 6371.0 * 2.0 * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+}
+
+static QString timestamp(const QDateTime &dateTime)
+{
+    return dateTime.toString("yyyy-MM-dd HH:mm:ss");
+}
+
+DatasetGenerator::DatasetGenerator(ConnectionPool *pool, const DatasetOptions &options)
+    : pool(pool), options(options), droppedBookings(0)
+{
+    this->options.jobs = qMax(1, options.jobs);
+}
+
+bool DatasetGenerator::generate()
+{
+    errorText.clear();
+
+    if (options.airports < 2 || options.airports > 26 * 26 * 26) {
+        setError("Airport count must be between 2 and 17576");
+        return false;
+    }
+    if (options.airlines < 1 || options.airlines > 26 * 26 * 26) {
+        setError("Airline count must be between 1 and 17576");
+        return false;
+    }
+    if (options.routes < 1) {
+        setError("Route count must be positive");
+        return false;
+    }
+    if (qint64(options.days) * options.flightsPerDay > std::numeric_limits<int>::max()) {
+        setError("Flight count exceeds the range of flight ids");
+        return false;
+    }
+
+    ConnectionPool::Lease lease = pool->acquire();
+    if (!lease.isValid()) {
+        setError(pool->lastError());
+        return false;
+    }
+    QSqlDatabase db = lease.database();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    buildNetwork();
+
+    // Legacy SHA-256 digests keep generation fast; they are rehashed on first login
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData("password123");
+    passwordHash = QString(hash.result().toHex());
+
+    if (!prepareTables(db) || !loadReferenceData(db)) {
+        return false;
+    }
+
+    int userChunks = (options.users + rowsPerChunk - 1) / rowsPerChunk;
+    int bookingChunks = (options.bookings + rowsPerChunk - 1) / rowsPerChunk;
+
+    using namespace std::placeholders;
+    if (!runPartitions("flights", options.days, std::bind(&DatasetGenerator::loadFlights, this, _1, _2))
+        || !runPartitions("users", userChunks, std::bind(&DatasetGenerator::loadUsers, this, _1, _2))) {
+        return false;
+    }
+    if (options.flightsPerDay > 0 && options.days > 0
+        && (!runPartitions("bookings", bookingChunks, std::bind(&DatasetGenerator::loadBookings, this, _1, _2))
+            || !settleSeats(db))) {
+        return false;
+    }
+
+    if (!finishSequences(db)) {
+        return false;
+    }
+
+    qInfo().noquote() << QString("Generated %1 airports, %2 routes, %3 flights, %4 users, %5 bookings in %6 s")
+                         .arg(airports.size()).arg(routes.size())
+                         .arg(qint64(options.days) * options.flightsPerDay)
+                         .arg(options.users).arg(options.bookings - droppedBookings)
+                         .arg(timer.elapsed() / 1000.0, 0, 'f', 1);
+    return true;
+}
+
+QString DatasetGenerator::lastError() const
+{
+    QMutexLocker locker(&errorMutex);
+    return errorText;
+}
+
+void DatasetGenerator::buildNetwork()
+{
+    std::mt19937_64 random(partitionSeed(options.seed, NetworkStream, 0));
+
+    airports.clear();
+    airports.reserve(options.airports);
+    for (int i = 0; i < options.airports; i++) {
+        Airport airport;
+        airport.code = letterCode(i);
+        airport.city = QString("City %1").arg(i + 1);
+        airport.name = QString("%1 International Airport").arg(airport.city);
+        airport.country = countries[uniformInt(random, 0, int(std::size(countries)) - 1)];
+        airport.latitude = 35.0 + uniformReal(random) * 30.0;
+        airport.longitude = 20.0 + uniformReal(random) * 140.0;
+        airport.timezone = QString::asprintf("Etc/GMT%+d", -qRound(airport.longitude / 15.0));
+        airports.append(airport);
+    }
+
+    int hubCount = qBound(1, qRound(options.airports * options.hubFraction), options.airports);
+    int targetRoutes = qMax(0, options.routes);
+    QSet<quint64> used;
+
+    routes.clear();
+    routes.reserve(targetRoutes);
+
+    // Routes are appended in popularity order: trunk routes first, then feeders, then the long tail
+    auto addRoute = [&](int departure, int arrival) {
+        if (routes.size() >= targetRoutes || departure == arrival) {
+            return;
+        }
+        quint64 key = (quint64(departure) << 32) | quint32(arrival);
+        if (used.contains(key)) {
+            return;
+        }
+        used.insert(key);
+
+        const Airport &from = airports[departure];
+        const Airport &to = airports[arrival];
+        double distance = distanceKm(from.latitude, from.longitude, to.latitude, to.longitude);
+
+        Route route;
+        route.departure = departure;
+        route.arrival = arrival;
+        route.durationMinutes = 30 + qRound(distance / 13.0);
+        route.basePrice = 2000.0 + distance * 4.0;
+        routes.append(route);
+    };
+
+    for (int from = 0; from < hubCount; from++) {
+        for (int to = 0; to < hubCount; to++) {
+            addRoute(from, to);
+        }
+    }
+
+    for (int spoke = hubCount; spoke < options.airports; spoke++) {
+        int hub = uniformInt(random, 0, hubCount - 1);
+        addRoute(hub, spoke);
+        addRoute(spoke, hub);
+    }
+
+    // Point-to-point routes between popular airports
+    ZipfDistribution airportPopularity(options.airports, options.zipfExponent);
+    qint64 attempts = qint64(targetRoutes) * 20;
+    while (routes.size() < targetRoutes && attempts-- > 0) {
+        int departure = airportPopularity(random) - 1;
+        int arrival = uniformInt(random, 0, options.airports - 1);
+        addRoute(departure, arrival);
+        addRoute(arrival, departure);
+    }
+}
+
+bool DatasetGenerator::prepareTables(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+
+    if (options.reset) {
+        if (!query.exec("TRUNCATE route_day_fares, route_day_fares_pending, airport_hourly_load, seat_holds, bookings, flights, users, airlines, airports RESTART IDENTITY CASCADE")) {
+            setError(query.lastError().text());
+            return false;
+        }
+        return true;
+    }
+
+    if (!query.exec("SELECT EXISTS (SELECT 1 FROM airports) OR EXISTS (SELECT 1 FROM flights) "
+                    "OR EXISTS (SELECT 1 FROM users)") || !query.next()) {
+        setError(query.lastError().text());
+        return false;
+    }
+    if (query.value(0).toBool()) {
+        setError("Database already contains data, use reset to replace it");
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::loadReferenceData(QSqlDatabase &db)
+{
+    if (!db.transaction()) {
+        setError(db.lastError().text());
+        return false;
+    }
+
+    BulkLoader loader(db);
+
+    bool ok = loader.begin("airports", {"id", "code", "name", "city", "country", "latitude", "longitude", "timezone", "description"});
+    for (int i = 0; ok && i < airports.size(); i++) {
+        const Airport &airport = airports[i];
+        ok = loader.addRow({i + 1, airport.code, airport.name, airport.city, airport.country,
+                            airport.latitude, airport.longitude, airport.timezone,
+                            QString("Synthetic airport serving %1").arg(airport.city)});
+    }
+    ok = ok && loader.finish();
+
+    ok = ok && loader.begin("airlines", {"id", "code", "name", "country", "logo"});
+    for (int i = 0; ok && i < options.airlines; i++) {
+        ok = loader.addRow({i + 1, letterCode(i + 1), QString("Airline %1").arg(i + 1),
+                            countries[i % int(std::size(countries))], QVariant()});
+    }
+    ok = ok && loader.finish();
+
+    if (!ok || !db.commit()) {
+        setError(loader.lastError().isEmpty() ? db.lastError().text() : loader.lastError());
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::loadFlights(QSqlDatabase &db, int day)
+{
+    if (routes.isEmpty()) {
+        return true;
+    }
+
+    std::mt19937_64 random(partitionSeed(options.seed, FlightStream, day));
+    ZipfDistribution routePopularity(routes.size(), options.zipfExponent);
+
+    int hourWeightTotal = std::accumulate(std::begin(departureHourWeights), std::end(departureHourWeights), 0);
+    QDateTime midnight(options.startDate.addDays(day), QTime(0, 0));
+    qint64 firstId = qint64(day) * options.flightsPerDay + 1;
+
+    BulkLoader loader(db);
+    bool ok = loader.begin("flights", {"id", "flight_number", "airline_id", "departure_airport_id", "arrival_airport_id",
+                                       "departure_time", "arrival_time", "price_economy", "price_business", "price_first",
+                                       "available_seats_economy", "available_seats_business", "available_seats_first"});
+
+    for (int i = 0; ok && i < options.flightsPerDay; i++) {
+        int routeIndex = routePopularity(random) - 1;
+        const Route &route = routes[routeIndex];
+
+        // Pick the departure hour from the daily banks, then a five-minute slot
+        int pick = uniformInt(random, 0, hourWeightTotal - 1);
+        int hour = 0;
+        while (pick >= departureHourWeights[hour]) {
+            pick -= departureHourWeights[hour++];
+        }
+        QDateTime departureTime = midnight.addSecs(hour * 3600 + uniformInt(random, 0, 11) * 300);
+        QDateTime arrivalTime = departureTime.addSecs(route.durationMinutes * 60);
+
+        // Most flights of a route belong to its main carrier
+        int airlineId = uniformReal(random) < 0.7 ? routeIndex % options.airlines + 1
+                                                  : uniformInt(random, 1, options.airlines);
+        double basePrice = std::round(route.basePrice * (0.8 + 0.4 * uniformReal(random)));
+
+        ok = loader.addRow({firstId + i,
+                            QString("%1%2").arg(letterCode(airlineId)).arg(100 + (routeIndex * 7 + hour) % 9900),
+                            airlineId, route.departure + 1, route.arrival + 1,
+                            timestamp(departureTime), timestamp(arrivalTime),
+                            basePrice, basePrice * 2.5, basePrice * 4.0,
+                            uniformInt(random, 50, 180), uniformInt(random, 8, 30), uniformInt(random, 0, 12)});
+    }
+
+    if (!ok || !loader.finish()) {
+        setError(loader.lastError());
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::loadUsers(QSqlDatabase &db, int chunk)
+{
+    std::mt19937_64 random(partitionSeed(options.seed, UserStream, chunk));
+    QDateTime base(options.startDate, QTime(0, 0));
+    int first = chunk * rowsPerChunk;
+    int last = qMin(options.users, first + rowsPerChunk);
+
+    BulkLoader loader(db);
+    bool ok = loader.begin("users", {"id", "username", "password", "email", "full_name", "registration_date"});
+    for (int i = first; ok && i < last; i++) {
+        int id = i + 1;
+        ok = loader.addRow({id, QString("user%1").arg(id), passwordHash,
+                            QString("user%1@example.com").arg(id), QString("User %1").arg(id),
+                            timestamp(base.addSecs(-qint64(uniformInt(random, 0, 1000 * 86400))))});
+    }
+
+    if (!ok || !loader.finish()) {
+        setError(loader.lastError());
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::loadBookings(QSqlDatabase &db, int chunk)
+{
+    if (options.users < 1) {
+        return true;
+    }
+
+    std::mt19937_64 random(partitionSeed(options.seed, BookingStream, chunk));
+    ZipfDistribution userActivity(options.users, options.zipfExponent);
+
+    // Users are ranked by activity in a scattered order, not by id
+    auto userId = [this](int rank) {
+        return int((qint64(rank - 1) * 2654435761LL) % options.users) + 1;
+    };
+
+    static const char *const seatClasses[] = {"Economy", "Business", "First"};
+    int flightCount = options.days * options.flightsPerDay;
+    QDateTime base(options.startDate, QTime(0, 0));
+    int first = chunk * rowsPerChunk;
+    int last = qMin(options.bookings, first + rowsPerChunk);
+
+    BulkLoader loader(db);
+    bool ok = loader.begin("bookings", {"id", "flight_id", "user_id", "booking_date", "seat_class",
+                                        "passenger_name", "passenger_passport", "status"});
+    for (int i = first; ok && i < last; i++) {
+        int user = userId(userActivity(random));
+        double classPick = uniformReal(random);
+        int seatClass = classPick < 0.8 ? 0 : (classPick < 0.95 ? 1 : 2);
+
+        ok = loader.addRow({i + 1, uniformInt(random, 1, flightCount), user,
+                            timestamp(base.addSecs(-qint64(uniformInt(random, 0, 60 * 86400)))),
+                            seatClasses[seatClass], QString("User %1").arg(user),
+                            QString("45%1").arg(uniformInt(random, 10000000, 99999999)),
+                            uniformReal(random) < 0.97 ? "Confirmed" : "Cancelled"});
+    }
+
+    if (!ok || !loader.finish()) {
+        setError(loader.lastError());
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::settleSeats(QSqlDatabase &db)
+{
+    if (!db.transaction()) {
+        setError(db.lastError().text());
+        return false;
+    }
+
+    // Flights were loaded with their capacity; drop the bookings beyond it
+    QSqlQuery query(db);
+    bool ok = query.exec(
+        "DELETE FROM bookings b USING ("
+        "SELECT r.id FROM (SELECT id, flight_id, seat_class, "
+        "row_number() OVER (PARTITION BY flight_id, seat_class ORDER BY id) AS seat FROM bookings) r "
+        "JOIN flights f ON f.id = r.flight_id "
+        "WHERE r.seat > CASE r.seat_class WHEN 'Economy' THEN f.available_seats_economy "
+        "WHEN 'Business' THEN f.available_seats_business ELSE f.available_seats_first END"
+        ") excess WHERE b.id = excess.id");
+    droppedBookings = ok ? query.numRowsAffected() : 0;
+
+    // Whatever was booked is no longer available
+    ok = ok && query.exec(
+        "UPDATE flights f SET "
+        "available_seats_economy = f.available_seats_economy - k.economy, "
+        "available_seats_business = f.available_seats_business - k.business, "
+        "available_seats_first = f.available_seats_first - k.first "
+        "FROM (SELECT flight_id, "
+        "COUNT(*) FILTER (WHERE seat_class = 'Economy') AS economy, "
+        "COUNT(*) FILTER (WHERE seat_class = 'Business') AS business, "
+        "COUNT(*) FILTER (WHERE seat_class = 'First') AS first "
+        "FROM bookings GROUP BY flight_id) k "
+        "WHERE f.id = k.flight_id");
+
+    // The counter update only logs the route days; refresh them before the first reader
+    ok = ok && query.exec("SELECT flush_route_day_fares()");
+
+    if (!ok || !db.commit()) {
+        setError(query.lastError().text().trimmed().isEmpty() ? db.lastError().text() : query.lastError().text());
+        db.rollback();
+        return false;
+    }
+
+    if (droppedBookings > 0) {
+        qInfo().noquote() << QString("Dropped %1 bookings of sold out seat classes").arg(droppedBookings);
+    }
+    return true;
+}
+
+bool DatasetGenerator::finishSequences(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+
+    for (const char *table : {"airports", "airlines", "flights", "users", "bookings"}) {
+        QString sql = QString("SELECT setval(pg_get_serial_sequence('%1', 'id'), "
+                              "COALESCE((SELECT MAX(id) FROM %1), 0) + 1, false)").arg(table);
+        if (!query.exec(sql)) {
+            setError(query.lastError().text());
+            return false;
+        }
+    }
+
+    // Refresh planner statistics for the new data
+    if (!query.exec("ANALYZE")) {
+        setError(query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool DatasetGenerator::runPartitions(const QString &name, int count,
+                                     const std::function<bool(QSqlDatabase &, int)> &load)
+{
+    if (count <= 0) {
+        return true;
+    }
+
+    QVector<int> partitions(count);
+    std::iota(partitions.begin(), partitions.end(), 0);
+
+    QThreadPool threads;
+    threads.setMaxThreadCount(options.jobs);
+
+    std::atomic<bool> failed(false);
+    std::atomic<int> done(0);
+    QElapsedTimer timer;
+    timer.start();
+
+    QtConcurrent::blockingMap(&threads, partitions, [&](int partition) {
+        if (failed) {
+            return;
+        }
+
+        ConnectionPool::Lease lease = pool->acquire();
+        if (!lease.isValid()) {
+            setError(pool->lastError());
+            failed = true;
+            return;
+        }
+
+        QSqlDatabase db = lease.database();
+        if (!db.transaction()) {
+            setError(db.lastError().text());
+            failed = true;
+            return;
+        }
+
+        if (!load(db, partition) || !db.commit()) {
+            setError(db.lastError().text());
+            db.rollback();
+            failed = true;
+            return;
+        }
+
+        int finished = ++done;
+        if (finished == count || finished % qMax(1, count / 10) == 0) {
+            qInfo().noquote() << QString("Loaded %1: %2/%3 partitions").arg(name).arg(finished).arg(count);
+        }
+    });
+
+    if (failed) {
+        qDebug() << "Error loading" << name << ":" << lastError();
+        return false;
+    }
+
+    qInfo().noquote() << QString("Loaded %1 in %2 s").arg(name).arg(timer.elapsed() / 1000.0, 0, 'f', 1);
+    return true;
+}
+
+void DatasetGenerator::setError(const QString &error)
+{
+    QMutexLocker locker(&errorMutex);
+    if (errorText.isEmpty() && !error.trimmed().isEmpty()) {
+        errorText = error;
+    }
+}
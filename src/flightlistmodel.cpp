@@ -0,0 +1,183 @@
+#include "flightlistmodel.h"
+
+FlightListModel::FlightListModel(QObject *parent, int pageSize, int maxCachedPages)
+    : QAbstractTableModel(parent), db(Database::getInstance()),
+      pageSize(qMax(1, pageSize)), maxCachedPages(qMax(2, maxCachedPages)),
+      rows(0), atEnd(true), generation(0)
+{
+}
+
+void FlightListModel::setAirport(const QString &airportCode)
+{
+    beginResetModel();
+    this->airportCode = airportCode;
+    rows = 0;
+    atEnd = airportCode.isEmpty();
+    generation++;
+    anchors = {FlightCursor()};
+    pages.clear();
+    recentPages.clear();
+    pendingPages.clear();
+    endResetModel();
+}
+
+FlightRow FlightListModel::flightAt(int row) const
+{
+    if (row < 0 || row >= rows) {
+        return FlightRow();
+    }
+
+    const QVector<FlightRow> *page = cachedPage(row / pageSize);
+    if (!page) {
+        requestPage(row / pageSize);
+        return FlightRow();
+    }
+
+    // A reloaded page may have lost rows deleted in the meantime
+    int offset = row % pageSize;
+    return offset < page->size() ? page->at(offset) : FlightRow();
+}
+
+int FlightListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int FlightListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FlightListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    FlightRow flight = flightAt(index.row());
+    if (!flight.isValid()) {
+        return index.column() == FlightNumberColumn ? QVariant("…") : QVariant();
+    }
+
+    switch (index.column()) {
+    case FlightNumberColumn:
+        return flight.flightNumber;
+    case DestinationColumn:
+        return QString("%1 (%2)").arg(flight.arrivalCity, flight.arrivalCode);
+    case DepartureTimeColumn:
+        return flight.departureTime.toString("dd.MM.yyyy hh:mm");
+    case ArrivalTimeColumn:
+        return flight.arrivalTime.toString("dd.MM.yyyy hh:mm");
+    case SeatsColumn:
+        return flight.availableSeatsEconomy + flight.availableSeatsBusiness + flight.availableSeatsFirst;
+    }
+    return QVariant();
+}
+
+QVariant FlightListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case FlightNumberColumn:
+        return "Номер рейса";
+    case DestinationColumn:
+        return "Пункт назначения";
+    case DepartureTimeColumn:
+        return "Время отправления";
+    case ArrivalTimeColumn:
+        return "Время прибытия";
+    case SeatsColumn:
+        return "Свободных мест";
+    }
+    return QVariant();
+}
+
+bool FlightListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !atEnd;
+}
+
+void FlightListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || atEnd) {
+        return;
+    }
+
+    // The next page starts after the last row of the last full page
+    requestPage(rows / pageSize);
+}
+
+void FlightListModel::requestPage(int page) const
+{
+    if (page >= anchors.size() || pendingPages.contains(page)) {
+        return;
+    }
+    pendingPages.insert(page);
+
+    FlightListModel *self = const_cast<FlightListModel*>(this);
+    quint64 requestGeneration = generation;
+    db->getDeparturesPageAsync(airportCode, anchors[page], pageSize)
+        .then(self, [self, page, requestGeneration](const QVector<FlightRow> &flights) {
+            self->pageLoaded(page, requestGeneration, flights);
+        });
+}
+
+void FlightListModel::pageLoaded(int page, quint64 generation, const QVector<FlightRow> &flights)
+{
+    // Ignore pages of an airport that is no longer shown
+    if (generation != this->generation) {
+        return;
+    }
+    pendingPages.remove(page);
+
+    int first = page * pageSize;
+    if (first >= rows) {
+        // A new page at the end of the list
+        if (!flights.isEmpty()) {
+            beginInsertRows(QModelIndex(), rows, rows + flights.size() - 1);
+            pages.insert(page, flights);
+            recentPages.append(page);
+            rows += flights.size();
+            endInsertRows();
+        }
+
+        if (flights.size() < pageSize) {
+            atEnd = true;
+        } else {
+            const FlightRow &last = flights.last();
+            anchors.append({last.departureTime, last.id});
+        }
+    } else {
+        // A page evicted earlier; rows may have changed since, keep the row count stable
+        pages.insert(page, flights.mid(0, qMin(int(flights.size()), rows - first)));
+        recentPages.removeAll(page);
+        recentPages.append(page);
+        emit dataChanged(index(first, 0), index(qMin(rows, first + pageSize) - 1, ColumnCount - 1));
+    }
+
+    evictPages();
+}
+
+const QVector<FlightRow> *FlightListModel::cachedPage(int page) const
+{
+    auto it = pages.constFind(page);
+    if (it == pages.constEnd()) {
+        return nullptr;
+    }
+
+    if (recentPages.isEmpty() || recentPages.last() != page) {
+        recentPages.removeOne(page);
+        recentPages.append(page);
+    }
+    return &it.value();
+}
+
+void FlightListModel::evictPages()
+{
+    while (pages.size() > maxCachedPages && !recentPages.isEmpty()) {
+        pages.remove(recentPages.takeFirst());
+    }
+}
@@ -8,6 +8,7 @@
 #include <QComboBox>
 #include <QDateEdit>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QGroupBox>
 #include <QTableView>
 #include <QStandardItemModel>
@@ -27,6 +28,8 @@ FlightSearch::FlightSearch(QWidget *parent)
     // Соединение сигналов и слотов
     connect(searchButton, &QPushButton::clicked, this, &FlightSearch::searchFlights);
     connect(flightsTable, &QTableView::clicked, this, &FlightSearch::onFlightSelected);
+    connect(fareCalendarButton, &QPushButton::clicked, this, &FlightSearch::loadFareCalendar);
+    connect(fareCalendarTable, &QTableView::clicked, this, &FlightSearch::onFareDaySelected);
 }
 
 /**
@@ -60,15 +63,28 @@ void FlightSearch::setupUi()
     departureDateEdit->setDate(QDate::currentDate());
     departureDateEdit->setMinimumDate(QDate::currentDate());
     
+    connectionsCheckBox = new QCheckBox("С пересадками", searchGroup);
+    
     searchButton = new QPushButton("Найти рейсы", searchGroup);
+    fareCalendarButton = new QPushButton("Календарь цен", searchGroup);
+    
+    // Индикатор выполнения запроса (неопределенный режим)
+    searchProgress = new QProgressBar(searchGroup);
+    searchProgress->setRange(0, 0);
+    searchProgress->setTextVisible(false);
+    searchProgress->setMaximumWidth(150);
+    searchProgress->hide();
     
     // Добавление полей в компоновку формы
     searchLayout->addRow(departureLabel, departureComboBox);
     searchLayout->addRow(arrivalLabel, arrivalComboBox);
     searchLayout->addRow(departureDateLabel, departureDateEdit);
+    searchLayout->addRow("", connectionsCheckBox);
     
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     buttonLayout->addStretch();
+    buttonLayout->addWidget(searchProgress);
+    buttonLayout->addWidget(fareCalendarButton);
     buttonLayout->addWidget(searchButton);
     searchLayout->addRow("", buttonLayout);
     
@@ -84,8 +100,18 @@ void FlightSearch::setupUi()
     
     resultsLayout->addWidget(flightsTable);
     
+    // Календарь минимальных цен по дням, скрыт до первого запроса
+    fareCalendarTable = new QTableView(this);
+    fareCalendarTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    fareCalendarTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    fareCalendarTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    fareCalendarTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    fareCalendarTable->setMaximumHeight(200);
+    fareCalendarTable->hide();
+    
     // Добавление групп в основную компоновку
     mainLayout->addWidget(searchGroup);
+    mainLayout->addWidget(fareCalendarTable);
     mainLayout->addWidget(resultsGroup);
     
     // Установка компоновки
@@ -101,22 +127,19 @@ void FlightSearch::loadAirports()
     departureComboBox->clear();
     arrivalComboBox->clear();
     
-    // Загрузка аэропортов из базы данных
-    QList<QMap<QString, QVariant>> airports = db->getAllAirports();
-    
-    for (const QMap<QString, QVariant> &airport : airports) {
-        QString code = airport["code"].toString();
-        QString name = airport["name"].toString();
-        QString city = airport["city"].toString();
-        QString display = QString("%1 - %2 (%3)").arg(code).arg(name).arg(city);
+    // Асинхронная загрузка аэропортов из базы данных
+    db->getAllAirportsAsync().then(this, [this](const QVector<AirportRow> &airports) {
+        for (const AirportRow &airport : airports) {
+            QString display = QString("%1 - %2 (%3)").arg(airport.code).arg(airport.name).arg(airport.city);
+            
+            departureComboBox->addItem(display, airport.code);
+            arrivalComboBox->addItem(display, airport.code);
+        }
         
-        departureComboBox->addItem(display, code);
-        arrivalComboBox->addItem(display, code);
-    }
-    
-    // Сортировка аэропортов по алфавиту
-    departureComboBox->model()->sort(0);
-    arrivalComboBox->model()->sort(0);
+        // Сортировка аэропортов по алфавиту
+        departureComboBox->model()->sort(0);
+        arrivalComboBox->model()->sort(0);
+    });
 }
 
 /**
@@ -140,18 +163,37 @@ void FlightSearch::searchFlights()
         return;
     }
     
-    // Поиск рейсов
-    QList<QMap<QString, QVariant>> flights = db->searchFlights(departureAirport, arrivalAirport, departureDate);
+    // Поиск рейсов выполняется в пуле потоков базы данных, окно остается отзывчивым
+    searchButton->setEnabled(false);
+    searchProgress->show();
+    
+    // Маршруты с пересадками ищутся по расписанию в памяти
+    if (connectionsCheckBox->isChecked()) {
+        db->searchItinerariesAsync(departureAirport, arrivalAirport, departureDate)
+            .then(this, [this](const QVector<ItineraryRow> &itineraries) {
+                searchProgress->hide();
+                searchButton->setEnabled(true);
+                
+                displayItineraries(itineraries);
+            });
+        return;
+    }
     
-    // Отображение результатов
-    displaySearchResults(flights);
+    db->searchFlightsAsync(departureAirport, arrivalAirport, departureDate)
+        .then(this, [this](const QVector<FlightRow> &flights) {
+            searchProgress->hide();
+            searchButton->setEnabled(true);
+            
+            // Отображение результатов
+            displaySearchResults(flights);
+        });
 }
 
 /**
  * @brief Отображение результатов поиска рейсов
  * @param flights Список найденных рейсов
  */
-void FlightSearch::displaySearchResults(const QList<QMap<QString, QVariant>> &flights)
+void FlightSearch::displaySearchResults(const QVector<FlightRow> &flights)
 {
     // Создание модели для таблицы рейсов
     QStandardItemModel *model = new QStandardItemModel(0, 6, this);
@@ -160,18 +202,18 @@ void FlightSearch::displaySearchResults(const QList<QMap<QString, QVariant>> &fl
     
     // Добавление рейсов в модель
     for (int i = 0; i < flights.size(); ++i) {
-        const QMap<QString, QVariant> &flight = flights[i];
+        const FlightRow &flight = flights[i];
         
         model->insertRow(i);
-        model->setData(model->index(i, 0), flight["flight_number"]);
-        model->setData(model->index(i, 1), flight["departure_airport"]);
-        model->setData(model->index(i, 2), flight["arrival_airport"]);
-        model->setData(model->index(i, 3), QDateTime::fromString(flight["departure_time"].toString(), Qt::ISODate).toString("yyyy-MM-dd hh:mm"));
-        model->setData(model->index(i, 4), QDateTime::fromString(flight["arrival_time"].toString(), Qt::ISODate).toString("yyyy-MM-dd hh:mm"));
-        model->setData(model->index(i, 5), QString("%1 руб.").arg(flight["price"].toDouble(), 0, 'f', 2));
+        model->setData(model->index(i, 0), flight.flightNumber);
+        model->setData(model->index(i, 1), QString("%1 (%2)").arg(flight.departureCity, flight.departureCode));
+        model->setData(model->index(i, 2), QString("%1 (%2)").arg(flight.arrivalCity, flight.arrivalCode));
+        model->setData(model->index(i, 3), flight.departureTime.toString("yyyy-MM-dd hh:mm"));
+        model->setData(model->index(i, 4), flight.arrivalTime.toString("yyyy-MM-dd hh:mm"));
+        model->setData(model->index(i, 5), QString("%1 руб.").arg(flight.priceEconomy, 0, 'f', 2));
         
         // Сохранение ID рейса в пользовательской роли
-        model->setData(model->index(i, 0), flight["id"], Qt::UserRole);
+        model->setData(model->index(i, 0), flight.id, Qt::UserRole);
     }
     
     // Установка модели для табличного представления
@@ -184,6 +226,54 @@ void FlightSearch::displaySearchResults(const QList<QMap<QString, QVariant>> &fl
     }
 }
 
+/**
+ * @brief Отображение найденных маршрутов с пересадками
+ * @param itineraries Список маршрутов
+ */
+void FlightSearch::displayItineraries(const QVector<ItineraryRow> &itineraries)
+{
+    QStandardItemModel *model = new QStandardItemModel(0, 6, this);
+    model->setHorizontalHeaderLabels(QStringList() << "Рейсы" << "Маршрут" << "Пересадки"
+                                    << "Время отправления" << "Время прибытия" << "Цена");
+    
+    for (int i = 0; i < itineraries.size(); ++i) {
+        const ItineraryRow &itinerary = itineraries[i];
+        
+        QStringList flightNumbers;
+        QStringList airports;
+        for (const FlightRow &leg : itinerary.legs) {
+            flightNumbers << leg.flightNumber;
+            airports << leg.departureCode;
+        }
+        airports << itinerary.legs.last().arrivalCode;
+        
+        model->insertRow(i);
+        model->setData(model->index(i, 0), flightNumbers.join(" → "));
+        model->setData(model->index(i, 1), airports.join(" → "));
+        model->setData(model->index(i, 2), itinerary.legs.size() - 1);
+        model->setData(model->index(i, 3), itinerary.departureTime().toString("yyyy-MM-dd hh:mm"));
+        model->setData(model->index(i, 4), itinerary.arrivalTime().toString("yyyy-MM-dd hh:mm"));
+        model->setData(model->index(i, 5), QString("%1 руб.").arg(itinerary.totalPrice, 0, 'f', 2));
+        
+        // Бронирование охватывает один рейс, поэтому предлагается только для прямых маршрутов
+        if (itinerary.legs.size() == 1) {
+            model->setData(model->index(i, 0), itinerary.legs.first().id, Qt::UserRole);
+        } else {
+            for (int column = 0; column < model->columnCount(); ++column) {
+                model->setData(model->index(i, column), "Бронирование маршрутов с пересадками недоступно",
+                               Qt::ToolTipRole);
+            }
+        }
+    }
+    
+    flightsTable->setModel(model);
+    flightsTable->resizeColumnsToContents();
+    
+    if (itineraries.isEmpty()) {
+        QMessageBox::information(this, "Результаты поиска", "Не найдено маршрутов, соответствующих вашим критериям.");
+    }
+}
+
 /**
  * @brief Обработка выбора рейса в таблице
  * @param index Индекс выбранной ячейки
@@ -194,11 +284,93 @@ void FlightSearch::onFlightSelected(const QModelIndex &index)
         return;
     }
     
-    // Получение ID рейса из пользовательской роли
-    int flightId = flightsTable->model()->data(flightsTable->model()->index(index.row(), 0), Qt::UserRole).toInt();
+    // Получение ID рейса из пользовательской роли; у маршрутов с пересадками его нет
+    QVariant flightId = flightsTable->model()->data(flightsTable->model()->index(index.row(), 0), Qt::UserRole);
+    if (!flightId.isValid()) {
+        return;
+    }
     
     // Отправка сигнала с выбранным ID рейса
-    emit flightSelected(flightId);
+    emit flightSelected(flightId.toInt());
+}
+
+/**
+ * @brief Загрузка календаря цен на ±30 дней от выбранной даты
+ */
+void FlightSearch::loadFareCalendar()
+{
+    QString departureAirport = departureComboBox->currentData().toString();
+    QString arrivalAirport = arrivalComboBox->currentData().toString();
+    
+    if (departureAirport.isEmpty() || arrivalAirport.isEmpty() || departureAirport == arrivalAirport) {
+        QMessageBox::warning(this, "Ошибка поиска", "Пожалуйста, выберите разные аэропорты отправления и прибытия.");
+        return;
+    }
+    
+    fareCalendarButton->setEnabled(false);
+    
+    db->getFareCalendarAsync(departureAirport, arrivalAirport, departureDateEdit->date())
+        .then(this, [this](const QVector<FareDayRow> &days) {
+            fareCalendarButton->setEnabled(true);
+            displayFareCalendar(days);
+        });
+}
+
+/**
+ * @brief Отображение календаря цен
+ * @param days Дни с рейсами
+ */
+void FlightSearch::displayFareCalendar(const QVector<FareDayRow> &days)
+{
+    QStandardItemModel *model = new QStandardItemModel(0, 5, this);
+    model->setHorizontalHeaderLabels(QStringList() << "Дата" << "Рейсов" << "Эконом от"
+                                    << "Бизнес от" << "Первый от");
+    
+    // Цена 0 означает, что мест в классе не осталось
+    auto priceText = [](double price) {
+        return price > 0.0 ? QString("%1 руб.").arg(price, 0, 'f', 2) : QString("нет мест");
+    };
+    
+    int row = 0;
+    for (const FareDayRow &day : days) {
+        // Прошедшие дни не бронируются
+        if (day.date < QDate::currentDate()) {
+            continue;
+        }
+        
+        model->insertRow(row);
+        model->setData(model->index(row, 0), day.date.toString("yyyy-MM-dd, ddd"));
+        model->setData(model->index(row, 1), day.flightCount);
+        model->setData(model->index(row, 2), priceText(day.minPriceEconomy));
+        model->setData(model->index(row, 3), priceText(day.minPriceBusiness));
+        model->setData(model->index(row, 4), priceText(day.minPriceFirst));
+        model->setData(model->index(row, 0), day.date, Qt::UserRole);
+        row++;
+    }
+    
+    QAbstractItemModel *oldModel = fareCalendarTable->model();
+    fareCalendarTable->setModel(model);
+    delete oldModel;
+    fareCalendarTable->show();
+    
+    if (row == 0) {
+        QMessageBox::information(this, "Календарь цен", "На ближайшие дни рейсов по этому маршруту нет.");
+    }
+}
+
+/**
+ * @brief Поиск рейсов на день, выбранный в календаре цен
+ * @param index Индекс выбранной ячейки
+ */
+void FlightSearch::onFareDaySelected(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    
+    QDate date = fareCalendarTable->model()->data(fareCalendarTable->model()->index(index.row(), 0), Qt::UserRole).toDate();
+    departureDateEdit->setDate(date);
+    searchFlights();
 }
 
 /**
@@ -0,0 +1,312 @@
+#include "loadingchart.h"
+#include <QDateTime>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPolygonF>
+#include <QWheelEvent>
+#include <cmath>
+
+// Narrower bars are not readable; below this width the chart shows per-column peaks
+static const double minBarWidth = 4.0;
+
+// Fewest buckets the chart can be zoomed in to
+static const double minVisibleBuckets = 4.0;
+
+// Distance between time axis labels
+static const double labelSpacing = 100.0;
+
+static const QColor departuresColor(0x3b, 0x7d, 0xd8);
+static const QColor arrivalsColor(0xf0, 0x9a, 0x3e);
+static const QColor gridColor(0xe4, 0xe4, 0xe4);
+
+/**
+ * @brief Round a grid step up to 1, 2 or 5 times a power of ten
+ */
+static double niceStep(double rough)
+{
+    double magnitude = std::pow(10.0, std::floor(std::log10(rough)));
+    double fraction = rough / magnitude;
+    if (fraction <= 1.0) {
+        return magnitude;
+    } else if (fraction <= 2.0) {
+        return 2.0 * magnitude;
+    } else if (fraction <= 5.0) {
+        return 5.0 * magnitude;
+    }
+    return 10.0 * magnitude;
+}
+
+LoadingChartWidget::LoadingChartWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(300);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void LoadingChartWidget::setData(const QVector<AirportLoadRow> &buckets)
+{
+    starts.resize(buckets.size());
+    departures.resize(buckets.size());
+    arrivals.resize(buckets.size());
+    for (int i = 0; i < buckets.size(); i++) {
+        starts[i] = buckets[i].bucketStart.toMSecsSinceEpoch();
+        departures[i] = buckets[i].departures;
+        arrivals[i] = buckets[i].arrivals;
+    }
+    bucketMs = starts.size() > 1 ? starts[1] - starts[0] : 60 * 60 * 1000;
+
+    buildLevels();
+    viewFirst = 0.0;
+    viewCount = buckets.size();
+    cacheValid = false;
+    update();
+}
+
+int LoadingChartWidget::bucketCount() const
+{
+    return departures.size();
+}
+
+void LoadingChartWidget::buildLevels()
+{
+    levels.clear();
+    if (departures.isEmpty()) {
+        return;
+    }
+
+    QVector<Peak> level(departures.size());
+    for (int i = 0; i < departures.size(); i++) {
+        level[i].departures = departures[i];
+        level[i].total = departures[i] + arrivals[i];
+    }
+    levels.append(level);
+
+    while (levels.last().size() > 1) {
+        const QVector<Peak> &below = levels.last();
+        QVector<Peak> above((below.size() + 1) / 2);
+        for (int i = 0; i < above.size(); i++) {
+            above[i] = below[2 * i];
+            if (2 * i + 1 < below.size()) {
+                above[i].departures = qMax(above[i].departures, below[2 * i + 1].departures);
+                above[i].total = qMax(above[i].total, below[2 * i + 1].total);
+            }
+        }
+        levels.append(above);
+    }
+}
+
+LoadingChartWidget::Peak LoadingChartWidget::peak(int first, int last) const
+{
+    Peak result;
+    while (first < last) {
+        // Largest aligned block that starts here and fits into the range
+        int k = 0;
+        while (k + 1 < levels.size() && (first & ((2 << k) - 1)) == 0 && first + (2 << k) <= last) {
+            k++;
+        }
+        const Peak &block = levels[k][first >> k];
+        result.departures = qMax(result.departures, block.departures);
+        result.total = qMax(result.total, block.total);
+        first += 1 << k;
+    }
+    return result;
+}
+
+void LoadingChartWidget::setView(double first, double count)
+{
+    double buckets = departures.size();
+    count = qBound(qMin(buckets, minVisibleBuckets), count, buckets);
+    first = qBound(0.0, first, buckets - count);
+    if (first == viewFirst && count == viewCount) {
+        return;
+    }
+
+    viewFirst = first;
+    viewCount = count;
+    cacheValid = false;
+    update();
+}
+
+QRectF LoadingChartWidget::plotArea() const
+{
+    return QRectF(rect()).adjusted(50, 30, -15, -30);
+}
+
+QString LoadingChartWidget::bucketLabel(int bucket) const
+{
+    QDateTime start = QDateTime::fromMSecsSinceEpoch(starts[bucket]);
+    qint64 dayMs = 24 * 60 * 60 * 1000;
+    if (bucketMs >= dayMs) {
+        return start.toString("dd.MM");
+    } else if (viewCount * bucketMs <= 2 * dayMs) {
+        return start.toString("hh:mm");
+    }
+    return start.toString("dd.MM hh:mm");
+}
+
+void LoadingChartWidget::render()
+{
+    qreal ratio = devicePixelRatioF();
+    cache = QPixmap(size() * ratio);
+    cache.setDevicePixelRatio(ratio);
+    cache.fill(palette().color(QPalette::Base));
+    cacheValid = true;
+
+    QPainter painter(&cache);
+    QRectF plot = plotArea();
+    if (departures.isEmpty() || plot.width() < 1.0 || plot.height() < 1.0) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "Нет данных");
+        return;
+    }
+
+    int buckets = departures.size();
+    int firstBucket = int(std::floor(viewFirst));
+    int lastBucket = qMin(buckets, int(std::ceil(viewFirst + viewCount)));
+    double bucketWidth = plot.width() / viewCount;
+
+    // Vertical scale fits the visible peak
+    int visiblePeak = qMax(1, peak(firstBucket, lastBucket).total);
+    double step = niceStep(visiblePeak / 4.0);
+    double top = std::ceil(visiblePeak / step) * step;
+    auto yOf = [&](double value) { return plot.bottom() - value / top * plot.height(); };
+
+    QFontMetricsF metrics(font());
+    for (double value = 0.0; value <= top + step / 2; value += step) {
+        double y = yOf(value);
+        painter.setPen(gridColor);
+        painter.drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRectF(0, y - metrics.height() / 2, plot.left() - 6, metrics.height()),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(value));
+    }
+
+    painter.save();
+    painter.setClipRect(plot);
+    painter.setPen(Qt::NoPen);
+    if (bucketWidth >= minBarWidth) {
+        // Stacked bar per bucket
+        for (int bucket = firstBucket; bucket < lastBucket; bucket++) {
+            double x = plot.left() + (bucket - viewFirst) * bucketWidth + bucketWidth * 0.1;
+            double departuresTop = yOf(departures[bucket]);
+            double totalTop = yOf(departures[bucket] + arrivals[bucket]);
+            painter.fillRect(QRectF(x, departuresTop, bucketWidth * 0.8, plot.bottom() - departuresTop), departuresColor);
+            painter.fillRect(QRectF(x, totalTop, bucketWidth * 0.8, departuresTop - totalTop), arrivalsColor);
+        }
+    } else {
+        // Peak of the buckets under every pixel column
+        double perColumn = viewCount / plot.width();
+        QPolygonF totalArea;
+        QPolygonF departuresArea;
+        totalArea << QPointF(plot.left(), plot.bottom());
+        departuresArea << QPointF(plot.left(), plot.bottom());
+        int columns = int(std::ceil(plot.width()));
+        double x = plot.left();
+        for (int column = 0; column < columns; column++) {
+            int first = int(viewFirst + column * perColumn);
+            int last = qMin(buckets, qMax(first + 1, int(viewFirst + (column + 1) * perColumn)));
+            if (first >= buckets) {
+                break;
+            }
+            Peak columnPeak = peak(first, last);
+            x = plot.left() + column + 0.5;
+            totalArea << QPointF(x, yOf(columnPeak.total));
+            departuresArea << QPointF(x, yOf(columnPeak.departures));
+        }
+        totalArea << QPointF(x, plot.bottom());
+        departuresArea << QPointF(x, plot.bottom());
+
+        painter.setBrush(arrivalsColor);
+        painter.drawPolygon(totalArea);
+        painter.setBrush(departuresColor);
+        painter.drawPolygon(departuresArea);
+    }
+    painter.restore();
+
+    // Time axis with labels at least labelSpacing pixels apart
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawLine(plot.bottomLeft(), plot.bottomRight());
+    painter.drawLine(plot.bottomLeft(), plot.topLeft());
+    int labelEvery = qMax(1, int(std::ceil(labelSpacing / bucketWidth)));
+    for (int bucket = (firstBucket + labelEvery - 1) / labelEvery * labelEvery; bucket < lastBucket;
+         bucket += labelEvery) {
+        double x = plot.left() + (bucket - viewFirst) * bucketWidth;
+        if (x < plot.left() || x > plot.right()) {
+            continue;
+        }
+        painter.drawLine(QPointF(x, plot.bottom()), QPointF(x, plot.bottom() + 4));
+        painter.drawText(QRectF(x - labelSpacing / 2, plot.bottom() + 6, labelSpacing, metrics.height()),
+                         Qt::AlignHCenter | Qt::AlignTop, bucketLabel(bucket));
+    }
+
+    // Legend
+    double legendX = plot.right() - 180;
+    double legendY = 8;
+    painter.fillRect(QRectF(legendX, legendY + 2, 12, 12), departuresColor);
+    painter.drawText(QPointF(legendX + 18, legendY + 12), "Вылеты");
+    painter.fillRect(QRectF(legendX + 90, legendY + 2, 12, 12), arrivalsColor);
+    painter.drawText(QPointF(legendX + 108, legendY + 12), "Прилеты");
+}
+
+void LoadingChartWidget::paintEvent(QPaintEvent *)
+{
+    if (!cacheValid || cache.size() != size() * devicePixelRatioF()) {
+        render();
+    }
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, cache);
+}
+
+void LoadingChartWidget::resizeEvent(QResizeEvent *event)
+{
+    cacheValid = false;
+    QWidget::resizeEvent(event);
+}
+
+void LoadingChartWidget::wheelEvent(QWheelEvent *event)
+{
+    QRectF plot = plotArea();
+    if (departures.isEmpty() || plot.width() < 1.0) {
+        return;
+    }
+
+    // Keep the bucket under the cursor in place
+    double steps = event->angleDelta().y() / 120.0;
+    double offset = qBound(0.0, (event->position().x() - plot.left()) / plot.width(), 1.0);
+    double anchor = viewFirst + offset * viewCount;
+    double count = viewCount * std::pow(0.8, steps);
+    count = qBound(qMin(double(departures.size()), minVisibleBuckets), count, double(departures.size()));
+    setView(anchor - offset * count, count);
+    event->accept();
+}
+
+void LoadingChartWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        dragX = event->position().x();
+        dragFirst = viewFirst;
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void LoadingChartWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    QRectF plot = plotArea();
+    if (dragging && plot.width() >= 1.0) {
+        setView(dragFirst - (event->position().x() - dragX) / plot.width() * viewCount, viewCount);
+    }
+}
+
+void LoadingChartWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = false;
+        unsetCursor();
+    }
+}
+
+void LoadingChartWidget::mouseDoubleClickEvent(QMouseEvent *)
+{
+    setView(0.0, departures.size());
+}
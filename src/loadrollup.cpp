@@ -0,0 +1,93 @@
+#include "loadrollup.h"
+#include <QDateTime>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+// Differing hours described in a check report
+static const int maxReportedSamples = 20;
+
+LoadRollup::LoadRollup(const QSqlDatabase &db)
+    : db(db)
+{
+}
+
+bool LoadRollup::rebuild()
+{
+    QSqlQuery query(db);
+    if (!db.transaction()) {
+        errorText = db.lastError().text();
+        return false;
+    }
+
+    // SHARE mode conflicts with every writer but not with readers of the rollup
+    bool ok = query.exec("LOCK TABLE flights, bookings IN SHARE MODE")
+        && query.exec("DELETE FROM airport_hourly_load")
+        && query.exec("INSERT INTO airport_hourly_load (airport_id, hour_bucket, departures, arrivals, seats_sold) "
+                      "SELECT * FROM airport_hourly_load_source()");
+    if (!ok) {
+        errorText = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        errorText = db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool LoadRollup::check(Report *report)
+{
+    *report = Report();
+
+    QSqlQuery query(db);
+    if (!db.transaction()) {
+        errorText = db.lastError().text();
+        return false;
+    }
+
+    // Both sides must come from the same snapshot or concurrent writes show up as drift
+    bool ok = query.exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ READ ONLY")
+        && query.exec("SELECT COUNT(*) FROM airport_hourly_load") && query.next();
+    if (ok) {
+        report->rows = query.value(0).toLongLong();
+        ok = query.exec(
+            "SELECT COALESCE(l.airport_id, s.airport_id), COALESCE(l.hour_bucket, s.hour_bucket), "
+            "COALESCE(l.departures, 0), COALESCE(s.departures, 0), "
+            "COALESCE(l.arrivals, 0), COALESCE(s.arrivals, 0), "
+            "COALESCE(l.seats_sold, 0), COALESCE(s.seats_sold, 0) "
+            "FROM airport_hourly_load l FULL JOIN airport_hourly_load_source() s "
+            "ON s.airport_id = l.airport_id AND s.hour_bucket = l.hour_bucket "
+            "WHERE (COALESCE(l.departures, 0), COALESCE(l.arrivals, 0), COALESCE(l.seats_sold, 0)) "
+            "IS DISTINCT FROM (COALESCE(s.departures, 0), COALESCE(s.arrivals, 0), COALESCE(s.seats_sold, 0)) "
+            "ORDER BY 1, 2");
+    }
+    if (!ok) {
+        errorText = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    while (query.next()) {
+        report->mismatches++;
+        if (report->samples.size() < maxReportedSamples) {
+            report->samples.append(QString("airport %1 at %2: departures %3/%4, arrivals %5/%6, seats sold %7/%8")
+                                   .arg(query.value(0).toInt())
+                                   .arg(query.value(1).toDateTime().toString(Qt::ISODate))
+                                   .arg(query.value(2).toInt()).arg(query.value(3).toInt())
+                                   .arg(query.value(4).toInt()).arg(query.value(5).toInt())
+                                   .arg(query.value(6).toInt()).arg(query.value(7).toInt()));
+        }
+    }
+    query.finish();
+    db.commit();
+    return true;
+}
+
+QString LoadRollup::lastError() const
+{
+    return errorText;
+}
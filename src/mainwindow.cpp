@@ -19,7 +19,7 @@
  * @param parent Родительский виджет
  */
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), currentUserId(-1), airportLoadingPage(nullptr)
+    : QMainWindow(parent), airportLoadingPage(nullptr), networkLoadPage(nullptr)
 {
     // Инициализация базы данных
     db = Database::getInstance();
@@ -28,6 +28,12 @@ MainWindow::MainWindow(QWidget *parent)
         exit(1);
     }
     
+    // Прямые рейсы ищутся в расписании в памяти; свободные места в нем отстают не более чем на минуту
+    db->setTimetableEnabled(true);
+    
+    // Сессии пользователей: пароль проверяется один раз при входе
+    sessions = new SessionManager(db);
+    
     // Настройка пользовательского интерфейса
     setupUi();
     
@@ -44,6 +50,8 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     // Нет необходимости удалять указатель ui, так как мы его не используем
+    delete networkLoadPage;
+    delete sessions;
 }
 
 /**
@@ -235,18 +243,21 @@ void MainWindow::createCentralWidget()
     QPushButton *bookButton = new QPushButton("Забронировать билет", buttonsGroupBox);
     QPushButton *viewAirportInfoButton = new QPushButton("Информация об аэропорте", buttonsGroupBox);
     QPushButton *viewAirportLoadingButton = new QPushButton("Загруженность аэропорта", buttonsGroupBox);
+    QPushButton *viewNetworkLoadingButton = new QPushButton("Загруженность сети", buttonsGroupBox);
     QPushButton *viewProfileButton = new QPushButton("Профиль пользователя", buttonsGroupBox);
     
     searchButton->setIcon(QIcon(":/icons/search.png"));
     bookButton->setIcon(QIcon(":/icons/ticket.png"));
     viewAirportInfoButton->setIcon(QIcon(":/icons/airport.png"));
     viewAirportLoadingButton->setIcon(QIcon(":/icons/airport.png"));
+    viewNetworkLoadingButton->setIcon(QIcon(":/icons/airport.png"));
     viewProfileButton->setIcon(QIcon(":/icons/user.png"));
     
     buttonsLayout->addWidget(searchButton);
     buttonsLayout->addWidget(bookButton);
     buttonsLayout->addWidget(viewAirportInfoButton);
     buttonsLayout->addWidget(viewAirportLoadingButton);
+    buttonsLayout->addWidget(viewNetworkLoadingButton);
     buttonsLayout->addWidget(viewProfileButton);
     
     // Добавление групповых боксов в правую часть
@@ -281,30 +292,36 @@ void MainWindow::createCentralWidget()
     
     // Подключение сигналов кнопок к слотам
     connect(searchButton, &QPushButton::clicked, [=]() {
-        QString departureAirport = departureAirportComboBox->currentText();
-        QString arrivalAirport = arrivalAirportComboBox->currentText();
+        QString departureAirport = departureAirportComboBox->currentData().toString();
+        QString arrivalAirport = arrivalAirportComboBox->currentData().toString();
         QDate departureDate = departureDateEdit->date();
         
         // Очистка таблицы
         flightsTable->setRowCount(0);
         
-        // Получение списка рейсов
-        QList<QMap<QString, QVariant>> flights = db->searchFlights(departureAirport, arrivalAirport, departureDate);
-        
-        // Заполнение таблицы
-        for (const QMap<QString, QVariant> &flight : flights) {
-            int row = flightsTable->rowCount();
-            flightsTable->insertRow(row);
-            
-            flightsTable->setItem(row, 0, new QTableWidgetItem(QString::number(flight["id"].toInt())));
-            flightsTable->setItem(row, 1, new QTableWidgetItem(flight["flight_number"].toString()));
-            flightsTable->setItem(row, 2, new QTableWidgetItem(flight["departure_city"].toString()));
-            flightsTable->setItem(row, 3, new QTableWidgetItem(flight["arrival_city"].toString()));
-            flightsTable->setItem(row, 4, new QTableWidgetItem(flight["departure_date"].toDate().toString("dd.MM.yyyy")));
-            flightsTable->setItem(row, 5, new QTableWidgetItem(flight["departure_time"].toTime().toString("hh:mm")));
-        }
+        // Асинхронный поиск рейсов, окно продолжает перерисовываться
+        searchButton->setEnabled(false);
+        statusLabel->setText("Поиск рейсов...");
         
-        statusLabel->setText("Найдено рейсов: " + QString::number(flights.size()));
+        db->searchFlightsAsync(departureAirport, arrivalAirport, departureDate)
+            .then(this, [=](const QVector<FlightRow> &flights) {
+                searchButton->setEnabled(true);
+                
+                // Заполнение таблицы
+                for (const FlightRow &flight : flights) {
+                    int row = flightsTable->rowCount();
+                    flightsTable->insertRow(row);
+                    
+                    flightsTable->setItem(row, 0, new QTableWidgetItem(QString::number(flight.id)));
+                    flightsTable->setItem(row, 1, new QTableWidgetItem(flight.flightNumber));
+                    flightsTable->setItem(row, 2, new QTableWidgetItem(flight.departureCity));
+                    flightsTable->setItem(row, 3, new QTableWidgetItem(flight.arrivalCity));
+                    flightsTable->setItem(row, 4, new QTableWidgetItem(flight.departureTime.date().toString("dd.MM.yyyy")));
+                    flightsTable->setItem(row, 5, new QTableWidgetItem(flight.departureTime.time().toString("hh:mm")));
+                }
+                
+                statusLabel->setText("Найдено рейсов: " + QString::number(flights.size()));
+            });
     });
     
     connect(bookButton, &QPushButton::clicked, [=]() {
@@ -322,16 +339,18 @@ void MainWindow::createCentralWidget()
     connect(viewAirportInfoButton, &QPushButton::clicked, this, &MainWindow::showAirportInfo);
     
     connect(viewAirportLoadingButton, &QPushButton::clicked, this, &MainWindow::showAirportLoading);
+    connect(viewNetworkLoadingButton, &QPushButton::clicked, this, &MainWindow::showNetworkLoading);
     
     connect(viewProfileButton, &QPushButton::clicked, this, &MainWindow::showUserProfile);
     
-    // Заполнение комбобоксов аэропортов
-    QList<QMap<QString, QVariant>> airports = db->getAllAirports();
-    for (const QMap<QString, QVariant> &airport : airports) {
-        QString airportName = airport["name"].toString() + " (" + airport["code"].toString() + ")";
-        departureAirportComboBox->addItem(airportName, airport["code"]);
-        arrivalAirportComboBox->addItem(airportName, airport["code"]);
-    }
+    // Асинхронное заполнение комбобоксов аэропортов
+    db->getAllAirportsAsync().then(this, [=](const QVector<AirportRow> &airports) {
+        for (const AirportRow &airport : airports) {
+            QString airportName = airport.name + " (" + airport.code + ")";
+            departureAirportComboBox->addItem(airportName, airport.code);
+            arrivalAirportComboBox->addItem(airportName, airport.code);
+        }
+    });
     
     // Добавление страниц в стековый виджет
     stackedWidget->addWidget(loginPage);
@@ -343,6 +362,11 @@ void MainWindow::createCentralWidget()
     ticketBookingPage = new TicketBooking(nullptr);
     userProfilePage = new UserProfile(nullptr);
     
+    // Изменения профиля попадают в кэш сессий
+    connect(userProfilePage, &UserProfile::profileLoaded, this, [this](const UserProfileRow &profile) {
+        sessions->updateProfile(profile);
+    });
+    
     // Добавление стекового виджета в основную компоновку
     mainLayout->addWidget(stackedWidget);
 }
@@ -407,7 +431,7 @@ void MainWindow::showUserProfile()
     layout->addWidget(userProfilePage);
     
     // Установка ID пользователя
-    userProfilePage->setUserId(currentUserId);
+    userProfilePage->setUserId(sessions->userId(currentToken));
     
     // Загрузка профиля пользователя
     userProfilePage->loadUserProfile();
@@ -468,15 +492,18 @@ void MainWindow::showLoginDialog()
             return;
         }
         
-        // Проверка учетных данных
-        int userId = db->authenticateUser(username, password);
-        if (userId >= 0) {
-            // Вход успешен
-            onUserLoggedIn(userId);
-            loginDialog.accept();
-        } else {
-            QMessageBox::warning(&loginDialog, "Ошибка входа", "Неверное имя пользователя или пароль.");
-        }
+        // Проверка учетных данных и открытие сессии в фоне: хеширование пароля намеренно медленное
+        loginButton->setEnabled(false);
+        sessions->loginAsync(username, password).then(&loginDialog, [&, loginButton](const QString &token) {
+            loginButton->setEnabled(true);
+            if (!token.isEmpty()) {
+                // Вход успешен
+                onUserLoggedIn(token);
+                loginDialog.accept();
+            } else {
+                QMessageBox::warning(&loginDialog, "Ошибка входа", "Неверное имя пользователя или пароль.");
+            }
+        });
     });
     
     connect(cancelButton, &QPushButton::clicked, &loginDialog, &QDialog::reject);
@@ -541,14 +568,17 @@ void MainWindow::showRegistrationDialog()
             return;
         }
         
-        // Регистрация пользователя
-        int userId = db->registerUser(username, password, email, fullName);
-        if (userId >= 0) {
-            QMessageBox::information(&registerDialog, "Регистрация", "Регистрация успешна. Теперь вы можете войти.");
-            registerDialog.accept();
-        } else {
-            QMessageBox::warning(&registerDialog, "Ошибка регистрации", "Не удалось зарегистрировать пользователя. Возможно, имя пользователя уже существует.");
-        }
+        // Регистрация пользователя в фоне
+        registerButton->setEnabled(false);
+        db->registerUserAsync(username, password, email, fullName).then(&registerDialog, [&, registerButton](int userId) {
+            registerButton->setEnabled(true);
+            if (userId >= 0) {
+                QMessageBox::information(&registerDialog, "Регистрация", "Регистрация успешна. Теперь вы можете войти.");
+                registerDialog.accept();
+            } else {
+                QMessageBox::warning(&registerDialog, "Ошибка регистрации", "Не удалось зарегистрировать пользователя. Возможно, имя пользователя уже существует.");
+            }
+        });
     });
     
     connect(cancelButton, &QPushButton::clicked, &registerDialog, &QDialog::reject);
@@ -561,9 +591,9 @@ void MainWindow::showRegistrationDialog()
  */
 void MainWindow::logout()
 {
-    // Выход пользователя
-    currentUserId = -1;
-    currentUsername = "";
+    // Закрытие сессии пользователя
+    sessions->logout(currentToken);
+    currentToken.clear();
     
     // Обновление интерфейса
     updateLoginStatus();
@@ -581,10 +611,11 @@ void MainWindow::logout()
 void MainWindow::updateLoginStatus()
 {
     // Обновление интерфейса на основе статуса входа
-    if (currentUserId > 0) {
+    UserProfileRow user = sessions->user(currentToken);
+    if (user.isValid()) {
         // Пользователь вошел в систему
         stackedWidget->setCurrentIndex(1);
-        statusLabel->setText("Вход выполнен как " + currentUsername);
+        statusLabel->setText("Вход выполнен как " + user.username);
     } else {
         // Пользователь не вошел в систему
         stackedWidget->setCurrentIndex(0);
@@ -594,16 +625,16 @@ void MainWindow::updateLoginStatus()
 
 /**
  * @brief Обработка входа пользователя
- * @param userId ID пользователя
+ * @param token Токен сессии
  */
-void MainWindow::onUserLoggedIn(int userId)
+void MainWindow::onUserLoggedIn(const QString &token)
 {
-    // Установка текущего пользователя
-    currentUserId = userId;
+    // Установка текущей сессии
+    currentToken = token;
     
-    // Получение имени пользователя
-    QMap<QString, QVariant> userProfile = db->getUserProfile(userId);
-    currentUsername = userProfile["username"].toString();
+    // Профиль уже загружен при входе и хранится в сессии
+    UserProfileRow userProfile = sessions->user(token);
+    int userId = userProfile.id;
     
     // Обновление интерфейса
     updateLoginStatus();
@@ -616,7 +647,7 @@ void MainWindow::onUserLoggedIn(int userId)
     showFlightSearch();
     
     // Обновление строки состояния
-    statusLabel->setText("Вход выполнен как " + currentUsername);
+    statusLabel->setText("Вход выполнен как " + userProfile.username);
 }
 
 /**
@@ -737,4 +768,35 @@ void MainWindow::showAirportLoading()
     
     // Отображение диалога
     loadingDialog.exec();
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief Показать загруженность всех аэропортов сети
+ */
+void MainWindow::showNetworkLoading()
+{
+    // Создание диалога загруженности сети
+    QDialog loadingDialog(this);
+    loadingDialog.setWindowTitle("Загруженность сети");
+    loadingDialog.setMinimumSize(1000, 700);
+    
+    QVBoxLayout *layout = new QVBoxLayout(&loadingDialog);
+    
+    // Виджет переживает диалог, чтобы следующий показ пересчитывал только изменившиеся аэропорты
+    if (!networkLoadPage) {
+        networkLoadPage = new NetworkLoadWidget(nullptr);
+    }
+    layout->addWidget(networkLoadPage);
+    
+    // Подключение сигнала закрытия
+    QMetaObject::Connection closeConnection =
+        connect(networkLoadPage, &NetworkLoadWidget::closeRequested, &loadingDialog, &QDialog::accept);
+    
+    // Отображение диалога
+    loadingDialog.exec();
+    
+    // Виджет забирается из диалога до его удаления
+    disconnect(closeConnection);
+    layout->removeWidget(networkLoadPage);
+    networkLoadPage->setParent(nullptr);
+}
@@ -0,0 +1,182 @@
+#include "movementindex.h"
+#include <QReadLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QWriteLocker>
+
+// Julian day of 1970-01-01, timestamps are read as seconds of the wall clock since then
+static const qint64 unixEpochJulianDay = 2440588;
+static const int minutesPerDay = 1440;
+
+MovementIndex::MovementIndex(int airportId, const QDate &firstDay, int days)
+    : airport(airportId)
+    , first(firstDay)
+    , dayCount(qMax(0, days))
+    , departureTree(dayCount * minutesPerDay + 1, 0)
+    , arrivalTree(dayCount * minutesPerDay + 1, 0)
+{
+}
+
+QSharedPointer<MovementIndex> MovementIndex::load(const QSqlDatabase &db, int airportId, const QDate &firstDay,
+                                                  int days, QString *error)
+{
+    QSharedPointer<MovementIndex> index(new MovementIndex(airportId, firstDay, days));
+    QString from = firstDay.startOfDay().toString(Qt::ISODate);
+    QString to = firstDay.addDays(index->dayCount).startOfDay().toString(Qt::ISODate);
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // Times are read as wall-clock seconds to avoid parsing a QDateTime per row
+    query.prepare("SELECT 0, CAST(EXTRACT(EPOCH FROM f.departure_time) AS BIGINT) FROM flights f "
+                  "WHERE f.departure_airport_id = ? "
+                  "AND f.departure_time >= CAST(? AS TIMESTAMP) AND f.departure_time < CAST(? AS TIMESTAMP) "
+                  "UNION ALL "
+                  "SELECT 1, CAST(EXTRACT(EPOCH FROM f.arrival_time) AS BIGINT) FROM flights f "
+                  "WHERE f.arrival_airport_id = ? "
+                  "AND f.arrival_time >= CAST(? AS TIMESTAMP) AND f.arrival_time < CAST(? AS TIMESTAMP)");
+    for (int i = 0; i < 2; i++) {
+        query.addBindValue(airportId);
+        query.addBindValue(from);
+        query.addBindValue(to);
+    }
+    if (!query.exec()) {
+        *error = query.lastError().text();
+        return QSharedPointer<MovementIndex>();
+    }
+
+    // Count per minute first, then fold the counts into trees in one pass
+    qint64 origin = (firstDay.toJulianDay() - unixEpochJulianDay) * minutesPerDay * 60;
+    int minutes = index->dayCount * minutesPerDay;
+    while (query.next()) {
+        qint64 minute = (query.value(1).toLongLong() - origin) / 60;
+        if (minute < 0 || minute >= minutes) {
+            continue;
+        }
+        QVector<qint32> &tree = query.value(0).toInt() == 0 ? index->departureTree : index->arrivalTree;
+        tree[int(minute) + 1]++;
+    }
+    buildTree(index->departureTree);
+    buildTree(index->arrivalTree);
+    return index;
+}
+
+int MovementIndex::airportId() const
+{
+    return airport;
+}
+
+QDate MovementIndex::firstDay() const
+{
+    return first;
+}
+
+int MovementIndex::days() const
+{
+    return dayCount;
+}
+
+MovementCount MovementIndex::count(const QDateTime &from, const QDateTime &to) const
+{
+    MovementCount result;
+    int minutes = dayCount * minutesPerDay;
+    int begin = int(qBound(qint64(0), minuteOf(from), qint64(minutes)));
+    int end = int(qBound(qint64(0), minuteOf(to), qint64(minutes)));
+    if (begin >= end) {
+        return result;
+    }
+
+    QReadLocker locker(&lock);
+    result.departures = prefix(departureTree, end) - prefix(departureTree, begin);
+    result.arrivals = prefix(arrivalTree, end) - prefix(arrivalTree, begin);
+    return result;
+}
+
+MovementCount MovementIndex::countRecurring(const QDate &firstDay, const QDate &lastDay, const QTime &start,
+                                            const QTime &end, int weekdays) const
+{
+    MovementCount result;
+    int minutes = dayCount * minutesPerDay;
+    int startMinute = start.hour() * 60 + start.minute();
+    int endMinute = end.hour() * 60 + end.minute();
+    if (endMinute <= startMinute) {
+        endMinute += minutesPerDay;
+    }
+
+    QDate day = qMax(firstDay, first.addDays(-1));
+    QDate last = qMin(lastDay, first.addDays(dayCount - 1));
+
+    QReadLocker locker(&lock);
+    for (; day <= last; day = day.addDays(1)) {
+        if (!(weekdays & (1 << day.dayOfWeek()))) {
+            continue;
+        }
+        qint64 dayMinute = (day.toJulianDay() - first.toJulianDay()) * minutesPerDay;
+        int begin = int(qBound(qint64(0), dayMinute + startMinute, qint64(minutes)));
+        int stop = int(qBound(qint64(0), dayMinute + endMinute, qint64(minutes)));
+        if (begin < stop) {
+            result.departures += prefix(departureTree, stop) - prefix(departureTree, begin);
+            result.arrivals += prefix(arrivalTree, stop) - prefix(arrivalTree, begin);
+        }
+    }
+    return result;
+}
+
+void MovementIndex::addDeparture(const QDateTime &time, int delta)
+{
+    qint64 minute = minuteOf(time);
+    if (minute < 0 || minute >= qint64(dayCount) * minutesPerDay) {
+        return;
+    }
+
+    QWriteLocker locker(&lock);
+    add(departureTree, int(minute), delta);
+}
+
+void MovementIndex::addArrival(const QDateTime &time, int delta)
+{
+    qint64 minute = minuteOf(time);
+    if (minute < 0 || minute >= qint64(dayCount) * minutesPerDay) {
+        return;
+    }
+
+    QWriteLocker locker(&lock);
+    add(arrivalTree, int(minute), delta);
+}
+
+qint64 MovementIndex::minuteOf(const QDateTime &time) const
+{
+    // Wall-clock minutes, so days around a DST change keep 1440 minutes like the stored times
+    return (time.date().toJulianDay() - first.toJulianDay()) * minutesPerDay
+        + time.time().hour() * 60 + time.time().minute();
+}
+
+void MovementIndex::buildTree(QVector<qint32> &tree)
+{
+    int size = tree.size() - 1;
+    for (int i = 1; i <= size; i++) {
+        int parent = i + (i & -i);
+        if (parent <= size) {
+            tree[parent] += tree[i];
+        }
+    }
+}
+
+qint32 MovementIndex::prefix(const QVector<qint32> &tree, int minutes)
+{
+    qint32 sum = 0;
+    for (int i = minutes; i > 0; i -= i & -i) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void MovementIndex::add(QVector<qint32> &tree, int minute, int delta)
+{
+    int size = tree.size() - 1;
+    for (int i = minute + 1; i <= size; i += i & -i) {
+        tree[i] += delta;
+    }
+}
@@ -0,0 +1,290 @@
+#include "networkdashboard.h"
+#include <QHeaderView>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QSplitter>
+
+// Период автообновления, мс
+static const int autoRefreshInterval = 30000;
+
+/**
+ * @brief Конструктор
+ * @param parent Родительский виджет
+ */
+NetworkLoadWidget::NetworkLoadWidget(QWidget *parent)
+    : QWidget(parent), analyzer(new NetworkLoadAnalyzer), refreshing(false), refreshPending(false)
+{
+    // Получение экземпляра базы данных
+    db = Database::getInstance();
+
+    // Настройка пользовательского интерфейса
+    setupUi();
+}
+
+/**
+ * @brief Деструктор
+ */
+NetworkLoadWidget::~NetworkLoadWidget()
+{
+    // Дочерние виджеты удаляются автоматически, расчет освобождается последним владельцем
+}
+
+/**
+ * @brief Настройка пользовательского интерфейса
+ */
+void NetworkLoadWidget::setupUi()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(10, 10, 10, 10);
+    mainLayout->setSpacing(10);
+
+    // Заголовок
+    QLabel *titleLabel = new QLabel("Загруженность аэропортов сети", this);
+    QFont titleFont = titleLabel->font();
+    titleFont.setPointSize(14);
+    titleFont.setBold(true);
+    titleLabel->setFont(titleFont);
+    titleLabel->setAlignment(Qt::AlignCenter);
+    titleLabel->setStyleSheet("background-color: #e0e0e0; padding: 10px; border-radius: 5px;");
+    mainLayout->addWidget(titleLabel);
+
+    // Выбор периода, пропускной способности и обновления
+    QHBoxLayout *controlsLayout = new QHBoxLayout();
+    dateEdit = new QDateEdit(QDate::currentDate(), this);
+    dateEdit->setCalendarPopup(true);
+    dateEdit->setDisplayFormat("dd.MM.yyyy");
+
+    periodComboBox = new QComboBox(this);
+    periodComboBox->addItem("Сутки", 1);
+    periodComboBox->addItem("Неделя", 7);
+    periodComboBox->addItem("Месяц", 30);
+
+    capacitySpinBox = new QSpinBox(this);
+    capacitySpinBox->setRange(0, 1000);
+    capacitySpinBox->setValue(40);
+    capacitySpinBox->setSuffix(" рейсов/ч");
+    capacitySpinBox->setSpecialValueText("не задана");
+
+    autoRefreshCheckBox = new QCheckBox("Автообновление", this);
+    refreshButton = new QPushButton("Обновить", this);
+
+    controlsLayout->addWidget(new QLabel("Дата:", this));
+    controlsLayout->addWidget(dateEdit);
+    controlsLayout->addSpacing(20);
+    controlsLayout->addWidget(new QLabel("Период:", this));
+    controlsLayout->addWidget(periodComboBox);
+    controlsLayout->addSpacing(20);
+    controlsLayout->addWidget(new QLabel("Пропускная способность:", this));
+    controlsLayout->addWidget(capacitySpinBox);
+    controlsLayout->addStretch();
+    controlsLayout->addWidget(autoRefreshCheckBox);
+    controlsLayout->addWidget(refreshButton);
+    mainLayout->addLayout(controlsLayout);
+
+    // Таблица аэропортов, по умолчанию самые загруженные сверху
+    model = new NetworkLoadModel(this);
+    proxyModel = new QSortFilterProxyModel(this);
+    proxyModel->setSourceModel(model);
+    proxyModel->setSortRole(NetworkLoadModel::SortRole);
+
+    tableView = new QTableView(this);
+    tableView->setModel(proxyModel);
+    tableView->setSortingEnabled(true);
+    tableView->sortByColumn(NetworkLoadModel::UtilizationColumn, Qt::DescendingOrder);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    tableView->horizontalHeader()->setSectionResizeMode(NetworkLoadModel::AirportColumn, QHeaderView::Stretch);
+    tableView->verticalHeader()->hide();
+
+    // Гистограмма по часам суток выбранного аэропорта или всей сети
+    QWidget *histogramPanel = new QWidget(this);
+    QVBoxLayout *histogramLayout = new QVBoxLayout(histogramPanel);
+    histogramLayout->setContentsMargins(0, 0, 0, 0);
+    histogramLabel = new QLabel(histogramPanel);
+    histogramLabel->setAlignment(Qt::AlignCenter);
+    histogramLabel->setStyleSheet("font-size: 12pt; color: #555;");
+    histogramWidget = new LoadingChartWidget(histogramPanel);
+    histogramWidget->setMinimumHeight(200);
+    histogramLayout->addWidget(histogramLabel);
+    histogramLayout->addWidget(histogramWidget, 1);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(tableView);
+    splitter->addWidget(histogramPanel);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+    mainLayout->addWidget(splitter, 1);
+
+    // Строка состояния и кнопка выхода
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    statusLabel = new QLabel(this);
+    statusLabel->setStyleSheet("color: #555;");
+    closeButton = new QPushButton("Закрыть", this);
+    closeButton->setMinimumWidth(100);
+    buttonLayout->addWidget(statusLabel);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(autoRefreshInterval);
+
+    // Подключение сигналов
+    connect(closeButton, &QPushButton::clicked, this, &NetworkLoadWidget::onCloseButtonClicked);
+    connect(refreshButton, &QPushButton::clicked, this, &NetworkLoadWidget::refresh);
+    connect(refreshTimer, &QTimer::timeout, this, &NetworkLoadWidget::refresh);
+    connect(autoRefreshCheckBox, &QCheckBox::toggled, this, &NetworkLoadWidget::onAutoRefreshToggled);
+    connect(dateEdit, &QDateEdit::dateChanged, this, &NetworkLoadWidget::refresh);
+    connect(periodComboBox, &QComboBox::currentIndexChanged, this, &NetworkLoadWidget::refresh);
+    connect(capacitySpinBox, &QSpinBox::valueChanged, this, &NetworkLoadWidget::refresh);
+    connect(tableView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &NetworkLoadWidget::updateHistogram);
+
+    setMinimumSize(900, 650);
+}
+
+/**
+ * @brief Пересчитать показатели всех аэропортов
+ */
+void NetworkLoadWidget::refresh()
+{
+    // Одновременно выполняется один пересчет, изменения за время расчета дают еще один
+    if (refreshing) {
+        refreshPending = true;
+        return;
+    }
+    refreshing = true;
+
+    // Список аэропортов берется из кэша справочных данных
+    if (airportCodes.isEmpty()) {
+        QHash<QString, QString> names;
+        const QVector<AirportRow> airports = db->getAllAirports();
+        for (const AirportRow &airport : airports) {
+            airportCodes.append(airport.code);
+            names.insert(airport.code, airport.name);
+        }
+        model->setAirportNames(names);
+    }
+
+    QDateTime from(dateEdit->date(), QTime(0, 0));
+    QDateTime to = from.addDays(periodComboBox->currentData().toInt());
+    int hours = int(from.secsTo(to) / 3600);
+    analyzer->setCapacity(capacitySpinBox->value());
+
+    statusLabel->setText("Обновление...");
+    QSharedPointer<NetworkLoadAnalyzer> analysis = analyzer;
+    QStringList codes = airportCodes;
+
+    // Почасовые данные читаются из свертки, показатели считаются параллельно по аэропортам
+    db->getNetworkLoadingAsync(from, to, 60)
+        .then(QtFuture::Launch::Async, [analysis, codes, from, hours](const QVector<AirportLoadRow> &buckets) {
+            return analysis->analyze(codes, from, hours, buckets);
+        })
+        .then(this, [this](const NetworkLoadReport &report) {
+            refreshing = false;
+            showReport(report);
+            if (refreshPending) {
+                refreshPending = false;
+                refresh();
+            }
+        });
+}
+
+/**
+ * @brief Показать результат пересчета
+ * @param report Показатели аэропортов
+ */
+void NetworkLoadWidget::showReport(const NetworkLoadReport &report)
+{
+    model->setReport(report);
+    updateHistogram();
+
+    int overloaded = 0;
+    for (const AirportLoadSummary &airport : report.airports) {
+        if (airport.hoursOverCapacity > 0) {
+            overloaded++;
+        }
+    }
+    statusLabel->setText(QString("Аэропортов: %1, пересчитано: %2 за %3 мс, с превышением нормы: %4. Обновлено в %5")
+                         .arg(report.airports.size()).arg(report.changed.size()).arg(report.elapsedMs)
+                         .arg(overloaded).arg(QTime::currentTime().toString("hh:mm:ss")));
+}
+
+/**
+ * @brief Показать почасовую гистограмму выбранного аэропорта или всей сети
+ */
+void NetworkLoadWidget::updateHistogram()
+{
+    const NetworkLoadReport &report = model->report();
+    if (report.hourlyDepartures.isEmpty()) {
+        histogramWidget->setData(QVector<AirportLoadRow>());
+        return;
+    }
+
+    const QVector<int> *departures = &report.hourlyDepartures;
+    const QVector<int> *arrivals = &report.hourlyArrivals;
+    QString title = "Вся сеть";
+
+    QModelIndex current = proxyModel->mapToSource(tableView->currentIndex());
+    if (current.isValid() && current.row() < report.airports.size()) {
+        const AirportLoadSummary &airport = report.airports[current.row()];
+        departures = &airport.hourlyDepartures;
+        arrivals = &airport.hourlyArrivals;
+        title = model->data(model->index(current.row(), NetworkLoadModel::AirportColumn)).toString();
+    }
+
+    // Одна полоса на час суток, суммы за весь период
+    QVector<AirportLoadRow> hours(departures->size());
+    for (int hour = 0; hour < hours.size(); hour++) {
+        hours[hour].bucketStart = QDateTime(report.from.date(), QTime(hour, 0));
+        hours[hour].departures = departures->at(hour);
+        hours[hour].arrivals = arrivals->at(hour);
+    }
+    histogramWidget->setData(hours);
+    histogramLabel->setText("Вылеты и прилеты по часам суток: " + title);
+}
+
+/**
+ * @brief Пересчитать данные при каждом показе виджета
+ */
+void NetworkLoadWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    if (autoRefreshCheckBox->isChecked()) {
+        refreshTimer->start();
+    }
+}
+
+/**
+ * @brief Остановить автообновление скрытого виджета
+ */
+void NetworkLoadWidget::hideEvent(QHideEvent *event)
+{
+    refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+/**
+ * @brief Включить или выключить автообновление
+ * @param enabled Автообновление включено
+ */
+void NetworkLoadWidget::onAutoRefreshToggled(bool enabled)
+{
+    if (enabled) {
+        refreshTimer->start();
+    } else {
+        refreshTimer->stop();
+    }
+}
+
+/**
+ * @brief Обработчик нажатия кнопки выхода
+ */
+void NetworkLoadWidget::onCloseButtonClicked()
+{
+    // Отправка сигнала о закрытии
+    emit closeRequested();
+}
@@ -0,0 +1,149 @@
+#include "networkload.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+
+static const int hoursPerDay = 24;
+
+NetworkLoadAnalyzer::NetworkLoadAnalyzer(int maxThreads)
+{
+    pool.setMaxThreadCount(maxThreads > 0 ? maxThreads : QThread::idealThreadCount());
+}
+
+NetworkLoadAnalyzer::~NetworkLoadAnalyzer()
+{
+    pool.waitForDone();
+}
+
+void NetworkLoadAnalyzer::setCapacity(int movementsPerHour, const QHash<QString, int> &overrides)
+{
+    QMutexLocker locker(&mutex);
+    if (movementsPerHour == defaultCapacity && overrides == capacities) {
+        return;
+    }
+    defaultCapacity = movementsPerHour;
+    capacities = overrides;
+    capacityChanged = true;
+}
+
+NetworkLoadReport NetworkLoadAnalyzer::analyze(const QStringList &airportCodes, const QDateTime &from, int hours,
+                                               const QVector<AirportLoadRow> &buckets)
+{
+    QMutexLocker locker(&mutex);
+    QElapsedTimer timer;
+    timer.start();
+
+    NetworkLoadReport report;
+    report.from = from;
+    report.hours = hours;
+
+    // Summaries of another period or capacity are of no use
+    if (capacityChanged || from != lastFrom || hours != lastHours) {
+        checksums.clear();
+        summaries.clear();
+        capacityChanged = false;
+        lastFrom = from;
+        lastHours = hours;
+    }
+    report.reset = summaries.isEmpty() || airportCodes != lastCodes;
+    lastCodes = airportCodes;
+
+    // Buckets are ordered by airport, so every partition is a slice of them
+    QHash<QString, Partition> slices;
+    for (int i = 0; i < buckets.size();) {
+        Partition slice;
+        slice.airportCode = buckets[i].airportCode;
+        slice.rows = buckets.constData() + i;
+        size_t checksum = 0;
+        for (; i < buckets.size() && buckets[i].airportCode == slice.airportCode; i++) {
+            checksum = qHashMulti(checksum, buckets[i].bucketStart.toSecsSinceEpoch(),
+                                  buckets[i].departures, buckets[i].arrivals);
+            slice.count++;
+        }
+        slice.checksum = checksum;
+        slices.insert(slice.airportCode, slice);
+    }
+
+    QVector<Partition> changedPartitions;
+    for (const QString &code : airportCodes) {
+        Partition partition = slices.value(code);
+        partition.airportCode = code;
+        auto cached = checksums.constFind(code);
+        if (cached == checksums.constEnd() || cached.value() != partition.checksum) {
+            changedPartitions.append(partition);
+        }
+    }
+
+    // Map every changed airport to its summary, reduce them into one list
+    auto summarizeOne = [this, from](const Partition &partition) {
+        return summarize(partition, from, capacityOf(partition.airportCode));
+    };
+    auto collect = [](QVector<AirportLoadSummary> &all, const AirportLoadSummary &summary) {
+        all.append(summary);
+    };
+    QVector<AirportLoadSummary> recomputed = QtConcurrent::blockingMappedReduced<QVector<AirportLoadSummary>>(
+        &pool, changedPartitions, summarizeOne, collect, QtConcurrent::UnorderedReduce);
+
+    for (const Partition &partition : std::as_const(changedPartitions)) {
+        checksums.insert(partition.airportCode, partition.checksum);
+    }
+    for (const AirportLoadSummary &summary : std::as_const(recomputed)) {
+        summaries.insert(summary.airportCode, summary);
+    }
+
+    report.hourlyDepartures.fill(0, hoursPerDay);
+    report.hourlyArrivals.fill(0, hoursPerDay);
+    report.airports.reserve(airportCodes.size());
+    QSet<QString> changedCodes;
+    for (const Partition &partition : std::as_const(changedPartitions)) {
+        changedCodes.insert(partition.airportCode);
+    }
+    for (const QString &code : airportCodes) {
+        const AirportLoadSummary &summary = *summaries.constFind(code);
+        for (int hour = 0; hour < hoursPerDay; hour++) {
+            report.hourlyDepartures[hour] += summary.hourlyDepartures[hour];
+            report.hourlyArrivals[hour] += summary.hourlyArrivals[hour];
+        }
+        if (report.reset || changedCodes.contains(code)) {
+            report.changed.append(report.airports.size());
+        }
+        report.airports.append(summary);
+    }
+
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
+
+AirportLoadSummary NetworkLoadAnalyzer::summarize(const Partition &partition, const QDateTime &from, int capacity)
+{
+    AirportLoadSummary summary;
+    summary.airportCode = partition.airportCode;
+    summary.capacity = capacity;
+    summary.hourlyDepartures.fill(0, hoursPerDay);
+    summary.hourlyArrivals.fill(0, hoursPerDay);
+    summary.peakStart = from;
+
+    for (int i = 0; i < partition.count; i++) {
+        const AirportLoadRow &bucket = partition.rows[i];
+        int hour = bucket.bucketStart.time().hour();
+        summary.departures += bucket.departures;
+        summary.arrivals += bucket.arrivals;
+        summary.hourlyDepartures[hour] += bucket.departures;
+        summary.hourlyArrivals[hour] += bucket.arrivals;
+        if (bucket.movements() > summary.peakMovements) {
+            summary.peakMovements = bucket.movements();
+            summary.peakStart = bucket.bucketStart;
+        }
+        if (capacity > 0 && bucket.movements() > capacity) {
+            summary.hoursOverCapacity++;
+        }
+    }
+    return summary;
+}
+
+int NetworkLoadAnalyzer::capacityOf(const QString &airportCode) const
+{
+    return capacities.value(airportCode, defaultCapacity);
+}
@@ -0,0 +1,130 @@
+#include "networkloadmodel.h"
+#include <QColor>
+
+// Utilization from which a busiest hour is highlighted as close to capacity
+static const double busyUtilization = 0.8;
+
+NetworkLoadModel::NetworkLoadModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void NetworkLoadModel::setReport(const NetworkLoadReport &report)
+{
+    if (report.reset || report.airports.size() != current.airports.size()) {
+        beginResetModel();
+        current = report;
+        endResetModel();
+        return;
+    }
+
+    current = report;
+    for (int row : std::as_const(current.changed)) {
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    }
+}
+
+const NetworkLoadReport &NetworkLoadModel::report() const
+{
+    return current;
+}
+
+void NetworkLoadModel::setAirportNames(const QHash<QString, QString> &names)
+{
+    airportNames = names;
+    if (!current.airports.isEmpty()) {
+        emit dataChanged(index(0, AirportColumn), index(current.airports.size() - 1, AirportColumn));
+    }
+}
+
+int NetworkLoadModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : current.airports.size();
+}
+
+int NetworkLoadModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant NetworkLoadModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= current.airports.size()) {
+        return QVariant();
+    }
+
+    const AirportLoadSummary &airport = current.airports[index.row()];
+    if (role == Qt::BackgroundRole && index.column() == UtilizationColumn && airport.capacity > 0) {
+        if (airport.peakUtilization() > 1.0) {
+            return QColor(0xf4, 0xc7, 0xc3);
+        } else if (airport.peakUtilization() >= busyUtilization) {
+            return QColor(0xfc, 0xe8, 0xb2);
+        }
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole && role != SortRole) {
+        return QVariant();
+    }
+
+    bool display = role == Qt::DisplayRole;
+    switch (index.column()) {
+    case AirportColumn: {
+        QString name = airportNames.value(airport.airportCode);
+        if (!display || name.isEmpty()) {
+            return airport.airportCode;
+        }
+        return QString("%1 (%2)").arg(name, airport.airportCode);
+    }
+    case DeparturesColumn:
+        return airport.departures;
+    case ArrivalsColumn:
+        return airport.arrivals;
+    case PeakColumn:
+        return airport.peakMovements;
+    case PeakTimeColumn:
+        if (!display) {
+            return airport.peakStart;
+        }
+        return airport.peakMovements > 0 ? airport.peakStart.toString("dd.MM.yyyy hh:mm") : QString();
+    case CapacityColumn:
+        if (display && airport.capacity <= 0) {
+            return QString();
+        }
+        return airport.capacity;
+    case UtilizationColumn:
+        if (!display) {
+            return airport.peakUtilization();
+        }
+        return airport.capacity > 0 ? QString("%1%").arg(qRound(airport.peakUtilization() * 100)) : QString();
+    case OverCapacityColumn:
+        return airport.hoursOverCapacity;
+    }
+    return QVariant();
+}
+
+QVariant NetworkLoadModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case AirportColumn:
+        return "Аэропорт";
+    case DeparturesColumn:
+        return "Вылеты";
+    case ArrivalsColumn:
+        return "Прилеты";
+    case PeakColumn:
+        return "Пик, рейсов/ч";
+    case PeakTimeColumn:
+        return "Час пик";
+    case CapacityColumn:
+        return "Пропускная способность";
+    case UtilizationColumn:
+        return "Загрузка в пик";
+    case OverCapacityColumn:
+        return "Часов сверх нормы";
+    }
+    return QVariant();
+}
@@ -0,0 +1,156 @@
+#include "passwordhasher.h"
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QtConcurrent>
+#include <QtEndian>
+
+static const char *const hashScheme = "pbkdf2_sha256";
+static const int saltBytes = 16;
+static const int keyBytes = 32;
+
+// Hex digits of the unsalted SHA-256 digests stored by older versions
+static const int legacyDigestLength = 64;
+
+/**
+ * @brief Derive a key with PBKDF2-HMAC-SHA256 (RFC 8018)
+ */
+static QByteArray pbkdf2(const QByteArray &password, const QByteArray &salt, int iterations)
+{
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    QByteArray key;
+    for (quint32 block = 1; key.size() < keyBytes; block++) {
+        char index[4];
+        qToBigEndian(block, index);
+
+        mac.reset();
+        mac.addData(salt);
+        mac.addData(index, sizeof(index));
+        QByteArray u = mac.result();
+        QByteArray t = u;
+        for (int i = 1; i < iterations; i++) {
+            mac.reset();
+            mac.addData(u);
+            u = mac.result();
+            for (int j = 0; j < t.size(); j++) {
+                t[j] = char(t[j] ^ u[j]);
+            }
+        }
+        key += t;
+    }
+    key.truncate(keyBytes);
+    return key;
+}
+
+/**
+ * @brief Compare two byte strings in time independent of where they differ
+ */
+static bool constantTimeEquals(const QByteArray &a, const QByteArray &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    char difference = 0;
+    for (int i = 0; i < a.size(); i++) {
+        difference |= char(a[i] ^ b[i]);
+    }
+    return difference == 0;
+}
+
+/**
+ * @brief Split an encoded PBKDF2 hash into its parts
+ * @return False for legacy digests and malformed hashes
+ */
+static bool parseHash(const QString &stored, int *iterations, QByteArray *salt, QByteArray *key)
+{
+    QStringList parts = stored.split('$');
+    if (parts.size() != 4 || parts[0] != QLatin1String(hashScheme)) {
+        return false;
+    }
+
+    bool ok = false;
+    *iterations = parts[1].toInt(&ok);
+    *salt = QByteArray::fromBase64(parts[2].toLatin1());
+    *key = QByteArray::fromBase64(parts[3].toLatin1());
+    return ok && *iterations > 0 && !salt->isEmpty() && key->size() == keyBytes;
+}
+
+PasswordHasher::PasswordHasher(int iterations, int maxThreads)
+    : cost(qMax(1, iterations))
+{
+    pool.setMaxThreadCount(maxThreads > 0 ? maxThreads : qMax(1, QThread::idealThreadCount() / 2));
+}
+
+PasswordHasher::~PasswordHasher()
+{
+    pool.waitForDone();
+}
+
+void PasswordHasher::setIterations(int iterations)
+{
+    cost = qMax(1, iterations);
+}
+
+int PasswordHasher::iterations() const
+{
+    return cost;
+}
+
+QFuture<QString> PasswordHasher::hash(const QString &password)
+{
+    int iterations = cost;
+    return QtConcurrent::run(&pool, [password, iterations]() {
+        return hashPassword(password, iterations);
+    });
+}
+
+QFuture<bool> PasswordHasher::verify(const QString &password, const QString &stored)
+{
+    return QtConcurrent::run(&pool, [password, stored]() {
+        return verifyPassword(password, stored);
+    });
+}
+
+QFuture<bool> PasswordHasher::verifyDummy(const QString &password)
+{
+    int iterations = cost;
+    return QtConcurrent::run(&pool, [password, iterations]() {
+        hashPassword(password, iterations);
+        return false;
+    });
+}
+
+bool PasswordHasher::needsRehash(const QString &stored) const
+{
+    int iterations = 0;
+    QByteArray salt;
+    QByteArray key;
+    return !parseHash(stored, &iterations, &salt, &key) || iterations < cost;
+}
+
+QString PasswordHasher::hashPassword(const QString &password, int iterations)
+{
+    QByteArray salt(saltBytes, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(salt.data()), saltBytes / sizeof(quint32));
+    QByteArray key = pbkdf2(password.toUtf8(), salt, iterations);
+
+    return QString("%1$%2$%3$%4").arg(QString::fromLatin1(hashScheme)).arg(iterations)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(key.toBase64()));
+}
+
+bool PasswordHasher::verifyPassword(const QString &password, const QString &stored)
+{
+    int iterations = 0;
+    QByteArray salt;
+    QByteArray key;
+    if (parseHash(stored, &iterations, &salt, &key)) {
+        return constantTimeEquals(pbkdf2(password.toUtf8(), salt, iterations), key);
+    }
+
+    if (stored.size() == legacyDigestLength) {
+        QByteArray digest = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+        return constantTimeEquals(digest, stored.toLatin1());
+    }
+    return false;
+}
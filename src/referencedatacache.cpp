@@ -0,0 +1,103 @@
+#include "referencedatacache.h"
+#include <QMutexLocker>
+
+ReferenceData::ReferenceData(const QVector<AirportRow> &airports, const QVector<AirlineRow> &airlines)
+    : airportRows(airports), airlineRows(airlines), loadTime(QDateTime::currentDateTime())
+{
+    airportIds.reserve(airportRows.size());
+    airportCodes.reserve(airportRows.size());
+    for (int i = 0; i < airportRows.size(); i++) {
+        const AirportRow &airport = airportRows[i];
+        airportIds.insert(airport.id, i);
+        airportCodes.insert(airport.code, i);
+        airportCities[airport.city].append(i);
+    }
+
+    airlineIds.reserve(airlineRows.size());
+    airlineCodes.reserve(airlineRows.size());
+    for (int i = 0; i < airlineRows.size(); i++) {
+        airlineIds.insert(airlineRows[i].id, i);
+        airlineCodes.insert(airlineRows[i].code, i);
+    }
+}
+
+const QVector<AirportRow> &ReferenceData::airports() const
+{
+    return airportRows;
+}
+
+const QVector<AirlineRow> &ReferenceData::airlines() const
+{
+    return airlineRows;
+}
+
+const AirportRow *ReferenceData::airportById(int id) const
+{
+    auto it = airportIds.constFind(id);
+    return it != airportIds.constEnd() ? &airportRows[it.value()] : nullptr;
+}
+
+const AirportRow *ReferenceData::airportByCode(const QString &code) const
+{
+    auto it = airportCodes.constFind(code);
+    return it != airportCodes.constEnd() ? &airportRows[it.value()] : nullptr;
+}
+
+QVector<int> ReferenceData::airportsInCity(const QString &city) const
+{
+    return airportCities.value(city);
+}
+
+QVector<int> ReferenceData::resolveAirportIds(const QString &cityOrCode) const
+{
+    QVector<int> ids;
+    for (int index : airportCities.value(cityOrCode)) {
+        ids.append(airportRows[index].id);
+    }
+
+    const AirportRow *airport = airportByCode(cityOrCode);
+    if (airport && !ids.contains(airport->id)) {
+        ids.append(airport->id);
+    }
+    return ids;
+}
+
+const AirlineRow *ReferenceData::airlineById(int id) const
+{
+    auto it = airlineIds.constFind(id);
+    return it != airlineIds.constEnd() ? &airlineRows[it.value()] : nullptr;
+}
+
+const AirlineRow *ReferenceData::airlineByCode(const QString &code) const
+{
+    auto it = airlineCodes.constFind(code);
+    return it != airlineCodes.constEnd() ? &airlineRows[it.value()] : nullptr;
+}
+
+QDateTime ReferenceData::loadedAt() const
+{
+    return loadTime;
+}
+
+QSharedPointer<const ReferenceData> ReferenceDataCache::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+QSharedPointer<const ReferenceData> ReferenceDataCache::replace(const QVector<AirportRow> &airports,
+                                                                const QVector<AirlineRow> &airlines)
+{
+    // Build the indexes outside the lock, readers keep the old snapshot meanwhile
+    QSharedPointer<const ReferenceData> data(new ReferenceData(airports, airlines));
+
+    QMutexLocker locker(&mutex);
+    current = data;
+    return data;
+}
+
+void ReferenceDataCache::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    current.reset();
+}
@@ -0,0 +1,547 @@
+#include "schemamigrator.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+// Advisory lock key shared by all clients migrating the same database
+static const qint64 migrationLockKey = 0x41495343484D41LL;
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase &db)
+    : db(db)
+{
+}
+
+const QVector<SchemaMigration> &SchemaMigrator::migrations()
+{
+    static const QVector<SchemaMigration> list = {
+        {
+            1, "Initial schema",
+            {
+                "CREATE TABLE IF NOT EXISTS airports ("
+                "id SERIAL PRIMARY KEY, "
+                "code TEXT NOT NULL UNIQUE, "
+                "name TEXT NOT NULL, "
+                "city TEXT NOT NULL, "
+                "country TEXT NOT NULL, "
+                "latitude REAL, "
+                "longitude REAL, "
+                "timezone TEXT, "
+                "description TEXT)",
+
+                "CREATE TABLE IF NOT EXISTS airlines ("
+                "id SERIAL PRIMARY KEY, "
+                "code TEXT NOT NULL UNIQUE, "
+                "name TEXT NOT NULL, "
+                "country TEXT NOT NULL, "
+                "logo TEXT)",
+
+                "CREATE TABLE IF NOT EXISTS flights ("
+                "id SERIAL PRIMARY KEY, "
+                "flight_number TEXT NOT NULL, "
+                "airline_id INTEGER NOT NULL REFERENCES airlines(id), "
+                "departure_airport_id INTEGER NOT NULL REFERENCES airports(id), "
+                "arrival_airport_id INTEGER NOT NULL REFERENCES airports(id), "
+                "departure_time TIMESTAMP NOT NULL, "
+                "arrival_time TIMESTAMP NOT NULL, "
+                "price_economy REAL NOT NULL, "
+                "price_business REAL NOT NULL, "
+                "price_first REAL NOT NULL, "
+                "available_seats_economy INTEGER NOT NULL, "
+                "available_seats_business INTEGER NOT NULL, "
+                "available_seats_first INTEGER NOT NULL)",
+
+                "CREATE TABLE IF NOT EXISTS users ("
+                "id SERIAL PRIMARY KEY, "
+                "username TEXT NOT NULL UNIQUE, "
+                "password TEXT NOT NULL, "
+                "email TEXT NOT NULL, "
+                "full_name TEXT NOT NULL, "
+                "registration_date TIMESTAMP NOT NULL)",
+
+                "CREATE TABLE IF NOT EXISTS bookings ("
+                "id SERIAL PRIMARY KEY, "
+                "flight_id INTEGER NOT NULL REFERENCES flights(id), "
+                "user_id INTEGER NOT NULL REFERENCES users(id), "
+                "booking_date TIMESTAMP NOT NULL, "
+                "seat_class TEXT NOT NULL, "
+                "passenger_name TEXT NOT NULL, "
+                "passenger_passport TEXT NOT NULL, "
+                "status TEXT NOT NULL)"
+            }
+        },
+        {
+            2, "Secondary indexes for flight search and bookings",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_flights_route_departure "
+                "ON flights (departure_airport_id, arrival_airport_id, departure_time)",
+
+                "CREATE INDEX IF NOT EXISTS idx_bookings_user ON bookings (user_id)",
+
+                "CREATE INDEX IF NOT EXISTS idx_airports_city ON airports (city)"
+            }
+        },
+        {
+            3, "Keyset index for airport departure lists",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_flights_departure_airport "
+                "ON flights (departure_airport_id, departure_time, id)"
+            }
+        },
+        {
+            4, "Per-route daily fare summary for the fare calendar",
+            {
+                "CREATE TABLE IF NOT EXISTS route_day_fares ("
+                "departure_airport_id INTEGER NOT NULL, "
+                "arrival_airport_id INTEGER NOT NULL, "
+                "flight_date DATE NOT NULL, "
+                "flight_count INTEGER NOT NULL DEFAULT 0, "
+                "min_price_economy REAL, "
+                "min_price_business REAL, "
+                "min_price_first REAL, "
+                "seats_economy INTEGER NOT NULL DEFAULT 0, "
+                "seats_business INTEGER NOT NULL DEFAULT 0, "
+                "seats_first INTEGER NOT NULL DEFAULT 0, "
+                "PRIMARY KEY (departure_airport_id, arrival_airport_id, flight_date))",
+
+                // Recomputes the summary rows of the given route days. The rows are
+                // created and locked first, so concurrent writers to the same route day
+                // take turns and each aggregates over the other's committed flights.
+                // Route days that lose all flights keep a row with flight_count = 0.
+                "CREATE OR REPLACE FUNCTION refresh_route_day_fares(deps INTEGER[], arrs INTEGER[], days DATE[]) "
+                "RETURNS void LANGUAGE plpgsql AS $$ "
+                "BEGIN "
+                "INSERT INTO route_day_fares (departure_airport_id, arrival_airport_id, flight_date) "
+                "SELECT DISTINCT k.dep, k.arr, k.day FROM unnest(deps, arrs, days) AS k(dep, arr, day) "
+                "ORDER BY 1, 2, 3 ON CONFLICT DO NOTHING; "
+                "PERFORM 1 FROM route_day_fares r "
+                "JOIN unnest(deps, arrs, days) AS k(dep, arr, day) "
+                "ON r.departure_airport_id = k.dep AND r.arrival_airport_id = k.arr AND r.flight_date = k.day "
+                "ORDER BY r.departure_airport_id, r.arrival_airport_id, r.flight_date FOR UPDATE OF r; "
+                "UPDATE route_day_fares r SET "
+                "flight_count = a.flight_count, "
+                "min_price_economy = a.min_price_economy, "
+                "min_price_business = a.min_price_business, "
+                "min_price_first = a.min_price_first, "
+                "seats_economy = a.seats_economy, "
+                "seats_business = a.seats_business, "
+                "seats_first = a.seats_first "
+                "FROM (SELECT DISTINCT k.dep, k.arr, k.day FROM unnest(deps, arrs, days) AS k(dep, arr, day)) k "
+                "CROSS JOIN LATERAL (SELECT COUNT(*) AS flight_count, "
+                "MIN(f.price_economy) FILTER (WHERE f.available_seats_economy > 0) AS min_price_economy, "
+                "MIN(f.price_business) FILTER (WHERE f.available_seats_business > 0) AS min_price_business, "
+                "MIN(f.price_first) FILTER (WHERE f.available_seats_first > 0) AS min_price_first, "
+                "COALESCE(SUM(f.available_seats_economy), 0) AS seats_economy, "
+                "COALESCE(SUM(f.available_seats_business), 0) AS seats_business, "
+                "COALESCE(SUM(f.available_seats_first), 0) AS seats_first "
+                "FROM flights f WHERE f.departure_airport_id = k.dep AND f.arrival_airport_id = k.arr "
+                "AND f.departure_time >= k.day AND f.departure_time < k.day + 1) a "
+                "WHERE r.departure_airport_id = k.dep AND r.arrival_airport_id = k.arr AND r.flight_date = k.day; "
+                "END $$",
+
+                // Statement-level, so a bulk COPY refreshes each touched route day once
+                "CREATE OR REPLACE FUNCTION route_day_fares_trigger() "
+                "RETURNS trigger LANGUAGE plpgsql AS $$ "
+                "DECLARE deps INTEGER[]; arrs INTEGER[]; days DATE[]; "
+                "BEGIN "
+                "IF TG_OP = 'INSERT' THEN "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT DISTINCT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) "
+                "FROM new_rows) AS k(dep, arr, day); "
+                "ELSIF TG_OP = 'DELETE' THEN "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT DISTINCT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) "
+                "FROM old_rows) AS k(dep, arr, day); "
+                "ELSE "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) FROM new_rows "
+                "UNION SELECT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) FROM old_rows) "
+                "AS k(dep, arr, day); "
+                "END IF; "
+                "IF deps IS NOT NULL THEN "
+                "PERFORM refresh_route_day_fares(deps, arrs, days); "
+                "END IF; "
+                "RETURN NULL; "
+                "END $$",
+
+                "CREATE TRIGGER flights_route_day_fares_insert AFTER INSERT ON flights "
+                "REFERENCING NEW TABLE AS new_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION route_day_fares_trigger()",
+
+                "CREATE TRIGGER flights_route_day_fares_update AFTER UPDATE ON flights "
+                "REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION route_day_fares_trigger()",
+
+                "CREATE TRIGGER flights_route_day_fares_delete AFTER DELETE ON flights "
+                "REFERENCING OLD TABLE AS old_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION route_day_fares_trigger()",
+
+                "INSERT INTO route_day_fares (departure_airport_id, arrival_airport_id, flight_date, flight_count, "
+                "min_price_economy, min_price_business, min_price_first, seats_economy, seats_business, seats_first) "
+                "SELECT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE), COUNT(*), "
+                "MIN(price_economy) FILTER (WHERE available_seats_economy > 0), "
+                "MIN(price_business) FILTER (WHERE available_seats_business > 0), "
+                "MIN(price_first) FILTER (WHERE available_seats_first > 0), "
+                "SUM(available_seats_economy), SUM(available_seats_business), SUM(available_seats_first) "
+                "FROM flights GROUP BY 1, 2, 3 "
+                "ON CONFLICT DO NOTHING"
+            }
+        },
+        {
+            5, "Seat counters never go negative",
+            {
+                // Older clients could oversell; clamp before adding the constraint
+                "UPDATE flights SET "
+                "available_seats_economy = GREATEST(available_seats_economy, 0), "
+                "available_seats_business = GREATEST(available_seats_business, 0), "
+                "available_seats_first = GREATEST(available_seats_first, 0) "
+                "WHERE available_seats_economy < 0 OR available_seats_business < 0 OR available_seats_first < 0",
+
+                "ALTER TABLE flights ADD CONSTRAINT flights_available_seats_check "
+                "CHECK (available_seats_economy >= 0 AND available_seats_business >= 0 AND available_seats_first >= 0)"
+            }
+        },
+        {
+            6, "Time-limited seat holds",
+            {
+                "CREATE TABLE IF NOT EXISTS seat_holds ("
+                "id BIGSERIAL PRIMARY KEY, "
+                "flight_id INTEGER NOT NULL REFERENCES flights(id), "
+                "user_id INTEGER NOT NULL REFERENCES users(id), "
+                "seat_class TEXT NOT NULL, "
+                "seats INTEGER NOT NULL CHECK (seats > 0), "
+                "expires_at TIMESTAMP NOT NULL)",
+
+                "CREATE INDEX IF NOT EXISTS idx_seat_holds_expires ON seat_holds (expires_at)"
+            }
+        },
+        {
+            7, "Arrival time index for airport loading",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_flights_arrival_airport "
+                "ON flights (arrival_airport_id, arrival_time)"
+            }
+        },
+        {
+            8, "Hourly airport loading rollup",
+            {
+                "CREATE INDEX IF NOT EXISTS idx_bookings_flight ON bookings (flight_id)",
+
+                "CREATE TABLE IF NOT EXISTS airport_hourly_load ("
+                "airport_id INTEGER NOT NULL, "
+                "hour_bucket TIMESTAMP NOT NULL, "
+                "departures INTEGER NOT NULL DEFAULT 0, "
+                "arrivals INTEGER NOT NULL DEFAULT 0, "
+                "seats_sold INTEGER NOT NULL DEFAULT 0, "
+                "PRIMARY KEY (airport_id, hour_bucket))",
+
+                // The rollup as computed from scratch; used by the backfill, rebuilds and checks.
+                // Seats sold count the bookings of the flights departing or arriving in the hour.
+                "CREATE OR REPLACE FUNCTION airport_hourly_load_source() "
+                "RETURNS TABLE (airport_id INTEGER, hour_bucket TIMESTAMP, "
+                "departures INTEGER, arrivals INTEGER, seats_sold INTEGER) "
+                "LANGUAGE sql STABLE AS $$ "
+                "WITH booked AS (SELECT b.flight_id, COUNT(*) AS seats FROM bookings b GROUP BY b.flight_id), "
+                "movements AS (SELECT f.departure_airport_id AS airport_id, "
+                "date_trunc('hour', f.departure_time) AS hour_bucket, 1 AS departures, 0 AS arrivals, "
+                "COALESCE(k.seats, 0) AS seats FROM flights f LEFT JOIN booked k ON k.flight_id = f.id "
+                "UNION ALL "
+                "SELECT f.arrival_airport_id, date_trunc('hour', f.arrival_time), 0, 1, COALESCE(k.seats, 0) "
+                "FROM flights f LEFT JOIN booked k ON k.flight_id = f.id) "
+                "SELECT m.airport_id, m.hour_bucket, CAST(SUM(m.departures) AS INTEGER), "
+                "CAST(SUM(m.arrivals) AS INTEGER), CAST(SUM(m.seats) AS INTEGER) "
+                "FROM movements m GROUP BY m.airport_id, m.hour_bucket $$",
+
+                // Adds deltas to the rollup in key order, so concurrent writers lock rows
+                // in the same order. Hours that lose all movements keep a row of zeros.
+                "CREATE OR REPLACE FUNCTION add_airport_hourly_load(airports INTEGER[], hours TIMESTAMP[], "
+                "departures INTEGER[], arrivals INTEGER[], seats INTEGER[]) "
+                "RETURNS void LANGUAGE plpgsql AS $$ "
+                "BEGIN "
+                "INSERT INTO airport_hourly_load AS l (airport_id, hour_bucket, departures, arrivals, seats_sold) "
+                "SELECT d.airport_id, d.hour_bucket, SUM(d.departures), SUM(d.arrivals), SUM(d.seats) "
+                "FROM unnest(airports, hours, departures, arrivals, seats) "
+                "AS d(airport_id, hour_bucket, departures, arrivals, seats) "
+                "GROUP BY d.airport_id, d.hour_bucket ORDER BY d.airport_id, d.hour_bucket "
+                "ON CONFLICT (airport_id, hour_bucket) DO UPDATE SET "
+                "departures = l.departures + EXCLUDED.departures, "
+                "arrivals = l.arrivals + EXCLUDED.arrivals, "
+                "seats_sold = l.seats_sold + EXCLUDED.seats_sold; "
+                "END $$",
+
+                // Flights count where and when they depart and arrive. Updates only move
+                // counts for flights whose airports or times changed, so seat counter
+                // updates of the booking path cost an empty join.
+                "CREATE OR REPLACE FUNCTION airport_hourly_load_flights_trigger() "
+                "RETURNS trigger LANGUAGE plpgsql AS $$ "
+                "DECLARE airports INTEGER[]; hours TIMESTAMP[]; deps INTEGER[]; arrs INTEGER[]; seats INTEGER[]; "
+                "BEGIN "
+                "IF TG_OP = 'INSERT' THEN "
+                "SELECT array_agg(d.a), array_agg(d.h), array_agg(d.dep), array_agg(d.arr), array_agg(d.s) "
+                "INTO airports, hours, deps, arrs, seats FROM ("
+                "SELECT departure_airport_id, date_trunc('hour', departure_time), 1, 0, 0 FROM new_rows "
+                "UNION ALL SELECT arrival_airport_id, date_trunc('hour', arrival_time), 0, 1, 0 FROM new_rows"
+                ") AS d(a, h, dep, arr, s); "
+                "ELSIF TG_OP = 'DELETE' THEN "
+                // Bookings reference their flight, so deleted flights have none left
+                "SELECT array_agg(d.a), array_agg(d.h), array_agg(d.dep), array_agg(d.arr), array_agg(d.s) "
+                "INTO airports, hours, deps, arrs, seats FROM ("
+                "SELECT departure_airport_id, date_trunc('hour', departure_time), -1, 0, 0 FROM old_rows "
+                "UNION ALL SELECT arrival_airport_id, date_trunc('hour', arrival_time), 0, -1, 0 FROM old_rows"
+                ") AS d(a, h, dep, arr, s); "
+                "ELSE "
+                "SELECT array_agg(d.a), array_agg(d.h), array_agg(d.dep), array_agg(d.arr), array_agg(d.s) "
+                "INTO airports, hours, deps, arrs, seats FROM ("
+                "WITH moved AS (SELECT o.departure_airport_id AS old_dep, o.departure_time AS old_dep_time, "
+                "o.arrival_airport_id AS old_arr, o.arrival_time AS old_arr_time, "
+                "n.departure_airport_id AS new_dep, n.departure_time AS new_dep_time, "
+                "n.arrival_airport_id AS new_arr, n.arrival_time AS new_arr_time, "
+                "CAST((SELECT COUNT(*) FROM bookings b WHERE b.flight_id = n.id) AS INTEGER) AS booked "
+                "FROM old_rows o JOIN new_rows n ON n.id = o.id "
+                "WHERE (o.departure_airport_id, o.departure_time, o.arrival_airport_id, o.arrival_time) "
+                "IS DISTINCT FROM (n.departure_airport_id, n.departure_time, n.arrival_airport_id, n.arrival_time)) "
+                "SELECT old_dep, date_trunc('hour', old_dep_time), -1, 0, -booked FROM moved "
+                "UNION ALL SELECT old_arr, date_trunc('hour', old_arr_time), 0, -1, -booked FROM moved "
+                "UNION ALL SELECT new_dep, date_trunc('hour', new_dep_time), 1, 0, booked FROM moved "
+                "UNION ALL SELECT new_arr, date_trunc('hour', new_arr_time), 0, 1, booked FROM moved"
+                ") AS d(a, h, dep, arr, s); "
+                "END IF; "
+                "IF airports IS NOT NULL THEN "
+                "PERFORM add_airport_hourly_load(airports, hours, deps, arrs, seats); "
+                "END IF; "
+                "RETURN NULL; "
+                "END $$",
+
+                // Bookings add a seat at both ends of their flight. The booking path
+                // locks the flight row first, so a flight cannot move meanwhile.
+                "CREATE OR REPLACE FUNCTION airport_hourly_load_bookings_trigger() "
+                "RETURNS trigger LANGUAGE plpgsql AS $$ "
+                "DECLARE airports INTEGER[]; hours TIMESTAMP[]; deps INTEGER[]; arrs INTEGER[]; seats INTEGER[]; "
+                "BEGIN "
+                "IF TG_OP = 'INSERT' THEN "
+                "SELECT array_agg(d.a), array_agg(d.h), array_agg(d.dep), array_agg(d.arr), array_agg(d.s) "
+                "INTO airports, hours, deps, arrs, seats FROM ("
+                "WITH changed AS (SELECT flight_id, CAST(COUNT(*) AS INTEGER) AS booked FROM new_rows GROUP BY flight_id) "
+                "SELECT f.departure_airport_id, date_trunc('hour', f.departure_time), 0, 0, c.booked "
+                "FROM changed c JOIN flights f ON f.id = c.flight_id "
+                "UNION ALL SELECT f.arrival_airport_id, date_trunc('hour', f.arrival_time), 0, 0, c.booked "
+                "FROM changed c JOIN flights f ON f.id = c.flight_id"
+                ") AS d(a, h, dep, arr, s); "
+                "ELSE "
+                "SELECT array_agg(d.a), array_agg(d.h), array_agg(d.dep), array_agg(d.arr), array_agg(d.s) "
+                "INTO airports, hours, deps, arrs, seats FROM ("
+                "WITH changed AS (SELECT flight_id, CAST(COUNT(*) AS INTEGER) AS booked FROM old_rows GROUP BY flight_id) "
+                "SELECT f.departure_airport_id, date_trunc('hour', f.departure_time), 0, 0, -c.booked "
+                "FROM changed c JOIN flights f ON f.id = c.flight_id "
+                "UNION ALL SELECT f.arrival_airport_id, date_trunc('hour', f.arrival_time), 0, 0, -c.booked "
+                "FROM changed c JOIN flights f ON f.id = c.flight_id"
+                ") AS d(a, h, dep, arr, s); "
+                "END IF; "
+                "IF airports IS NOT NULL THEN "
+                "PERFORM add_airport_hourly_load(airports, hours, deps, arrs, seats); "
+                "END IF; "
+                "RETURN NULL; "
+                "END $$",
+
+                "CREATE TRIGGER flights_airport_hourly_load_insert AFTER INSERT ON flights "
+                "REFERENCING NEW TABLE AS new_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION airport_hourly_load_flights_trigger()",
+
+                "CREATE TRIGGER flights_airport_hourly_load_update AFTER UPDATE ON flights "
+                "REFERENCING OLD TABLE AS old_rows NEW TABLE AS new_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION airport_hourly_load_flights_trigger()",
+
+                "CREATE TRIGGER flights_airport_hourly_load_delete AFTER DELETE ON flights "
+                "REFERENCING OLD TABLE AS old_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION airport_hourly_load_flights_trigger()",
+
+                "CREATE TRIGGER bookings_airport_hourly_load_insert AFTER INSERT ON bookings "
+                "REFERENCING NEW TABLE AS new_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION airport_hourly_load_bookings_trigger()",
+
+                "CREATE TRIGGER bookings_airport_hourly_load_delete AFTER DELETE ON bookings "
+                "REFERENCING OLD TABLE AS old_rows "
+                "FOR EACH STATEMENT EXECUTE FUNCTION airport_hourly_load_bookings_trigger()",
+
+                "INSERT INTO airport_hourly_load (airport_id, hour_bucket, departures, arrivals, seats_sold) "
+                "SELECT * FROM airport_hourly_load_source() "
+                "ON CONFLICT DO NOTHING"
+            }
+        },
+        {
+            9, "Deferred fare summary refresh for seat changes",
+            {
+                // Route days whose seat counters changed, folded into route_day_fares later.
+                // Append-only without a unique key, so concurrent bookings never wait here.
+                "CREATE TABLE IF NOT EXISTS route_day_fares_pending ("
+                "id BIGSERIAL PRIMARY KEY, "
+                "departure_airport_id INTEGER NOT NULL, "
+                "arrival_airport_id INTEGER NOT NULL, "
+                "flight_date DATE NOT NULL)",
+
+                // Refreshes the logged route days; entries another flush is working on are skipped
+                "CREATE OR REPLACE FUNCTION flush_route_day_fares() "
+                "RETURNS INTEGER LANGUAGE plpgsql AS $$ "
+                "DECLARE deps INTEGER[]; arrs INTEGER[]; days DATE[]; "
+                "BEGIN "
+                "WITH taken AS (DELETE FROM route_day_fares_pending p WHERE p.id IN "
+                "(SELECT id FROM route_day_fares_pending FOR UPDATE SKIP LOCKED) "
+                "RETURNING p.departure_airport_id, p.arrival_airport_id, p.flight_date) "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT DISTINCT departure_airport_id, arrival_airport_id, flight_date FROM taken) AS k(dep, arr, day); "
+                "IF deps IS NULL THEN "
+                "RETURN 0; "
+                "END IF; "
+                "PERFORM refresh_route_day_fares(deps, arrs, days); "
+                "RETURN cardinality(deps); "
+                "END $$",
+
+                // Updates that only move seat counters, as the booking path and seat holds do,
+                // are logged instead of refreshed in place: a refresh locks the route day row
+                // until commit and would serialize bookings on different flights of that day.
+                "CREATE OR REPLACE FUNCTION route_day_fares_trigger() "
+                "RETURNS trigger LANGUAGE plpgsql AS $$ "
+                "DECLARE deps INTEGER[]; arrs INTEGER[]; days DATE[]; "
+                "BEGIN "
+                "IF TG_OP = 'INSERT' THEN "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT DISTINCT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) "
+                "FROM new_rows) AS k(dep, arr, day); "
+                "ELSIF TG_OP = 'DELETE' THEN "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(SELECT DISTINCT departure_airport_id, arrival_airport_id, CAST(departure_time AS DATE) "
+                "FROM old_rows) AS k(dep, arr, day); "
+                "ELSE "
+                "INSERT INTO route_day_fares_pending (departure_airport_id, arrival_airport_id, flight_date) "
+                "SELECT DISTINCT n.departure_airport_id, n.arrival_airport_id, CAST(n.departure_time AS DATE) "
+                "FROM old_rows o JOIN new_rows n ON n.id = o.id "
+                "WHERE (o.departure_airport_id, o.arrival_airport_id, o.departure_time, "
+                "o.price_economy, o.price_business, o.price_first) IS NOT DISTINCT FROM "
+                "(n.departure_airport_id, n.arrival_airport_id, n.departure_time, "
+                "n.price_economy, n.price_business, n.price_first) "
+                "AND (o.available_seats_economy, o.available_seats_business, o.available_seats_first) "
+                "IS DISTINCT FROM (n.available_seats_economy, n.available_seats_business, n.available_seats_first); "
+                "SELECT array_agg(k.dep), array_agg(k.arr), array_agg(k.day) INTO deps, arrs, days FROM "
+                "(WITH moved AS (SELECT o.departure_airport_id AS old_dep, o.arrival_airport_id AS old_arr, "
+                "CAST(o.departure_time AS DATE) AS old_day, n.departure_airport_id AS new_dep, "
+                "n.arrival_airport_id AS new_arr, CAST(n.departure_time AS DATE) AS new_day "
+                "FROM old_rows o JOIN new_rows n ON n.id = o.id "
+                "WHERE (o.departure_airport_id, o.arrival_airport_id, o.departure_time, "
+                "o.price_economy, o.price_business, o.price_first) IS DISTINCT FROM "
+                "(n.departure_airport_id, n.arrival_airport_id, n.departure_time, "
+                "n.price_economy, n.price_business, n.price_first)) "
+                "SELECT old_dep, old_arr, old_day FROM moved UNION SELECT new_dep, new_arr, new_day FROM moved) "
+                "AS k(dep, arr, day); "
+                "END IF; "
+                "IF deps IS NOT NULL THEN "
+                "PERFORM refresh_route_day_fares(deps, arrs, days); "
+                "END IF; "
+                "RETURN NULL; "
+                "END $$"
+            }
+        }
+    };
+    return list;
+}
+
+int SchemaMigrator::latestVersion()
+{
+    return migrations().isEmpty() ? 0 : migrations().last().version;
+}
+
+int SchemaMigrator::currentVersion()
+{
+    QSqlQuery query(db);
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS schema_migrations ("
+                    "version INTEGER PRIMARY KEY, "
+                    "description TEXT NOT NULL, "
+                    "applied_at TIMESTAMP NOT NULL DEFAULT now())")) {
+        errorText = query.lastError().text();
+        return -1;
+    }
+
+    if (!query.exec("SELECT COALESCE(MAX(version), 0) FROM schema_migrations") || !query.next()) {
+        errorText = query.lastError().text();
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+bool SchemaMigrator::migrate()
+{
+    int version = currentVersion();
+    if (version < 0) {
+        qDebug() << "Error reading schema version:" << errorText;
+        return false;
+    }
+
+    for (const SchemaMigration &migration : migrations()) {
+        if (migration.version <= version) {
+            continue;
+        }
+        if (!apply(migration)) {
+            qDebug() << "Error applying schema migration" << migration.version << ":" << errorText;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SchemaMigrator::apply(const SchemaMigration &migration)
+{
+    if (!db.transaction()) {
+        errorText = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+
+    // Serialize migrating clients and re-check under the lock
+    query.prepare("SELECT pg_advisory_xact_lock(?)");
+    query.addBindValue(migrationLockKey);
+    if (!query.exec()) {
+        errorText = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    query.prepare("SELECT 1 FROM schema_migrations WHERE version = ?");
+    query.addBindValue(migration.version);
+    if (query.exec() && query.next()) {
+        query.finish();
+        return db.commit();
+    }
+
+    for (const QString &statement : migration.statements) {
+        if (!query.exec(statement)) {
+            errorText = query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    query.prepare("INSERT INTO schema_migrations (version, description) VALUES (?, ?)");
+    query.addBindValue(migration.version);
+    query.addBindValue(migration.description);
+    if (!query.exec()) {
+        errorText = query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        errorText = db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    qDebug() << "Applied schema migration" << migration.version << "-" << migration.description;
+    return true;
+}
+
+QString SchemaMigrator::lastError() const
+{
+    return errorText;
+}
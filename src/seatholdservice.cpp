@@ -0,0 +1,250 @@
+#include "seatholdservice.h"
+#include "database.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QTimer>
+#include <QtConcurrent>
+
+// One wheel slot per second; holds longer than a revolution wait extra rounds
+static const int wheelSlots = 512;
+static const int tickMs = 1000;
+
+// Ticks between sweeps for holds abandoned by other clients
+static const int sweepTicks = 60;
+
+// Free seat counts older than this are re-read from the database
+static const int inventoryFreshMs = 5000;
+
+/**
+ * @brief Holds and seat counters, shared with the tasks running on the database workers
+ */
+struct SeatHoldService::State
+{
+    typedef QPair<int, QString> InventoryKey;
+
+    /**
+     * @brief Last free seat count read from the flights table
+     */
+    struct Inventory
+    {
+        int available = 0;
+        QElapsedTimer updated;
+    };
+
+    /**
+     * @brief A hold tracked in the timer wheel
+     */
+    struct TrackedHold
+    {
+        SeatHold hold;
+        int rounds = 0;
+    };
+
+    QMutex mutex;
+    QVector<QVector<qint64>> wheel = QVector<QVector<qint64>>(wheelSlots);
+    int cursor = 0;
+    int ticks = 0;
+    QHash<qint64, TrackedHold> holds;
+    QHash<InventoryKey, Inventory> inventory;
+
+    /**
+     * @brief Get the last known free seats of a flight class
+     * @return Free seats, -1 if not known recently
+     */
+    int availableSeats(int flightId, const QString &seatClass)
+    {
+        QMutexLocker locker(&mutex);
+
+        auto it = inventory.constFind(InventoryKey(flightId, seatClass));
+        if (it == inventory.constEnd() || it->updated.hasExpired(inventoryFreshMs)) {
+            return -1;
+        }
+        return it->available;
+    }
+
+    /**
+     * @brief Record the free seats reported by the database
+     */
+    void updateInventory(int flightId, const QString &seatClass, int available)
+    {
+        QMutexLocker locker(&mutex);
+
+        Inventory &entry = inventory[InventoryKey(flightId, seatClass)];
+        entry.available = qMax(0, available);
+        entry.updated.start();
+    }
+
+    /**
+     * @brief Start tracking a placed hold, expiring after a number of ticks
+     */
+    void track(const SeatHold &hold, int delay)
+    {
+        QMutexLocker locker(&mutex);
+
+        TrackedHold tracked;
+        tracked.hold = hold;
+        tracked.rounds = (delay - 1) / wheelSlots;
+        holds.insert(hold.id, tracked);
+        wheel[(cursor + delay) % wheelSlots].append(hold.id);
+    }
+};
+
+SeatHoldService::SeatHoldService(Database *db, int ttlSeconds, QObject *parent)
+    : QObject(parent), db(db), ttlSeconds(qMax(1, ttlSeconds)), state(new State)
+{
+    timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, &SeatHoldService::tick);
+    timer->start(tickMs);
+}
+
+SeatHoldService::~SeatHoldService()
+{
+    QList<qint64> active;
+    {
+        QMutexLocker locker(&state->mutex);
+        active = state->holds.keys();
+        state->holds.clear();
+    }
+
+    // Hand the seats back now instead of leaving them to the expiry sweep
+    for (qint64 holdId : std::as_const(active)) {
+        db->releaseHold(holdId);
+    }
+}
+
+QFuture<SeatHold> SeatHoldService::hold(int flightId, int userId, const QString &seatClass, int count)
+{
+    Database *db = this->db;
+    int ttlSeconds = this->ttlSeconds;
+    QSharedPointer<State> state = this->state;
+
+    return QtConcurrent::run(db->workerPool(), [db, ttlSeconds, state, flightId, userId, seatClass, count]() {
+        // A recent counter that cannot cover the request saves the round trip
+        int known = state->availableSeats(flightId, seatClass);
+        if (known >= 0 && known < count) {
+            return SeatHold();
+        }
+
+        SeatHold hold = db->holdSeats(flightId, userId, seatClass, count, ttlSeconds);
+        if (hold.isValid()) {
+            state->updateInventory(flightId, seatClass, hold.remainingSeats);
+            state->track(hold, ttlSeconds);
+        } else if (hold.remainingSeats >= 0) {
+            // The database found fewer seats than requested, remember that as an upper bound;
+            // errors say nothing about the inventory
+            state->updateInventory(flightId, seatClass, hold.remainingSeats);
+        }
+        return hold;
+    });
+}
+
+QFuture<QVector<int>> SeatHoldService::confirm(qint64 holdId, const QVector<Passenger> &passengers)
+{
+    // Stop tracking first so the wheel cannot release the hold while it is confirmed;
+    // a hold that fails to confirm expires in the database and is swept later
+    bool tracked;
+    {
+        QMutexLocker locker(&state->mutex);
+        tracked = state->holds.remove(holdId) > 0;
+    }
+
+    Database *db = this->db;
+    return QtConcurrent::run(db->workerPool(), [db, holdId, passengers, tracked]() {
+        if (!tracked) {
+            return QVector<int>();
+        }
+        return db->confirmHold(holdId, passengers);
+    });
+}
+
+void SeatHoldService::release(qint64 holdId)
+{
+    SeatHold hold;
+    {
+        QMutexLocker locker(&state->mutex);
+        auto it = state->holds.find(holdId);
+        if (it == state->holds.end()) {
+            return;
+        }
+        hold = it->hold;
+        state->holds.erase(it);
+    }
+
+    Database *db = this->db;
+    QSharedPointer<State> state = this->state;
+    QtConcurrent::run(db->workerPool(), [db, state, hold]() {
+        if (db->releaseHold(hold.id)) {
+            int known = state->availableSeats(hold.flightId, hold.seatClass);
+            if (known >= 0) {
+                state->updateInventory(hold.flightId, hold.seatClass, known + hold.seats);
+            }
+        }
+    });
+}
+
+int SeatHoldService::availableSeats(int flightId, const QString &seatClass) const
+{
+    return state->availableSeats(flightId, seatClass);
+}
+
+int SeatHoldService::activeHolds() const
+{
+    QMutexLocker locker(&state->mutex);
+    return state->holds.size();
+}
+
+void SeatHoldService::tick()
+{
+    QVector<qint64> expired;
+    bool sweep = false;
+    {
+        QMutexLocker locker(&state->mutex);
+
+        state->cursor = (state->cursor + 1) % wheelSlots;
+        QVector<qint64> &slot = state->wheel[state->cursor];
+        QVector<qint64> waiting;
+        for (qint64 holdId : std::as_const(slot)) {
+            auto it = state->holds.find(holdId);
+            if (it == state->holds.end()) {
+                // Confirmed or released meanwhile
+                continue;
+            }
+            if (it->rounds > 0) {
+                it->rounds--;
+                waiting.append(holdId);
+                continue;
+            }
+            expired.append(holdId);
+            state->holds.erase(it);
+        }
+        slot = waiting;
+
+        // Forget stale counters so the next hold reconciles with the database
+        for (auto it = state->inventory.begin(); it != state->inventory.end(); ) {
+            if (it->updated.hasExpired(inventoryFreshMs)) {
+                it = state->inventory.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        sweep = ++state->ticks % sweepTicks == 0;
+    }
+
+    Database *db = this->db;
+    for (qint64 holdId : std::as_const(expired)) {
+        QtConcurrent::run(db->workerPool(), [db, holdId]() {
+            db->releaseHold(holdId);
+        });
+        emit holdExpired(holdId);
+    }
+
+    if (sweep) {
+        QtConcurrent::run(db->workerPool(), [db]() {
+            db->releaseExpiredHolds();
+        });
+    }
+}
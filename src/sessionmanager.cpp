@@ -0,0 +1,117 @@
+#include "sessionmanager.h"
+#include "database.h"
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QtConcurrent>
+
+// Random bytes per token, enough that tokens cannot be guessed
+static const int tokenBytes = 32;
+
+SessionManager::SessionManager(Database *db, int idleTimeoutSeconds, int shardCount)
+    : db(db), idleTimeoutMs(qint64(qMax(1, idleTimeoutSeconds)) * 1000), shards(qMax(1, shardCount))
+{
+}
+
+QString SessionManager::login(const QString &username, const QString &password)
+{
+    int userId = db->authenticateUser(username, password);
+    if (userId < 0) {
+        return QString();
+    }
+
+    Session session;
+    session.profile = db->getUserProfile(userId);
+    if (!session.profile.isValid()) {
+        return QString();
+    }
+    session.expiry = QDeadlineTimer(idleTimeoutMs);
+
+    QString token = newToken();
+    Shard &shard = shardFor(token);
+    QMutexLocker locker(&shard.mutex);
+
+    // Adding a session is rare enough to pay for dropping the expired ones of the shard
+    for (auto it = shard.sessions.begin(); it != shard.sessions.end(); ) {
+        if (it->expiry.hasExpired()) {
+            it = shard.sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    shard.sessions.insert(token, session);
+    return token;
+}
+
+QFuture<QString> SessionManager::loginAsync(const QString &username, const QString &password)
+{
+    return QtConcurrent::run(db->workerPool(), [this, username, password]() {
+        return login(username, password);
+    });
+}
+
+UserProfileRow SessionManager::user(const QString &token)
+{
+    if (token.isEmpty()) {
+        return UserProfileRow();
+    }
+
+    Shard &shard = shardFor(token);
+    QMutexLocker locker(&shard.mutex);
+
+    auto it = shard.sessions.find(token);
+    if (it == shard.sessions.end()) {
+        return UserProfileRow();
+    }
+    if (it->expiry.hasExpired()) {
+        shard.sessions.erase(it);
+        return UserProfileRow();
+    }
+    it->expiry.setRemainingTime(idleTimeoutMs);
+    return it->profile;
+}
+
+int SessionManager::userId(const QString &token)
+{
+    return user(token).id;
+}
+
+void SessionManager::updateProfile(const UserProfileRow &profile)
+{
+    for (Shard &shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (Session &session : shard.sessions) {
+            if (session.profile.id == profile.id) {
+                session.profile = profile;
+            }
+        }
+    }
+}
+
+void SessionManager::logout(const QString &token)
+{
+    Shard &shard = shardFor(token);
+    QMutexLocker locker(&shard.mutex);
+    shard.sessions.remove(token);
+}
+
+int SessionManager::sessionCount() const
+{
+    int count = 0;
+    for (const Shard &shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        count += shard.sessions.size();
+    }
+    return count;
+}
+
+SessionManager::Shard &SessionManager::shardFor(const QString &token)
+{
+    return shards[qHash(token) % shards.size()];
+}
+
+QString SessionManager::newToken()
+{
+    QByteArray bytes(tokenBytes, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(bytes.data()), tokenBytes / sizeof(quint32));
+    return QString::fromLatin1(bytes.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
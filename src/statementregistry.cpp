@@ -0,0 +1,81 @@
+#include "statementregistry.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QDebug>
+
+std::atomic<quint64> StatementRegistry::hitCount{0};
+std::atomic<quint64> StatementRegistry::missCount{0};
+
+StatementRegistry::StatementRegistry(const QString &connectionName)
+    : connectionName(connectionName)
+{
+}
+
+StatementRegistry::~StatementRegistry()
+{
+    clear();
+}
+
+QSqlQuery *StatementRegistry::prepare(int id, const QString &sql)
+{
+    Entry *entry = entries.value(id);
+    if (entry) {
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return &entry->query;
+    }
+
+    missCount.fetch_add(1, std::memory_order_relaxed);
+
+    entry = new Entry;
+    entry->query = QSqlQuery(QSqlDatabase::database(connectionName, false));
+    if (!entry->query.prepare(sql)) {
+        qDebug() << "Error preparing statement" << id << ":" << entry->query.lastError().text();
+        delete entry;
+        return nullptr;
+    }
+
+    entries.insert(id, entry);
+    return &entry->query;
+}
+
+const QVector<int> &StatementRegistry::columns(int id, const char *const *names, int count)
+{
+    static const QVector<int> none;
+
+    Entry *entry = entries.value(id);
+    if (!entry) {
+        return none;
+    }
+
+    if (!entry->ordinalsResolved) {
+        QSqlRecord record = entry->query.record();
+        entry->ordinals.resize(count);
+        for (int i = 0; i < count; ++i) {
+            entry->ordinals[i] = record.indexOf(QString::fromLatin1(names[i]));
+        }
+        entry->ordinalsResolved = true;
+    }
+
+    return entry->ordinals;
+}
+
+void StatementRegistry::clear()
+{
+    qDeleteAll(entries);
+    entries.clear();
+}
+
+StatementRegistry::Stats StatementRegistry::stats()
+{
+    Stats result;
+    result.hits = hitCount.load(std::memory_order_relaxed);
+    result.misses = missCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+void StatementRegistry::resetStats()
+{
+    hitCount.store(0, std::memory_order_relaxed);
+    missCount.store(0, std::memory_order_relaxed);
+}
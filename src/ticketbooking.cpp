@@ -2,7 +2,6 @@
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QDateTime>
-#include <QSqlQuery>
 
 /**
  * @brief Конструктор класса бронирования билетов
@@ -12,13 +11,19 @@ TicketBooking::TicketBooking(QWidget *parent)
     : QWidget(parent)
     , currentFlightId(-1)
     , currentUserId(-1)
+    , holdRequest(0)
 {
     db = Database::getInstance();
+    seatHolds = new SeatHoldService(db, 10 * 60, this);
     setupUi();
     
     // Соединение сигналов и слотов
     connect(bookButton, &QPushButton::clicked, this, &TicketBooking::bookTicket);
+    connect(addPassengerButton, &QPushButton::clicked, this, &TicketBooking::addPassenger);
+    connect(removePassengerButton, &QPushButton::clicked, this, &TicketBooking::removePassenger);
     connect(seatClassComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TicketBooking::updatePrice);
+    connect(seatClassComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TicketBooking::placeHold);
+    connect(seatHolds, &SeatHoldService::holdExpired, this, &TicketBooking::onHoldExpired);
 }
 
 /**
@@ -74,7 +79,22 @@ void TicketBooking::setupUi()
     passengerPassportEdit = new QLineEdit(this);
     seatClassComboBox = new QComboBox(this);
     priceLabel = new QLabel(this);
+    holdLabel = new QLabel(this);
     bookButton = new QPushButton("Забронировать билет", this);
+    addPassengerButton = new QPushButton("Добавить пассажира", this);
+    removePassengerButton = new QPushButton("Удалить пассажира", this);
+    
+    // Список пассажиров группового бронирования
+    passengersModel = new QStandardItemModel(0, 2, this);
+    passengersModel->setHorizontalHeaderLabels(QStringList() << "Пассажир" << "Номер паспорта");
+    
+    passengersTableView = new QTableView(this);
+    passengersTableView->setModel(passengersModel);
+    passengersTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    passengersTableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    passengersTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    passengersTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    passengersTableView->setMaximumHeight(150);
     
     seatClassComboBox->addItem("Эконом");
     seatClassComboBox->addItem("Бизнес");
@@ -82,8 +102,17 @@ void TicketBooking::setupUi()
     
     bookingLayout->addRow(passengerNameLabel, passengerNameEdit);
     bookingLayout->addRow(passengerPassportLabel, passengerPassportEdit);
+    
+    QHBoxLayout *passengerButtonsLayout = new QHBoxLayout();
+    passengerButtonsLayout->addWidget(addPassengerButton);
+    passengerButtonsLayout->addWidget(removePassengerButton);
+    passengerButtonsLayout->addStretch();
+    bookingLayout->addRow("", passengerButtonsLayout);
+    bookingLayout->addRow("Пассажиры:", passengersTableView);
+    
     bookingLayout->addRow(seatClassLabel, seatClassComboBox);
     bookingLayout->addRow(priceTitleLabel, priceLabel);
+    bookingLayout->addRow("", holdLabel);
     bookingLayout->addRow("", bookButton);
     
     // Группа бронирований
@@ -115,8 +144,15 @@ void TicketBooking::setupUi()
  */
 void TicketBooking::setFlightId(int flightId)
 {
+    // Места, удерживаемые для предыдущего рейса, возвращаются
+    if (flightId != currentFlightId) {
+        releaseHold();
+    }
     currentFlightId = flightId;
     loadFlightDetails();
+    
+    // Удержание мест на время заполнения формы
+    placeHold();
 }
 
 /**
@@ -125,8 +161,12 @@ void TicketBooking::setFlightId(int flightId)
  */
 void TicketBooking::setUserId(int userId)
 {
+    if (userId != currentUserId) {
+        releaseHold();
+    }
     currentUserId = userId;
     loadUserBookings();
+    placeHold();
 }
 
 /**
@@ -138,60 +178,28 @@ void TicketBooking::loadFlightDetails()
         return;
     }
     
-    // Поиск рейса в базе данных
-    QSqlQuery query;
-    query.prepare(
-        "SELECT f.id, f.flight_number, a.name as airline_name, "
-        "dep.code as departure_code, dep.city as departure_city, "
-        "arr.code as arrival_code, arr.city as arrival_city, "
-        "f.departure_time, f.arrival_time, "
-        "f.price_economy, f.price_business, f.price_first, "
-        "f.available_seats_economy, f.available_seats_business, f.available_seats_first "
-        "FROM flights f "
-        "JOIN airlines a ON f.airline_id = a.id "
-        "JOIN airports dep ON f.departure_airport_id = dep.id "
-        "JOIN airports arr ON f.arrival_airport_id = arr.id "
-        "WHERE f.id = ?"
-    );
-    
-    query.addBindValue(currentFlightId);
-    
-    if (query.exec() && query.next()) {
+    // Асинхронная загрузка рейса из базы данных
+    db->getFlightAsync(currentFlightId).then(this, [this](const FlightRow &flight) {
+        if (!flight.isValid()) {
+            QMessageBox::warning(this, "Ошибка", "Не удалось загрузить детали рейса.");
+            return;
+        }
+        
         // Сохранение деталей рейса
-        currentFlight.clear();
-        currentFlight["id"] = query.value("id");
-        currentFlight["flight_number"] = query.value("flight_number");
-        currentFlight["airline_name"] = query.value("airline_name");
-        currentFlight["departure_code"] = query.value("departure_code");
-        currentFlight["departure_city"] = query.value("departure_city");
-        currentFlight["arrival_code"] = query.value("arrival_code");
-        currentFlight["arrival_city"] = query.value("arrival_city");
-        currentFlight["departure_time"] = query.value("departure_time");
-        currentFlight["arrival_time"] = query.value("arrival_time");
-        currentFlight["price_economy"] = query.value("price_economy");
-        currentFlight["price_business"] = query.value("price_business");
-        currentFlight["price_first"] = query.value("price_first");
-        currentFlight["available_seats_economy"] = query.value("available_seats_economy");
-        currentFlight["available_seats_business"] = query.value("available_seats_business");
-        currentFlight["available_seats_first"] = query.value("available_seats_first");
+        currentFlight = flight;
         
         // Отображение деталей рейса
-        flightNumberLabel->setText(currentFlight["flight_number"].toString());
-        airlineLabel->setText(currentFlight["airline_name"].toString());
-        departureLabel->setText(QString("%1 (%2)").arg(currentFlight["departure_city"].toString(), currentFlight["departure_code"].toString()));
-        arrivalLabel->setText(QString("%1 (%2)").arg(currentFlight["arrival_city"].toString(), currentFlight["arrival_code"].toString()));
+        flightNumberLabel->setText(currentFlight.flightNumber);
+        airlineLabel->setText(currentFlight.airlineName);
+        departureLabel->setText(QString("%1 (%2)").arg(currentFlight.departureCity, currentFlight.departureCode));
+        arrivalLabel->setText(QString("%1 (%2)").arg(currentFlight.arrivalCity, currentFlight.arrivalCode));
         
-        QDateTime departureDateTime = QDateTime::fromString(currentFlight["departure_time"].toString(), Qt::ISODate);
-        QDateTime arrivalDateTime = QDateTime::fromString(currentFlight["arrival_time"].toString(), Qt::ISODate);
-        
-        departureDateTimeLabel->setText(departureDateTime.toString("yyyy-MM-dd hh:mm"));
-        arrivalDateTimeLabel->setText(arrivalDateTime.toString("yyyy-MM-dd hh:mm"));
+        departureDateTimeLabel->setText(currentFlight.departureTime.toString("yyyy-MM-dd hh:mm"));
+        arrivalDateTimeLabel->setText(currentFlight.arrivalTime.toString("yyyy-MM-dd hh:mm"));
         
         // Обновление цены в зависимости от выбранного класса места
         updatePrice(seatClassComboBox->currentIndex());
-    } else {
-        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить детали рейса.");
-    }
+    });
 }
 
 /**
@@ -203,11 +211,10 @@ void TicketBooking::loadUserBookings()
         return;
     }
     
-    // Получение бронирований пользователя
-    QList<QMap<QString, QVariant>> bookings = db->getUserBookings(currentUserId);
-    
-    // Отображение бронирований
-    displayUserBookings(bookings);
+    // Асинхронное получение и отображение бронирований пользователя
+    db->getUserBookingsAsync(currentUserId).then(this, [this](const QVector<BookingRow> &bookings) {
+        displayUserBookings(bookings);
+    });
 }
 
 /**
@@ -226,58 +233,213 @@ void TicketBooking::bookTicket()
     }
     
     // Получение информации о бронировании
-    QString passengerName = passengerNameEdit->text();
-    QString passengerPassport = passengerPassportEdit->text();
+    QVector<Passenger> passengers = collectPassengers();
     QString seatClass = seatClassComboBox->currentText();
+    QString dbSeatClass = selectedSeatClass();
     
-    // Перевод класса места на английский для базы данных
-    QString dbSeatClass;
-    if (seatClass == "Эконом") {
-        dbSeatClass = "Economy";
-    } else if (seatClass == "Бизнес") {
-        dbSeatClass = "Business";
-    } else if (seatClass == "Первый класс") {
-        dbSeatClass = "First";
+    // Проверка ввода
+    if (passengers.isEmpty()) {
+        QMessageBox::warning(this, "Ошибка бронирования", "Пожалуйста, введите имя пассажира и номер паспорта.");
+        return;
     }
     
-    // Проверка ввода
+    if (passengers.size() > MaxPassengersPerBooking) {
+        QMessageBox::warning(this, "Ошибка бронирования",
+                             QString("В одном бронировании может быть не более %1 пассажиров.").arg(MaxPassengersPerBooking));
+        return;
+    }
+    
+    QFuture<QVector<int>> booking;
+    if (currentHold.isValid() && currentHold.seatClass == dbSeatClass && currentHold.seats == passengers.size()) {
+        // Удержанные места уже списаны с рейса, наличие повторно не проверяется
+        booking = seatHolds->confirm(currentHold.id, passengers);
+        currentHold = SeatHold();
+    } else {
+        // Удержание не подходит к составу группы и возвращается вместе со своими местами
+        int heldSeats = currentHold.isValid() && currentHold.seatClass == dbSeatClass ? currentHold.seats : 0;
+        releaseHold();
+        
+        // Проверка доступности мест
+        if (currentFlight.availableSeats(dbSeatClass) + heldSeats < passengers.size()) {
+            QMessageBox::warning(this, "Ошибка бронирования", QString("Недостаточно мест класса %1 для этого рейса.").arg(seatClass));
+            return;
+        }
+        
+        // Асинхронное бронирование билетов для всех пассажиров одной транзакцией
+        booking = db->bookTicketsAsync(currentFlightId, currentUserId, dbSeatClass, passengers);
+    }
+    
+    bookButton->setEnabled(false);
+    holdLabel->clear();
+    
+    booking.then(this, [this](const QVector<int> &bookingIds) {
+        bookButton->setEnabled(true);
+        
+        if (!bookingIds.isEmpty()) {
+            QStringList numbers;
+            for (int bookingId : bookingIds) {
+                numbers << QString::number(bookingId);
+            }
+            QMessageBox::information(this, "Бронирование успешно", 
+                                   QString("Билеты успешно забронированы.\nНомера бронирований: %1").arg(numbers.join(", ")));
+            
+            // Очистка формы
+            passengerNameEdit->clear();
+            passengerPassportEdit->clear();
+            passengersModel->removeRows(0, passengersModel->rowCount());
+            
+            // Перезагрузка деталей рейса и бронирований пользователя
+            loadFlightDetails();
+            loadUserBookings();
+        } else {
+            QMessageBox::warning(this, "Ошибка бронирования", "Не удалось забронировать билеты.");
+        }
+    });
+}
+
+/**
+ * @brief Добавление введенного пассажира в группу
+ */
+void TicketBooking::addPassenger()
+{
+    QString passengerName = passengerNameEdit->text().trimmed();
+    QString passengerPassport = passengerPassportEdit->text().trimmed();
+    
     if (passengerName.isEmpty() || passengerPassport.isEmpty()) {
         QMessageBox::warning(this, "Ошибка бронирования", "Пожалуйста, введите имя пассажира и номер паспорта.");
         return;
     }
     
-    // Проверка доступности мест
-    int availableSeats = 0;
-    if (dbSeatClass == "Economy") {
-        availableSeats = currentFlight["available_seats_economy"].toInt();
-    } else if (dbSeatClass == "Business") {
-        availableSeats = currentFlight["available_seats_business"].toInt();
-    } else if (dbSeatClass == "First") {
-        availableSeats = currentFlight["available_seats_first"].toInt();
+    if (passengersModel->rowCount() >= MaxPassengersPerBooking) {
+        QMessageBox::warning(this, "Ошибка бронирования",
+                             QString("В одном бронировании может быть не более %1 пассажиров.").arg(MaxPassengersPerBooking));
+        return;
+    }
+    
+    passengersModel->appendRow({new QStandardItem(passengerName), new QStandardItem(passengerPassport)});
+    passengerNameEdit->clear();
+    passengerPassportEdit->clear();
+    passengerNameEdit->setFocus();
+    
+    updatePrice(seatClassComboBox->currentIndex());
+    placeHold();
+}
+
+/**
+ * @brief Удаление выбранного пассажира из группы
+ */
+void TicketBooking::removePassenger()
+{
+    QModelIndex index = passengersTableView->currentIndex();
+    if (!index.isValid()) {
+        return;
     }
     
-    if (availableSeats <= 0) {
-        QMessageBox::warning(this, "Ошибка бронирования", QString("Нет доступных мест класса %1 для этого рейса.").arg(seatClass));
+    passengersModel->removeRow(index.row());
+    updatePrice(seatClassComboBox->currentIndex());
+    placeHold();
+}
+
+/**
+ * @brief Удержание мест выбранного класса для группы пассажиров
+ */
+void TicketBooking::placeHold()
+{
+    if (currentFlightId < 0 || currentUserId < 0) {
         return;
     }
     
-    // Бронирование билета
-    int bookingId = db->bookTicket(currentFlightId, currentUserId, dbSeatClass, passengerName, passengerPassport);
+    QString seatClass = selectedSeatClass();
+    int seats = qMax(1, passengersModel->rowCount());
+    if (currentHold.isValid() && currentHold.seatClass == seatClass && currentHold.seats == seats) {
+        return;
+    }
     
-    if (bookingId >= 0) {
-        QMessageBox::information(this, "Бронирование успешно", 
-                               QString("Ваш билет успешно забронирован.\nНомер бронирования: %1").arg(bookingId));
-        
-        // Очистка формы
-        passengerNameEdit->clear();
-        passengerPassportEdit->clear();
+    // Старое удержание заменяется новым
+    releaseHold();
+    
+    int request = ++holdRequest;
+    seatHolds->hold(currentFlightId, currentUserId, seatClass, seats).then(this, [this, request](const SeatHold &hold) {
+        // Ответ на устаревший запрос освобождается сразу
+        if (request != holdRequest) {
+            if (hold.isValid()) {
+                seatHolds->release(hold.id);
+            }
+            return;
+        }
         
-        // Перезагрузка деталей рейса и бронирований пользователя
-        loadFlightDetails();
-        loadUserBookings();
-    } else {
-        QMessageBox::warning(this, "Ошибка бронирования", "Не удалось забронировать билет.");
+        currentHold = hold;
+        if (hold.isValid()) {
+            holdLabel->setText(QString("Места удерживаются до %1").arg(hold.expiresAt.toString("hh:mm")));
+        } else {
+            holdLabel->setText("Не удалось удержать места: свободных мест недостаточно");
+        }
+    });
+}
+
+/**
+ * @brief Обработка истечения удержания мест
+ * @param holdId ID удержания
+ */
+void TicketBooking::onHoldExpired(qint64 holdId)
+{
+    if (holdId != currentHold.id) {
+        return;
     }
+    
+    currentHold = SeatHold();
+    holdLabel->setText("Время удержания мест истекло");
+}
+
+/**
+ * @brief Возврат удерживаемых мест
+ */
+void TicketBooking::releaseHold()
+{
+    // Запрос удержания, который еще выполняется, будет отменен по ответу
+    holdRequest++;
+    
+    if (currentHold.isValid()) {
+        seatHolds->release(currentHold.id);
+        currentHold = SeatHold();
+    }
+    holdLabel->clear();
+}
+
+/**
+ * @brief Перевод выбранного класса места на английский для базы данных
+ * @return Класс места (Economy, Business, First)
+ */
+QString TicketBooking::selectedSeatClass() const
+{
+    switch (seatClassComboBox->currentIndex()) {
+        case 1:
+            return "Business";
+        case 2:
+            return "First";
+        default:
+            return "Economy";
+    }
+}
+
+/**
+ * @brief Сбор пассажиров группы и введенного, но не добавленного пассажира
+ * @return Список пассажиров для бронирования
+ */
+QVector<Passenger> TicketBooking::collectPassengers() const
+{
+    QVector<Passenger> passengers;
+    for (int row = 0; row < passengersModel->rowCount(); ++row) {
+        passengers.append({passengersModel->item(row, 0)->text(), passengersModel->item(row, 1)->text()});
+    }
+    
+    QString passengerName = passengerNameEdit->text().trimmed();
+    QString passengerPassport = passengerPassportEdit->text().trimmed();
+    if (!passengerName.isEmpty() && !passengerPassport.isEmpty()) {
+        passengers.append({passengerName, passengerPassport});
+    }
+    
+    return passengers;
 }
 
 /**
@@ -286,7 +448,7 @@ void TicketBooking::bookTicket()
  */
 void TicketBooking::updatePrice(int index)
 {
-    if (currentFlight.isEmpty()) {
+    if (!currentFlight.isValid()) {
         return;
     }
     
@@ -294,24 +456,31 @@ void TicketBooking::updatePrice(int index)
     
     switch (index) {
         case 0: // Эконом
-            price = currentFlight["price_economy"].toDouble();
+            price = currentFlight.priceEconomy;
             break;
         case 1: // Бизнес
-            price = currentFlight["price_business"].toDouble();
+            price = currentFlight.priceBusiness;
             break;
         case 2: // Первый класс
-            price = currentFlight["price_first"].toDouble();
+            price = currentFlight.priceFirst;
             break;
     }
     
-    priceLabel->setText(QString("%1 руб.").arg(price, 0, 'f', 2));
+    // Для группы показывается общая стоимость
+    int passengerCount = qMax(1, passengersModel->rowCount());
+    if (passengerCount > 1) {
+        priceLabel->setText(QString("%1 руб. × %2 = %3 руб.").arg(price, 0, 'f', 2).arg(passengerCount)
+                            .arg(price * passengerCount, 0, 'f', 2));
+    } else {
+        priceLabel->setText(QString("%1 руб.").arg(price, 0, 'f', 2));
+    }
 }
 
 /**
  * @brief Отображение бронирований пользователя
  * @param bookings Список бронирований
  */
-void TicketBooking::displayUserBookings(const QList<QMap<QString, QVariant>> &bookings)
+void TicketBooking::displayUserBookings(const QVector<BookingRow> &bookings)
 {
     // Очистка модели
     bookingsModel->clear();
@@ -324,16 +493,14 @@ void TicketBooking::displayUserBookings(const QList<QMap<QString, QVariant>> &bo
     for (const auto &booking : bookings) {
         QList<QStandardItem*> row;
         
-        row.append(new QStandardItem(booking["id"].toString()));
-        row.append(new QStandardItem(booking["flight_number"].toString()));
-        row.append(new QStandardItem(QString("%1 (%2)").arg(booking["departure_city"].toString(), booking["departure_code"].toString())));
-        row.append(new QStandardItem(QString("%1 (%2)").arg(booking["arrival_city"].toString(), booking["arrival_code"].toString())));
-        
-        QDateTime departureDateTime = QDateTime::fromString(booking["departure_time"].toString(), Qt::ISODate);
-        row.append(new QStandardItem(departureDateTime.toString("yyyy-MM-dd hh:mm")));
+        row.append(new QStandardItem(QString::number(booking.id)));
+        row.append(new QStandardItem(booking.flightNumber));
+        row.append(new QStandardItem(QString("%1 (%2)").arg(booking.departureCity, booking.departureCode)));
+        row.append(new QStandardItem(QString("%1 (%2)").arg(booking.arrivalCity, booking.arrivalCode)));
+        row.append(new QStandardItem(booking.departureTime.toString("yyyy-MM-dd hh:mm")));
         
         // Перевод класса места на русский
-        QString seatClass = booking["seat_class"].toString();
+        const QString &seatClass = booking.seatClass;
         QString translatedSeatClass;
         if (seatClass == "Economy") {
             translatedSeatClass = "Эконом";
@@ -346,10 +513,10 @@ void TicketBooking::displayUserBookings(const QList<QMap<QString, QVariant>> &bo
         }
         
         row.append(new QStandardItem(translatedSeatClass));
-        row.append(new QStandardItem(booking["passenger_name"].toString()));
+        row.append(new QStandardItem(booking.passengerName));
         
         // Перевод статуса на русский
-        QString status = booking["status"].toString();
+        const QString &status = booking.status;
         QString translatedStatus;
         if (status == "Confirmed") {
             translatedStatus = "Подтверждено";
@@ -0,0 +1,356 @@
+#include "timetableengine.h"
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include <algorithm>
+#include <numeric>
+
+// Julian day of 1970-01-01, timestamps are kept as seconds of the wall clock since then
+static const qint64 unixEpochJulianDay = 2440588;
+static const qint64 secondsPerDay = 86400;
+
+QSharedPointer<const TimetableSnapshot> TimetableSnapshot::load(const QSqlDatabase &db,
+                                                                const QSharedPointer<const ReferenceData> &reference,
+                                                                QString *error)
+{
+    // Airports and airlines are stored as 16-bit indexes
+    if (reference->airports().size() > 0xFFFF || reference->airlines().size() > 0xFFFF) {
+        *error = "Too many airports or airlines for the timetable";
+        return QSharedPointer<const TimetableSnapshot>();
+    }
+
+    QSharedPointer<TimetableSnapshot> snapshot(new TimetableSnapshot);
+    snapshot->reference = reference;
+
+    const QVector<AirportRow> &airports = reference->airports();
+    snapshot->airportIndexes.reserve(airports.size());
+    for (int i = 0; i < airports.size(); i++) {
+        snapshot->airportIndexes.insert(airports[i].id, i);
+    }
+
+    QHash<int, int> airlineIndexes;
+    const QVector<AirlineRow> &airlineRows = reference->airlines();
+    for (int i = 0; i < airlineRows.size(); i++) {
+        airlineIndexes.insert(airlineRows[i].id, i);
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // Times are read as wall-clock seconds to avoid parsing a QDateTime per row
+    if (!query.exec("SELECT f.id, f.flight_number, f.airline_id, f.departure_airport_id, f.arrival_airport_id, "
+                    "CAST(EXTRACT(EPOCH FROM f.departure_time) AS BIGINT), "
+                    "CAST(EXTRACT(EPOCH FROM f.arrival_time - f.departure_time) AS INTEGER), "
+                    "f.price_economy, f.price_business, f.price_first, "
+                    "f.available_seats_economy, f.available_seats_business, f.available_seats_first "
+                    "FROM flights f "
+                    "ORDER BY f.departure_airport_id, f.arrival_airport_id, f.departure_time, f.id")) {
+        *error = query.lastError().text();
+        return QSharedPointer<const TimetableSnapshot>();
+    }
+
+    if (query.size() > 0) {
+        int size = query.size();
+        snapshot->departures.reserve(size);
+        snapshot->durations.reserve(size);
+        snapshot->departureAirports.reserve(size);
+        snapshot->arrivalAirports.reserve(size);
+        snapshot->flightIds.reserve(size);
+        snapshot->airlines.reserve(size);
+        snapshot->pricesEconomy.reserve(size);
+        snapshot->pricesBusiness.reserve(size);
+        snapshot->pricesFirst.reserve(size);
+        snapshot->seatsEconomy.reserve(size);
+        snapshot->seatsBusiness.reserve(size);
+        snapshot->seatsFirst.reserve(size);
+        snapshot->flightNumbers.reserve(size);
+    }
+
+    quint64 currentRoute = 0;
+    int routeBegin = 0;
+    bool haveRoute = false;
+
+    while (query.next()) {
+        int departureIndex = snapshot->airportIndexes.value(query.value(3).toInt(), -1);
+        int arrivalIndex = snapshot->airportIndexes.value(query.value(4).toInt(), -1);
+        if (departureIndex < 0 || arrivalIndex < 0) {
+            continue;
+        }
+
+        // Rows arrive grouped by route; close the previous route's range on change
+        quint64 route = routeKey(departureIndex, arrivalIndex);
+        int slot = snapshot->departures.size();
+        if (!haveRoute || route != currentRoute) {
+            if (haveRoute) {
+                snapshot->routes.insert(currentRoute, qMakePair(routeBegin, slot));
+            }
+            currentRoute = route;
+            routeBegin = slot;
+            haveRoute = true;
+        }
+
+        snapshot->flightIds.append(query.value(0).toInt());
+        snapshot->flightNumbers.append(query.value(1).toString());
+        snapshot->airlines.append(quint16(airlineIndexes.value(query.value(2).toInt(), 0)));
+        snapshot->departures.append(query.value(5).toLongLong());
+        snapshot->durations.append(query.value(6).toInt());
+        snapshot->departureAirports.append(quint16(departureIndex));
+        snapshot->arrivalAirports.append(quint16(arrivalIndex));
+        snapshot->pricesEconomy.append(query.value(7).toFloat());
+        snapshot->pricesBusiness.append(query.value(8).toFloat());
+        snapshot->pricesFirst.append(query.value(9).toFloat());
+        snapshot->seatsEconomy.append(query.value(10).toInt());
+        snapshot->seatsBusiness.append(query.value(11).toInt());
+        snapshot->seatsFirst.append(query.value(12).toInt());
+    }
+    if (haveRoute) {
+        snapshot->routes.insert(currentRoute, qMakePair(routeBegin, int(snapshot->departures.size())));
+    }
+
+    if (query.lastError().isValid()) {
+        *error = query.lastError().text();
+        return QSharedPointer<const TimetableSnapshot>();
+    }
+
+    // Network-wide departure order for connection scans
+    snapshot->departureOrder.resize(snapshot->departures.size());
+    std::iota(snapshot->departureOrder.begin(), snapshot->departureOrder.end(), 0);
+    const QVector<qint64> &departures = snapshot->departures;
+    std::stable_sort(snapshot->departureOrder.begin(), snapshot->departureOrder.end(), [&departures](qint32 a, qint32 b) {
+        return departures[a] < departures[b];
+    });
+
+    snapshot->loadTimer.start();
+    return snapshot;
+}
+
+QVector<FlightRow> TimetableSnapshot::searchFlights(const QString &departureCity, const QString &arrivalCity,
+                                                    const QDate &departureDate, const QDate &returnDate) const
+{
+    QVector<FlightRow> results;
+    appendLeg(departureCity, arrivalCity, departureDate, false, results);
+    if (returnDate.isValid()) {
+        appendLeg(arrivalCity, departureCity, returnDate, true, results);
+    }
+    return results;
+}
+
+void TimetableSnapshot::appendLeg(const QString &departureCity, const QString &arrivalCity, const QDate &date,
+                                  bool isReturn, QVector<FlightRow> &results) const
+{
+    qint64 from = dayStart(date);
+    qint64 to = from + secondsPerDay;
+    int first = results.size();
+
+    const QVector<int> departureIds = reference->resolveAirportIds(departureCity);
+    const QVector<int> arrivalIds = reference->resolveAirportIds(arrivalCity);
+
+    for (int departureId : departureIds) {
+        int departureIndex = airportIndexes.value(departureId, -1);
+        for (int arrivalId : arrivalIds) {
+            int arrivalIndex = airportIndexes.value(arrivalId, -1);
+            auto route = routes.constFind(routeKey(departureIndex, arrivalIndex));
+            if (departureIndex < 0 || arrivalIndex < 0 || route == routes.constEnd()) {
+                continue;
+            }
+
+            // Binary search the first departure of the day within the route
+            auto begin = departures.constBegin() + route->first;
+            auto end = departures.constBegin() + route->second;
+            for (auto it = std::lower_bound(begin, end, from); it != end && *it < to; ++it) {
+                results.append(flightAt(int(it - departures.constBegin()), departureIndex, arrivalIndex, isReturn));
+            }
+        }
+    }
+
+    // Several airports per city merge into one list ordered like the SQL search
+    std::stable_sort(results.begin() + first, results.end(), [](const FlightRow &a, const FlightRow &b) {
+        return a.departureTime < b.departureTime;
+    });
+}
+
+FlightRow TimetableSnapshot::flightAt(int slot, int departureIndex, int arrivalIndex, bool isReturn) const
+{
+    const AirportRow &departure = reference->airports()[departureIndex];
+    const AirportRow &arrival = reference->airports()[arrivalIndex];
+    const QVector<AirlineRow> &airlineRows = reference->airlines();
+
+    FlightRow flight;
+    flight.id = flightIds[slot];
+    flight.flightNumber = flightNumbers[slot];
+    flight.airlineName = airlines[slot] < airlineRows.size() ? airlineRows[airlines[slot]].name : QString();
+    flight.departureCode = departure.code;
+    flight.departureCity = departure.city;
+    flight.arrivalCode = arrival.code;
+    flight.arrivalCity = arrival.city;
+    flight.departureTime = wallClock(departures[slot]);
+    flight.arrivalTime = wallClock(departures[slot] + durations[slot]);
+    flight.priceEconomy = pricesEconomy[slot];
+    flight.priceBusiness = pricesBusiness[slot];
+    flight.priceFirst = pricesFirst[slot];
+    flight.availableSeatsEconomy = seatsEconomy[slot];
+    flight.availableSeatsBusiness = seatsBusiness[slot];
+    flight.availableSeatsFirst = seatsFirst[slot];
+    flight.isReturn = isReturn;
+    return flight;
+}
+
+int TimetableSnapshot::flightCount() const
+{
+    return departures.size();
+}
+
+qint64 TimetableSnapshot::age() const
+{
+    return loadTimer.elapsed();
+}
+
+float TimetableSnapshot::price(int slot, int seatClass) const
+{
+    switch (seatClass) {
+    case 1:
+        return pricesBusiness[slot];
+    case 2:
+        return pricesFirst[slot];
+    default:
+        return pricesEconomy[slot];
+    }
+}
+
+int TimetableSnapshot::seats(int slot, int seatClass) const
+{
+    switch (seatClass) {
+    case 1:
+        return seatsBusiness[slot];
+    case 2:
+        return seatsFirst[slot];
+    default:
+        return seatsEconomy[slot];
+    }
+}
+
+quint64 TimetableSnapshot::routeKey(int departureIndex, int arrivalIndex)
+{
+    return (quint64(quint32(departureIndex)) << 32) | quint32(arrivalIndex);
+}
+
+qint64 TimetableSnapshot::dayStart(const QDate &date)
+{
+    return (date.toJulianDay() - unixEpochJulianDay) * secondsPerDay;
+}
+
+QDateTime TimetableSnapshot::wallClock(qint64 seconds)
+{
+    qint64 days = seconds / secondsPerDay;
+    qint64 rest = seconds % secondsPerDay;
+    if (rest < 0) {
+        days--;
+        rest += secondsPerDay;
+    }
+    return QDateTime(QDate::fromJulianDay(unixEpochJulianDay + days), QTime(0, 0).addSecs(int(rest)));
+}
+
+int TimetableSnapshot::seatClassIndex(const QString &seatClass)
+{
+    if (seatClass == "Business") {
+        return 1;
+    } else if (seatClass == "First") {
+        return 2;
+    }
+    return 0;
+}
+
+TimetableEngine::TimetableEngine(int maxAgeMs)
+    : maxAgeMs(maxAgeMs), rebuildState(Idle)
+{
+}
+
+QSharedPointer<const TimetableSnapshot> TimetableEngine::freshSnapshot() const
+{
+    QMutexLocker locker(&mutex);
+    if (current && current->age() <= maxAgeMs) {
+        return current;
+    }
+    return QSharedPointer<const TimetableSnapshot>();
+}
+
+QSharedPointer<const TimetableSnapshot> TimetableEngine::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+bool TimetableEngine::rebuild(const QSqlDatabase &db, const QSharedPointer<const ReferenceData> &reference)
+{
+    // Loading takes a while; searches keep using the old snapshot or SQL meanwhile
+    QString error;
+    QSharedPointer<const TimetableSnapshot> snapshot = TimetableSnapshot::load(db, reference, &error);
+
+    QMutexLocker locker(&mutex);
+    rebuildState = Idle;
+    rebuilt.wakeAll();
+    if (!snapshot) {
+        errorText = error;
+        qDebug() << "Error building timetable snapshot:" << error;
+        return false;
+    }
+    current = snapshot;
+    return true;
+}
+
+bool TimetableEngine::beginRebuild()
+{
+    QMutexLocker locker(&mutex);
+    if (rebuildState != Idle) {
+        return false;
+    }
+    rebuildState = Queued;
+    return true;
+}
+
+bool TimetableEngine::startRebuild(bool queued)
+{
+    QMutexLocker locker(&mutex);
+    if (rebuildState == Loading || (queued && rebuildState != Queued)) {
+        return false;
+    }
+    rebuildState = Loading;
+    return true;
+}
+
+void TimetableEngine::cancelRebuild(const QString &error)
+{
+    QMutexLocker locker(&mutex);
+    rebuildState = Idle;
+    errorText = error;
+    rebuilt.wakeAll();
+}
+
+bool TimetableEngine::waitForRebuild()
+{
+    QMutexLocker locker(&mutex);
+    while (rebuildState == Loading) {
+        rebuilt.wait(&mutex);
+    }
+    return !current.isNull();
+}
+
+void TimetableEngine::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    current.reset();
+}
+
+void TimetableEngine::setMaxAge(int maxAgeMs)
+{
+    QMutexLocker locker(&mutex);
+    this->maxAgeMs = maxAgeMs;
+}
+
+QString TimetableEngine::lastError() const
+{
+    QMutexLocker locker(&mutex);
+    return errorText;
+}
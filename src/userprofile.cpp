@@ -93,16 +93,17 @@ void UserProfile::loadUserProfile()
         return;
     }
     
-    // Получение профиля пользователя
-    QMap<QString, QVariant> profile = db->getUserProfile(currentUserId);
-    
-    if (profile.isEmpty()) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить профиль пользователя.");
-        return;
-    }
-    
-    // Отображение профиля пользователя
-    displayUserProfile(profile);
+    // Асинхронное получение профиля пользователя
+    db->getUserProfileAsync(currentUserId).then(this, [this](const UserProfileRow &profile) {
+        if (!profile.isValid()) {
+            QMessageBox::warning(this, "Ошибка", "Не удалось загрузить профиль пользователя.");
+            return;
+        }
+        
+        // Отображение профиля пользователя
+        displayUserProfile(profile);
+        emit profileLoaded(profile);
+    });
 }
 
 /**
@@ -114,11 +115,10 @@ void UserProfile::loadUserBookings()
         return;
     }
     
-    // Получение бронирований пользователя
-    QList<QMap<QString, QVariant>> bookings = db->getUserBookings(currentUserId);
-    
-    // Отображение бронирований
-    displayUserBookings(bookings);
+    // Асинхронное получение и отображение бронирований пользователя
+    db->getUserBookingsAsync(currentUserId).then(this, [this](const QVector<BookingRow> &bookings) {
+        displayUserBookings(bookings);
+    });
 }
 
 /**
@@ -141,36 +141,38 @@ void UserProfile::saveProfile()
         return;
     }
     
-    // Обновление профиля
-    bool success = db->updateUserProfile(currentUserId, email, fullName);
+    // Асинхронное обновление профиля
+    saveButton->setEnabled(false);
     
-    if (success) {
-        QMessageBox::information(this, "Успех", "Профиль успешно обновлен.");
-        loadUserProfile();
-    } else {
-        QMessageBox::warning(this, "Ошибка", "Не удалось обновить профиль.");
-    }
+    db->updateUserProfileAsync(currentUserId, email, fullName).then(this, [this](bool success) {
+        saveButton->setEnabled(true);
+        
+        if (success) {
+            QMessageBox::information(this, "Успех", "Профиль успешно обновлен.");
+            loadUserProfile();
+        } else {
+            QMessageBox::warning(this, "Ошибка", "Не удалось обновить профиль.");
+        }
+    });
 }
 
 /**
  * @brief Отображение профиля пользователя
  * @param profile Данные профиля пользователя
  */
-void UserProfile::displayUserProfile(const QMap<QString, QVariant> &profile)
+void UserProfile::displayUserProfile(const UserProfileRow &profile)
 {
-    usernameLabel->setText(profile["username"].toString());
-    emailEdit->setText(profile["email"].toString());
-    fullNameEdit->setText(profile["full_name"].toString());
-    
-    QDateTime registrationDateTime = QDateTime::fromString(profile["registration_date"].toString(), Qt::ISODate);
-    registrationDateLabel->setText(registrationDateTime.toString("yyyy-MM-dd hh:mm"));
+    usernameLabel->setText(profile.username);
+    emailEdit->setText(profile.email);
+    fullNameEdit->setText(profile.fullName);
+    registrationDateLabel->setText(profile.registrationDate.toString("yyyy-MM-dd hh:mm"));
 }
 
 /**
  * @brief Отображение бронирований пользователя
  * @param bookings Список бронирований
  */
-void UserProfile::displayUserBookings(const QList<QMap<QString, QVariant>> &bookings)
+void UserProfile::displayUserBookings(const QVector<BookingRow> &bookings)
 {
     // Очистка модели
     bookingsModel->clear();
@@ -183,16 +185,14 @@ void UserProfile::displayUserBookings(const QList<QMap<QString, QVariant>> &book
     for (const auto &booking : bookings) {
         QList<QStandardItem*> row;
         
-        row.append(new QStandardItem(booking["id"].toString()));
-        row.append(new QStandardItem(booking["flight_number"].toString()));
-        row.append(new QStandardItem(QString("%1 (%2)").arg(booking["departure_city"].toString(), booking["departure_code"].toString())));
-        row.append(new QStandardItem(QString("%1 (%2)").arg(booking["arrival_city"].toString(), booking["arrival_code"].toString())));
-        
-        QDateTime departureDateTime = QDateTime::fromString(booking["departure_time"].toString(), Qt::ISODate);
-        row.append(new QStandardItem(departureDateTime.toString("yyyy-MM-dd hh:mm")));
+        row.append(new QStandardItem(QString::number(booking.id)));
+        row.append(new QStandardItem(booking.flightNumber));
+        row.append(new QStandardItem(QString("%1 (%2)").arg(booking.departureCity, booking.departureCode)));
+        row.append(new QStandardItem(QString("%1 (%2)").arg(booking.arrivalCity, booking.arrivalCode)));
+        row.append(new QStandardItem(booking.departureTime.toString("yyyy-MM-dd hh:mm")));
         
         // Перевод класса места на русский
-        QString seatClass = booking["seat_class"].toString();
+        const QString &seatClass = booking.seatClass;
         QString translatedSeatClass;
         if (seatClass == "Economy") {
             translatedSeatClass = "Эконом";
@@ -205,10 +205,10 @@ void UserProfile::displayUserBookings(const QList<QMap<QString, QVariant>> &book
         }
         
         row.append(new QStandardItem(translatedSeatClass));
-        row.append(new QStandardItem(booking["passenger_name"].toString()));
+        row.append(new QStandardItem(booking.passengerName));
         
         // Перевод статуса на русский
-        QString status = booking["status"].toString();
+        const QString &status = booking.status;
         QString translatedStatus;
         if (status == "Confirmed") {
             translatedStatus = "Подтверждено";
@@ -0,0 +1,138 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QTextStream>
+#include "connectionpool.h"
+#include "datasetgenerator.h"
+#include "loadrollup.h"
+#include "schemamigrator.h"
+
+/**
+ * @brief Генератор синтетического набора данных для нагрузочного тестирования
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return Код завершения приложения
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AirportInspectorDataGen");
+    QCoreApplication::setApplicationVersion("1.0.0");
+
+    DatasetOptions defaults;
+    ConnectionPool::Settings settings;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fills the Airport Inspector database with a reproducible synthetic dataset.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QList<QCommandLineOption> options = {
+        {"seed", "Random seed.", "n", QString::number(defaults.seed)},
+        {"airports", "Number of airports.", "n", QString::number(defaults.airports)},
+        {"airlines", "Number of airlines.", "n", QString::number(defaults.airlines)},
+        {"routes", "Number of directed routes.", "n", QString::number(defaults.routes)},
+        {"days", "Number of days with flights.", "n", QString::number(defaults.days)},
+        {"flights-per-day", "Flights departing per day across the network.", "n", QString::number(defaults.flightsPerDay)},
+        {"users", "Number of users.", "n", QString::number(defaults.users)},
+        {"bookings", "Number of bookings.", "n", QString::number(defaults.bookings)},
+        {"hub-fraction", "Share of airports that are hubs.", "x", QString::number(defaults.hubFraction)},
+        {"zipf", "Zipf exponent of route and user popularity.", "x", QString::number(defaults.zipfExponent)},
+        {"start-date", "First flight day, yyyy-MM-dd (default: today).", "date"},
+        {"jobs", "Parallel loading connections.", "n", QString::number(QThread::idealThreadCount())},
+        {"reset", "Truncate existing data before loading."},
+        {"rebuild-load-rollup", "Recompute the hourly airport loading rollup instead of loading data."},
+        {"check-load-rollup", "Compare the hourly airport loading rollup with the flights instead of loading data."},
+        {"host", "Database host.", "host", settings.hostName},
+        {"port", "Database port.", "port", QString::number(settings.port)},
+        {"database", "Database name.", "name", settings.databaseName},
+        {"user", "Database user.", "user", settings.userName},
+        {"password", "Database password.", "password", settings.password}
+    };
+    parser.addOptions(options);
+    parser.process(app);
+
+    QTextStream err(stderr);
+
+    DatasetOptions dataset;
+    dataset.seed = parser.value("seed").toULongLong();
+    dataset.airports = parser.value("airports").toInt();
+    dataset.airlines = parser.value("airlines").toInt();
+    dataset.routes = parser.value("routes").toInt();
+    dataset.days = parser.value("days").toInt();
+    dataset.flightsPerDay = parser.value("flights-per-day").toInt();
+    dataset.users = parser.value("users").toInt();
+    dataset.bookings = parser.value("bookings").toInt();
+    dataset.hubFraction = parser.value("hub-fraction").toDouble();
+    dataset.zipfExponent = parser.value("zipf").toDouble();
+    dataset.jobs = qMax(1, parser.value("jobs").toInt());
+    dataset.reset = parser.isSet("reset");
+    if (parser.isSet("start-date")) {
+        dataset.startDate = QDate::fromString(parser.value("start-date"), Qt::ISODate);
+        if (!dataset.startDate.isValid()) {
+            err << "Invalid start date: " << parser.value("start-date") << Qt::endl;
+            return 1;
+        }
+    }
+    if (dataset.zipfExponent <= 0.0) {
+        err << "Zipf exponent must be positive" << Qt::endl;
+        return 1;
+    }
+
+    settings.hostName = parser.value("host");
+    settings.port = parser.value("port").toInt();
+    settings.databaseName = parser.value("database");
+    settings.userName = parser.value("user");
+    settings.password = parser.value("password");
+    // Loading threads and the main thread; no Database workers run here
+    settings.reservedConnections = dataset.jobs + 1;
+    settings.maxConnections = settings.reservedConnections;
+    settings.idleTimeoutMs = 0;
+
+    ConnectionPool pool(settings);
+
+    // Bring the schema up to date before loading
+    {
+        ConnectionPool::Lease lease = pool.acquire();
+        if (!lease.isValid()) {
+            err << "Cannot connect to database: " << pool.lastError() << Qt::endl;
+            return 1;
+        }
+        SchemaMigrator migrator(lease.database());
+        if (!migrator.migrate()) {
+            err << "Schema migration failed: " << migrator.lastError() << Qt::endl;
+            return 1;
+        }
+    }
+
+    // Maintain the airport load rollup instead of generating data
+    if (parser.isSet("rebuild-load-rollup") || parser.isSet("check-load-rollup")) {
+        ConnectionPool::Lease lease = pool.acquire();
+        LoadRollup rollup(lease.database());
+        if (parser.isSet("rebuild-load-rollup") && !rollup.rebuild()) {
+            err << "Rollup rebuild failed: " << rollup.lastError() << Qt::endl;
+            return 1;
+        }
+        if (parser.isSet("check-load-rollup")) {
+            LoadRollup::Report report;
+            if (!rollup.check(&report)) {
+                err << "Rollup check failed: " << rollup.lastError() << Qt::endl;
+                return 1;
+            }
+            err << report.rows << " rollup rows, " << report.mismatches << " differing hours" << Qt::endl;
+            for (const QString &sample : std::as_const(report.samples)) {
+                err << "  " << sample << Qt::endl;
+            }
+            return report.isConsistent() ? 0 : 2;
+        }
+        return 0;
+    }
+
+    DatasetGenerator generator(&pool, dataset);
+    if (!generator.generate()) {
+        err << "Dataset generation failed: " << generator.lastError() << Qt::endl;
+        return 1;
+    }
+
+    return 0;
+}